@@ -0,0 +1,345 @@
+//linux_SerialPort.cpp
+//Serial Port classes in a Juce stylee, termios backend for Linux
+//Derived from the Mac version (mac_SerialPort.cpp); see SerialPort.h for details
+//
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#if JUCE_LINUX
+
+using namespace juce;
+
+#define Point DUMMY_Point
+#define Component DUMMY_Component
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <errno.h>
+#undef Point
+#undef Component
+#include "juce_serialport.h"
+
+StringPairArray SerialPort::getSerialPortPaths()
+{
+	// No IOKit registry here: list the tty nodes USB-serial adapters, CDC-ACM boards
+	// (the ESP32) and on-board UARTs show up as
+	StringPairArray SerialPortPaths;
+	const File devFolder("/dev");
+	for (auto pattern : { "ttyUSB*", "ttyACM*", "ttyS*" })
+	{
+		for (const auto& device : devFolder.findChildFiles(File::findFiles, false, pattern))
+			SerialPortPaths.set(device.getFileName(), device.getFullPathName());
+	}
+	return SerialPortPaths;
+}
+bool SerialPort::exists()
+{
+	return (-1!=portDescriptor);
+}
+void SerialPort::close()
+{
+    DebugLog ("SerialPort::close", "closing port:" + portPath);
+
+	if(-1 != portDescriptor)
+	{
+		//wait for garbage to go? nah...
+		//tcdrain(portDescriptor);
+		::close(portDescriptor);
+		portDescriptor = -1;
+	}
+}
+bool SerialPort::open(const String & portPath)
+{
+	this->portPath = portPath;
+    DebugLog ("SerialPort::open", "opening port:" + this->portPath);
+
+    struct termios options;
+	portDescriptor = ::open(portPath.getCharPointer(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (portDescriptor == -1)
+    {
+        DebugLog ("SerialPort::open", "open() failed");
+        return false;
+    }
+    // don't allow multiple opens
+    if (ioctl(portDescriptor, TIOCEXCL) == -1)
+    {
+        DebugLog ("SerialPort::open", "ioctl error, non critical");
+    }
+    // we want blocking io actually
+	if (fcntl(portDescriptor, F_SETFL, 0) == -1)
+    {
+        DebugLog ("SerialPort::open", "fcntl error");
+		close();
+        return false;
+    }
+	// Get the current options
+    if (tcgetattr(portDescriptor, &options) == -1)
+    {
+        DebugLog ("SerialPort::open", "can't get port settings to set timeouts");
+		close();
+        return false;
+    }
+	//non canocal, 0.5 second timeout, read returns as soon as any data is recieved
+	cfmakeraw(&options);
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 5;
+	if (tcsetattr(portDescriptor, TCSANOW, &options) == -1)
+    {
+        DebugLog ("SerialPort::open", "can't set port settings (timeouts)");
+		close();
+        return false;
+    }
+	return true;
+}
+void SerialPort::cancel ()
+{
+}
+
+// termios on Linux only takes the Bxxx constants, not plain integers
+static speed_t toSpeed(int bps)
+{
+	switch (bps)
+	{
+	case 1200: return B1200;
+	case 2400: return B2400;
+	case 4800: return B4800;
+	case 9600: return B9600;
+	case 19200: return B19200;
+	case 38400: return B38400;
+	case 57600: return B57600;
+	case 115200: return B115200;
+	case 230400: return B230400;
+	case 460800: return B460800;
+	case 921600: return B921600;
+	default: return B0;
+	}
+}
+static int fromSpeed(speed_t speed)
+{
+	for (int bps : { 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 })
+		if (toSpeed(bps) == speed)
+			return bps;
+	return 0;
+}
+
+bool SerialPort::setConfig(const SerialPortConfig & config)
+{
+	if(-1==portDescriptor)return false;
+	struct termios options;
+	memset(&options, 0, sizeof(struct termios));
+	//non canocal, 0.5 second timeout, read returns as soon as any data is recieved
+	cfmakeraw(&options);
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 5;
+	options.c_cflag |= CREAD; //enable reciever (daft)
+	options.c_cflag |= CLOCAL;//don't monitor modem control lines
+	//baud and bits
+	const speed_t speed = toSpeed(static_cast<int>(config.bps));
+	if (speed == B0)
+	{
+		DebugLog("SerialPort::setConfig", "baud rate not supported on Linux: " + String(config.bps));
+		return false;
+	}
+	cfsetispeed(&options, speed);
+	cfsetospeed(&options, speed);
+	switch(config.databits)
+	{
+		case 5: options.c_cflag |= CS5; break;
+		case 6: options.c_cflag |= CS6; break;
+		case 7: options.c_cflag |= CS7; break;
+		case 8: options.c_cflag |= CS8; break;
+	}
+	//parity
+	switch(config.parity)
+	{
+	case SerialPortConfig::SERIALPORT_PARITY_ODD:
+		options.c_cflag |= PARENB;
+		options.c_cflag |= PARODD;
+		break;
+	case SerialPortConfig::SERIALPORT_PARITY_EVEN:
+		options.c_cflag |= PARENB;
+		break;
+	case SerialPortConfig::SERIALPORT_PARITY_MARK:
+	case SerialPortConfig::SERIALPORT_PARITY_SPACE:
+		DebugLog("SerialPort::setConfig", "SERIALPORT_PARITY_MARK and SERIALPORT_PARITY_SPACE not supported on Linux");
+		return false;//not supported
+		break;
+	case SerialPortConfig::SERIALPORT_PARITY_NONE:
+	default:
+		break;
+	}
+	//stopbits
+	if (config.stopbits==SerialPortConfig::STOPBITS_1ANDHALF)
+	{
+		DebugLog ("SerialPort::setConfig", "STOPBITS_1ANDHALF not supported on Linux");
+		return false;//not supported
+	}
+	if(config.stopbits==SerialPortConfig::STOPBITS_2)
+		options.c_cflag |= CSTOPB;
+	//flow control
+	switch(config.flowcontrol)
+	{
+	case SerialPortConfig::FLOWCONTROL_XONXOFF:
+		options.c_iflag |= IXON;
+		options.c_iflag |= IXOFF;
+		break;
+	case SerialPortConfig::FLOWCONTROL_HARDWARE:
+		options.c_cflag |= CRTSCTS;
+		break;
+	case SerialPortConfig::FLOWCONTROL_NONE:
+	default:
+		break;
+	}
+	if (tcsetattr(portDescriptor, TCSANOW, &options) == -1)
+    {
+        DebugLog("SerialPort::setConfig", "can't set port settings");
+        return false;
+    }
+
+	return true;
+}
+bool SerialPort::getConfig(SerialPortConfig & config)
+{
+	struct termios options;
+	if(-1==portDescriptor)return false;
+	if (tcgetattr(portDescriptor, &options) == -1)
+    {
+        DebugLog("SerialPort::getConfig", "cannot get port settings");
+        return false;
+    }
+	config.bps = fromSpeed(cfgetospeed(&options));
+	switch(options.c_cflag & CSIZE)
+	{
+	case CS5: config.databits=5; break;
+	case CS6: config.databits=6; break;
+	case CS7: config.databits=7; break;
+	case CS8: config.databits=8; break;
+	}
+	config.parity = SerialPortConfig::SERIALPORT_PARITY_NONE;
+	if(options.c_cflag & PARENB)
+	{ 
+		if(options.c_cflag & PARODD)config.parity = SerialPortConfig::SERIALPORT_PARITY_ODD;
+		else config.parity = SerialPortConfig::SERIALPORT_PARITY_EVEN;
+	}
+	//stopbits
+	config.stopbits = SerialPortConfig::STOPBITS_1;
+	if(options.c_cflag & CSTOPB)config.stopbits = SerialPortConfig::STOPBITS_2;
+	//flow control
+	config.flowcontrol=SerialPortConfig::FLOWCONTROL_NONE;
+	if((options.c_iflag & IXON) || (options.c_iflag & IXOFF))
+		config.flowcontrol=SerialPortConfig::FLOWCONTROL_XONXOFF;
+	else if(options.c_cflag & CRTSCTS)
+		config.flowcontrol=SerialPortConfig::FLOWCONTROL_HARDWARE;
+	
+	return true;
+}
+/////////////////////////////////
+// SerialPortInputStream
+/////////////////////////////////
+void SerialPortInputStream::cancel ()
+{
+}
+
+void SerialPortInputStream::run()
+{
+    //port->DebugLog ("SerialPortInputStream::run", "starting thread");
+
+    while (port != nullptr && port->portDescriptor != -1 && ! threadShouldExit ())
+    {
+        unsigned char c;
+        //this call will block until we read 1 byte, or ::read() returns an error, caught below
+        const auto bytesread = ::read (port->portDescriptor, &c, 1);
+        if (bytesread == 1)
+        {
+            const ScopedLock l (bufferCriticalSection);
+
+            buffer.ensureSize (bufferedbytes + 1);
+            buffer[bufferedbytes] = c;
+            ++bufferedbytes;
+
+            if (notify == NOTIFY_ALWAYS || (notify == NOTIFY_ON_CHAR && c == notifyChar))
+                sendChangeMessage();
+        }
+        else if (bytesread == -1 && errno != EAGAIN)
+        {
+            port->DebugLog ("SerialPortInputStream::run", "::read() returned " + String(bytesread) + ", errno: " + String (errno));
+            port->close ();
+            break;
+        }
+    }
+
+    //port->DebugLog ("SerialPortInputStream::run", "stopping thread");
+}
+
+int SerialPortInputStream::read(void *destBuffer, int maxBytesToRead)
+{
+    if (port != nullptr && port->portDescriptor != -1)
+    {
+        const ScopedLock l (bufferCriticalSection);
+
+        if (maxBytesToRead > bufferedbytes)
+            maxBytesToRead = bufferedbytes;
+
+        memcpy (destBuffer, buffer.getData(), maxBytesToRead);
+        buffer.removeSection (0,maxBytesToRead);
+        bufferedbytes -= maxBytesToRead;
+
+        return maxBytesToRead;
+    }
+    else
+        return -1;
+}
+/////////////////////////////////
+// SerialPortOutputStream
+/////////////////////////////////
+void SerialPortOutputStream::cancel ()
+{
+}
+
+void SerialPortOutputStream::run()
+{
+    //port->DebugLog ("SerialPortOutputStream::run", "starting thread");
+
+    unsigned char tempbuffer[writeBufferSize];
+    while(port && (port->portDescriptor!=-1) && !threadShouldExit())
+    {
+		// todo - there are two reads of 'bufferedbytes' which are outside of a mutex, should it be atomic at the minimum
+        if (! bufferedbytes)
+            triggerWrite.wait(100);
+        if (bufferedbytes)
+        {
+            bufferCriticalSection.enter();
+            int bytestowrite = bufferedbytes > writeBufferSize ? writeBufferSize : bufferedbytes;
+            memcpy (tempbuffer, buffer.getData(), bytestowrite);
+            bufferCriticalSection.exit();
+            const auto byteswritten = ::write(port->portDescriptor, tempbuffer, bytestowrite);
+            if (byteswritten>0)
+            {
+                const ScopedLock l(bufferCriticalSection);
+                buffer.removeSection(0, byteswritten);
+                bufferedbytes-=byteswritten;
+            }
+            else
+            {
+                port->DebugLog ("SerialPortOutputStream::run", "::write() couldn't write anything, errno: " + String (errno));
+                port->close ();
+                break;
+            }
+        }
+    }
+    //port->DebugLog ("SerialPortOutputStream::run", "stopping thread");
+}
+
+bool SerialPortOutputStream::write(const void *dataToWrite, size_t howManyBytes)
+{
+	bufferCriticalSection.enter();
+    buffer.append(dataToWrite, howManyBytes);
+	bufferedbytes+=howManyBytes;
+	bufferCriticalSection.exit();
+	triggerWrite.signal();
+	return true;
+}
+
+#endif // JUCE_LINUX
@@ -0,0 +1,138 @@
+#include "BlockProfiler.h"
+
+void BlockProfiler::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    recording = false;
+    written.store(0, std::memory_order_release);
+}
+
+const char* BlockProfiler::getStageName(int stage) noexcept
+{
+    switch (stage)
+    {
+        case parameters:   return "parameters";
+        case triggerCount: return "trigger count";
+        case math:         return "math";
+        case analyser:     return "analyser";
+        case capture:      return "capture";
+        case mask:         return "mask test";
+        case generator:    return "generator";
+        default:           return "";
+    }
+}
+
+void BlockProfiler::beginBlock(int numSamples) noexcept
+{
+    recording = isEnabled();
+    if (!recording)
+        return;
+
+    current.stageTicks.fill(0);
+    current.totalTicks = 0;
+    current.numSamples = (juce::uint32)juce::jmax(0, numSamples);
+}
+
+void BlockProfiler::addStageTime(Stage stage, juce::int64 ticks) noexcept
+{
+    if (recording)
+        current.stageTicks[(size_t)stage] += (juce::uint32)juce::jlimit((juce::int64)0, (juce::int64)0xffffffff, ticks);
+}
+
+void BlockProfiler::endBlock(juce::int64 totalTicks) noexcept
+{
+    if (!recording)
+        return;
+
+    current.totalTicks = (juce::uint32)juce::jlimit((juce::int64)0, (juce::int64)0xffffffff, totalTicks);
+
+    const auto index = written.load(std::memory_order_relaxed);
+    ring[index % historySize] = current;
+    written.store(index + 1, std::memory_order_release);
+    recording = false;
+}
+
+BlockProfiler::Summary BlockProfiler::getSummary() const
+{
+    Summary summary;
+
+    // Copy the newest records, then drop any the audio thread may have overwritten
+    // while we were reading (the slot it writes next is never taken)
+    const auto end = written.load(std::memory_order_acquire);
+    const auto available = (int)juce::jmin(end, (juce::uint32)historySize - 1);
+
+    std::vector<Record> records((size_t)available);
+    for (int i = 0; i < available; ++i)
+        records[(size_t)i] = ring[(end - (juce::uint32)available + (juce::uint32)i) % historySize];
+
+    const auto overwritten = (int)juce::jmin((juce::uint32)available, written.load(std::memory_order_acquire) - end);
+    records.erase(records.begin(), records.begin() + overwritten);
+
+    summary.numBlocks = (int)records.size();
+    if (records.empty())
+        return summary;
+
+    double deadlineSum = 0.0;
+    for (const auto& r : records)
+    {
+        const double deadline = r.numSamples * 1.0e6 / sampleRate;
+        deadlineSum += deadline;
+        if (r.totalTicks * ticksToMicroseconds > deadline)
+            ++summary.overruns;
+    }
+
+    const double meanDeadline = deadlineSum / records.size();
+    summary.deadlineUs = (float)meanDeadline;
+
+    std::vector<float> values(records.size());
+
+    auto summarise = [&](const char* name, auto&& ticksOf)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            values[i] = (float)(ticksOf(records[i]) * ticksToMicroseconds);
+            sum += values[i];
+        }
+
+        std::sort(values.begin(), values.end());
+        auto percentile = [&](float p) { return values[(size_t)juce::jmin((int)values.size() - 1, (int)(p * values.size()))]; };
+
+        StageTiming timing;
+        timing.name = name;
+        timing.p50Us = percentile(0.50f);
+        timing.p99Us = percentile(0.99f);
+        timing.maxUs = values.back();
+        timing.deadlineFraction = meanDeadline > 0.0 ? (float)(sum / records.size() / meanDeadline) : 0.0f;
+        return timing;
+    };
+
+    for (int s = 0; s < numStages; ++s)
+        summary.stages[(size_t)s] = summarise(getStageName(s), [s](const Record& r) { return r.stageTicks[(size_t)s]; });
+
+    summary.total = summarise("total", [](const Record& r) { return r.totalTicks; });
+    return summary;
+}
+
+juce::String BlockProfiler::createReport() const
+{
+    const auto summary = getSummary();
+
+    juce::String report;
+    report << "processBlock profile: " << summary.numBlocks << " blocks, deadline "
+           << juce::String(summary.deadlineUs, 1) << " us, " << summary.overruns << " overruns\n";
+
+    auto line = [&](const StageTiming& t)
+    {
+        report << juce::String(t.name).paddedRight(' ', 14)
+               << "p50 " << juce::String(t.p50Us, 2) << "  p99 " << juce::String(t.p99Us, 2)
+               << "  max " << juce::String(t.maxUs, 2) << " us  "
+               << juce::String(t.deadlineFraction * 100.0f, 2) << " % of deadline\n";
+    };
+
+    for (const auto& stage : summary.stages)
+        line(stage);
+
+    line(summary.total);
+    return report;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PerformanceCounters.h"
+
+// Opt-in per-stage timing of processBlock. The audio thread writes one fixed-size record
+// per block into a ring (no allocation, no locks); the message thread copies the ring
+// and computes percentiles. While disabled the scoped stages do not even read the clock.
+class BlockProfiler
+{
+public:
+    enum Stage
+    {
+        parameters,     // params.update(): raw parameter reads and snapshot publishing
+        triggerCount,   // edge counting for the rate counters
+        math,           // math channel programs
+        analyser,       // FFT FIFO push
+        capture,        // history buffer, segmented capture, recorder FIFO, equivalent time
+        mask,           // mask test of every triggered acquisition
+        generator,      // calibration generator / output clear
+        numStages
+    };
+
+    static constexpr int historySize = 1024;  // blocks
+
+    struct Summary
+    {
+        std::array<StageTiming, numStages> stages;
+        StageTiming total;
+        float deadlineUs = 0.0f;
+        int numBlocks = 0;
+        int overruns = 0;   // blocks that took longer than their deadline
+    };
+
+    BlockProfiler() = default;
+
+    void prepare(double sampleRate);
+
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Audio thread
+    void beginBlock(int numSamples) noexcept;
+    void addStageTime(Stage stage, juce::int64 ticks) noexcept;
+    void endBlock(juce::int64 totalTicks) noexcept;
+
+    // Message thread
+    Summary getSummary() const;
+    juce::String createReport() const;
+
+    static const char* getStageName(int stage) noexcept;
+
+private:
+    struct Record
+    {
+        std::array<juce::uint32, numStages> stageTicks;
+        juce::uint32 totalTicks;
+        juce::uint32 numSamples;
+    };
+
+    std::atomic<bool> enabled{ false };
+    double sampleRate = 48000.0;
+    double ticksToMicroseconds = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+    // Written by the audio thread only
+    std::array<Record, historySize> ring{};
+    Record current{};
+    bool recording = false;
+    std::atomic<juce::uint32> written{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BlockProfiler)
+};
+
+// Times the enclosing scope as one stage of the current block
+struct ScopedStage
+{
+    ScopedStage(BlockProfiler& p, BlockProfiler::Stage s) noexcept
+        : profiler(p), stage(s), start(p.isEnabled() ? juce::Time::getHighResolutionTicks() : 0) {}
+
+    ~ScopedStage()
+    {
+        if (start != 0)
+            profiler.addStageTime(stage, juce::Time::getHighResolutionTicks() - start);
+    }
+
+    BlockProfiler& profiler;
+    const BlockProfiler::Stage stage;
+    const juce::int64 start;
+};
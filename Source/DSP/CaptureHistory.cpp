@@ -0,0 +1,66 @@
+#include "CaptureHistory.h"
+
+namespace
+{
+    // Largest range requested from the history at once
+    constexpr int scanChunk = 1 << 18;
+
+    // Calls visit(data, size) for every run of [start, start + numSamples), chunk by chunk.
+    // Stops early when visit returns false. Returns false if part of the range is not held,
+    // or was overwritten while it was visited.
+    template <typename Visitor>
+    bool forEachSpan(const CaptureHistory& history, int channel, juce::int64 start, juce::int64 numSamples, Visitor&& visit) noexcept
+    {
+        const CaptureHistory::ScopedRead read(history);
+        HistorySpans spans;
+
+        for (juce::int64 offset = 0; offset < numSamples; offset += scanChunk)
+        {
+            const int n = static_cast<int>(juce::jmin<juce::int64>(scanChunk, numSamples - offset));
+            if (!history.getSpans(channel, start + offset, n, spans))
+                return false;
+
+            for (int p = 0; p < spans.count; ++p)
+                if (!visit(spans.parts[(size_t)p].data, spans.parts[(size_t)p].size))
+                    return history.isStillValid(spans);
+
+            if (!history.isStillValid(spans))
+                return false;
+        }
+
+        return true;
+    }
+}
+
+bool HistoryScan::copy(const CaptureHistory& history, int channel, juce::int64 start, int numSamples, float* dest) noexcept
+{
+    const CaptureHistory::ScopedRead read(history);
+    HistorySpans spans;
+    if (!history.getSpans(channel, start, numSamples, spans))
+        return false;
+
+    for (int p = 0; p < spans.count; ++p)
+    {
+        const auto& span = spans.parts[(size_t)p];
+        juce::FloatVectorOperations::copy(dest, span.data, span.size);
+        dest += span.size;
+    }
+
+    return history.isStillValid(spans);
+}
+
+juce::Range<float> HistoryScan::findMinAndMax(const CaptureHistory& history, int channel, juce::int64 start, juce::int64 numSamples) noexcept
+{
+    juce::Range<float> range;
+    bool first = true;
+
+    const bool held = forEachSpan(history, channel, start, numSamples, [&](const float* data, int size)
+    {
+        const auto spanRange = juce::FloatVectorOperations::findMinAndMax(data, size);
+        range = first ? spanRange : range.getUnionWith(spanRange);
+        first = false;
+        return true;
+    });
+
+    return held ? range : juce::Range<float>();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// A contiguous run of one channel of a capture history, read in place
+struct HistorySpan
+{
+    const float* data = nullptr;
+    int size = 0;
+};
+
+// The runs covering one requested range, in order. A ring contributes at most two; a
+// deep history whose newest part is served from the RAM tail at most four.
+struct HistorySpans
+{
+    static constexpr int maxParts = 4;
+
+    std::array<HistorySpan, maxParts> parts;
+    int count = 0;
+
+    // Absolute index of the first sample, and of the first one read from storage that is
+    // overwritten in place (the RAM ring); isStillValid checks them once the spans were read
+    juce::int64 start = 0;
+    juce::int64 ringStart = std::numeric_limits<juce::int64>::max();
+
+    void add(const float* data, int size) noexcept
+    {
+        if (size > 0 && count < maxParts)
+            parts[(size_t)count++] = { data, size };
+    }
+};
+
+// Read access to captured samples by absolute sample index (counted since prepare), shared
+// by the RAM history ring and the memory-mapped deep history. Samples are never copied
+// to be read: scans walk the spans, so the same code works over seconds in RAM or hours
+// in the page cache.
+class CaptureHistory
+{
+public:
+    virtual ~CaptureHistory() = default;
+
+    virtual int getNumChannels() const noexcept = 0;
+
+    // [getOldestSample(), getTotalSamplesWritten()) is the range currently held
+    virtual juce::int64 getTotalSamplesWritten() const noexcept = 0;
+    virtual juce::int64 getOldestSample() const noexcept = 0;
+
+    // Fills spans with the runs covering [start, start + numSamples) of channel.
+    // Returns false (and no spans) if any of the range is not held.
+    //
+    // The spans point into live storage: the audio thread keeps overwriting the oldest part
+    // of the RAM ring while they are read. Off the audio thread, hold a ScopedRead for as
+    // long as the spans are used, and call isStillValid after reading them; if it returns
+    // false, what was read may be torn or newer audio and must be discarded.
+    virtual bool getSpans(int channel, juce::int64 start, int numSamples, HistorySpans& spans) const noexcept = 0;
+
+    // True if nothing the spans cover has been overwritten since getSpans filled them
+    virtual bool isStillValid(const HistorySpans& spans) const noexcept = 0;
+
+    // Oldest sample no write in progress can be overwriting: spans from at or above it are
+    // likely to pass isStillValid
+    virtual juce::int64 getOldestIntactSample() const noexcept { return getOldestSample(); }
+
+    // A history that can be remapped while it is read (the deep history) retires its old
+    // storage only once every reader has left; beginRead returns the token for endRead.
+    // This only keeps the storage mapped: it does not stop the ring being overwritten.
+    virtual int beginRead() const noexcept { return 0; }
+    virtual void endRead(int /*token*/) const noexcept {}
+
+    struct ScopedRead
+    {
+        explicit ScopedRead(const CaptureHistory& h) noexcept : history(h), token(h.beginRead()) {}
+        ~ScopedRead() { history.endRead(token); }
+
+        const CaptureHistory& history;
+        const int token;
+    };
+};
+
+// Scans over a CaptureHistory, in chunks so that ranges of hours need no scratch memory
+namespace HistoryScan
+{
+    // Copies the range into dest; false if it is not held, or was overwritten while copied
+    bool copy(const CaptureHistory& history, int channel, juce::int64 start, int numSamples, float* dest) noexcept;
+
+    // Empty if the range is not held, or was overwritten while scanned
+    juce::Range<float> findMinAndMax(const CaptureHistory& history, int channel, juce::int64 start, juce::int64 numSamples) noexcept;
+}
@@ -0,0 +1,331 @@
+#include "CaptureRecorder.h"
+
+CaptureRecorder::CaptureRecorder() : juce::Thread("Capture-Recorder")
+{
+}
+
+CaptureRecorder::~CaptureRecorder()
+{
+    stop();
+}
+
+void CaptureRecorder::prepare(double newSampleRate, int newNumChannels)
+{
+    newNumChannels = juce::jlimit(1, maxChannels, newNumChannels);
+
+    // Hosts prepare again on buffer size changes, device restarts and bounces: a recording
+    // carries on through them if its files can, and otherwise ends with an error to show
+    if (isRecording())
+    {
+        if (newSampleRate == sampleRate && newNumChannels == numChannels)
+            return;
+
+        stop();
+        fail("audio device restarted at " + juce::String(newSampleRate, 0) + " Hz, "
+             + juce::String(newNumChannels) + " channels");
+    }
+
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    // A whole number of write chunks, about fifoSeconds deep
+    const int fifoSize = (static_cast<int>(sampleRate * fifoSeconds) / chunkFrames + 1) * chunkFrames;
+    fifo.setTotalSize(fifoSize);
+    fifoBuffer.setSize(numChannels, fifoSize, false, true, false);
+    chunk.setSize(numChannels, chunkFrames, false, true, false);
+    interleaved.assign((size_t)chunkFrames * (size_t)numChannels, 0.0f);
+}
+
+bool CaptureRecorder::start(const juce::File& targetFolder, Format newFormat, double rotationSeconds)
+{
+    stop();
+
+    if (!targetFolder.createDirectory())
+    {
+        fail("cannot create " + targetFolder.getFullPathName());
+        return false;
+    }
+
+    folder = targetFolder;
+    format = newFormat;
+    baseName = "Auralyzer-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S");
+    rotationSamples = juce::jmax<juce::int64>(chunkFrames, static_cast<juce::int64>(rotationSeconds * sampleRate));
+    samplesInFile = 0;
+    fileIndex = 0;
+
+    samplesWritten = 0;
+    droppedSamples = 0;
+    overruns = 0;
+    filesWritten = 0;
+
+    {
+        const juce::ScopedLock lock(statusLock);
+        error.clear();
+    }
+
+    if (!openNextFile())
+        return false;
+
+    fifo.reset();
+    lastFlushMs = juce::Time::getMillisecondCounter();
+    recording = true;
+    startThread(juce::Thread::Priority::normal);
+    return true;
+}
+
+void CaptureRecorder::stop()
+{
+    // The writer drains what is left in the FIFO before it closes the file
+    recording = false;
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+    closeFile();
+}
+
+CaptureRecorder::Status CaptureRecorder::getStatus() const
+{
+    Status status;
+    status.recording = recording.load();
+    status.samplesWritten = samplesWritten.load();
+    status.droppedSamples = droppedSamples.load();
+    status.overruns = overruns.load();
+    status.filesWritten = filesWritten.load();
+
+    const juce::ScopedLock lock(statusLock);
+    status.currentFile = currentFile;
+    status.error = error;
+    return status;
+}
+
+juce::String CaptureRecorder::getName(Format format)
+{
+    switch (format)
+    {
+        case Format::wav:  return "WAV (32-bit float)";
+        case Format::flac: return "FLAC (24-bit)";
+        case Format::raw:  return "Raw float32";
+        default:           return {};
+    }
+}
+
+juce::File CaptureRecorder::getDefaultFolder()
+{
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+        .getChildFile("Auralyzer")
+        .getChildFile("Recordings");
+}
+
+void CaptureRecorder::push(const juce::AudioBuffer<float>& block, int channelsToRecord) noexcept
+{
+    if (!recording.load(std::memory_order_acquire))
+        return;
+
+    const int numSamples = block.getNumSamples();
+    if (numSamples <= 0)
+        return;
+
+    // A block that does not fit is dropped whole rather than split, so the file only
+    // ever has gaps at block boundaries, and every gap is counted
+    if (fifo.getFreeSpace() < numSamples)
+    {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        droppedSamples.fetch_add((juce::uint64)numSamples, std::memory_order_relaxed);
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    const int available = juce::jmin(channelsToRecord, block.getNumChannels());
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        if (c < available)
+        {
+            const float* source = block.getReadPointer(c);
+            juce::FloatVectorOperations::copy(fifoBuffer.getWritePointer(c, start1), source, size1);
+            if (size2 > 0)
+                juce::FloatVectorOperations::copy(fifoBuffer.getWritePointer(c, start2), source + size1, size2);
+        }
+        else
+        {
+            fifoBuffer.clear(c, start1, size1);
+            if (size2 > 0)
+                fifoBuffer.clear(c, start2, size2);
+        }
+    }
+
+    fifo.finishedWrite(size1 + size2);
+}
+
+void CaptureRecorder::run()
+{
+    juce::uint32 lastWriteMs = juce::Time::getMillisecondCounter();
+
+    while (!threadShouldExit())
+    {
+        // Full chunks as soon as they are ready; a partial one once it has waited long enough
+        const int ready = fifo.getNumReady();
+        const bool due = juce::Time::getMillisecondCounter() - lastWriteMs >= (juce::uint32)maxLatencyMs;
+
+        if (ready >= chunkFrames || (ready > 0 && due))
+        {
+            if (!writeChunk(juce::jmin(ready, chunkFrames)))
+                break;
+
+            lastWriteMs = juce::Time::getMillisecondCounter();
+            continue;
+        }
+
+        wait(20);
+    }
+
+    while (fifo.getNumReady() > 0 && writeChunk(juce::jmin(fifo.getNumReady(), chunkFrames)))
+    {
+    }
+
+    flush();
+}
+
+bool CaptureRecorder::writeChunk(int numFrames)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(numFrames, start1, size1, start2, size2);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        chunk.copyFrom(c, 0, fifoBuffer, c, start1, size1);
+        if (size2 > 0)
+            chunk.copyFrom(c, size1, fifoBuffer, c, start2, size2);
+    }
+
+    fifo.finishedRead(size1 + size2);
+
+    const int frames = size1 + size2;
+    int offset = 0;
+
+    // Split at the rotation boundary so every file holds exactly one rotation period
+    while (offset < frames)
+    {
+        if (samplesInFile >= rotationSamples && !openNextFile())
+            return false;
+
+        const int n = static_cast<int>(juce::jmin<juce::int64>(frames - offset, rotationSamples - samplesInFile));
+        bool written = false;
+
+        if (format == Format::raw)
+        {
+            for (int c = 0; c < numChannels; ++c)
+            {
+                const float* source = chunk.getReadPointer(c, offset);
+                for (int i = 0; i < n; ++i)
+                    interleaved[(size_t)(i * numChannels + c)] = source[i];
+            }
+
+            written = rawStream != nullptr && rawStream->write(interleaved.data(), sizeof(float) * (size_t)n * (size_t)numChannels);
+        }
+        else
+        {
+            const float* channels[maxChannels];
+            for (int c = 0; c < numChannels; ++c)
+                channels[c] = chunk.getReadPointer(c, offset);
+
+            written = writer != nullptr && writer->writeFromFloatArrays(channels, numChannels, n);
+        }
+
+        if (!written)
+        {
+            fail("write failed, disk full?");
+            return false;
+        }
+
+        samplesInFile += n;
+        samplesWritten.fetch_add((juce::uint64)n, std::memory_order_relaxed);
+        offset += n;
+    }
+
+    if (juce::Time::getMillisecondCounter() - lastFlushMs >= (juce::uint32)maxLatencyMs)
+        flush();
+
+    return true;
+}
+
+bool CaptureRecorder::openNextFile()
+{
+    closeFile();
+
+    const juce::String extension = format == Format::wav ? ".wav" : format == Format::flac ? ".flac" : ".f32";
+    juce::String name = baseName + "-" + juce::String(fileIndex++).paddedLeft('0', 3);
+
+    // Raw files carry their layout in the name, since they have no header
+    if (format == Format::raw)
+        name += "-" + juce::String(juce::roundToInt(sampleRate)) + "Hz-" + juce::String(numChannels) + "ch";
+
+    const auto file = folder.getChildFile(name + extension);
+    const size_t bufferBytes = sizeof(float) * (size_t)chunkFrames * (size_t)numChannels;
+    auto stream = file.createOutputStream(bufferBytes);
+
+    if (stream == nullptr || stream->failedToOpen())
+    {
+        fail("cannot open " + file.getFullPathName());
+        return false;
+    }
+
+    if (format == Format::raw)
+    {
+        rawStream = std::move(stream);
+    }
+    else
+    {
+        std::unique_ptr<juce::AudioFormat> audioFormat;
+        if (format == Format::wav)
+            audioFormat = std::make_unique<juce::WavAudioFormat>();
+        else
+            audioFormat = std::make_unique<juce::FlacAudioFormat>();
+
+        const int bitsPerSample = format == Format::wav ? 32 : 24;
+        writer.reset(audioFormat->createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels, bitsPerSample, {}, 0));
+
+        if (writer == nullptr)
+        {
+            fail(audioFormat->getFormatName() + " cannot record " + juce::String(numChannels) + " channels at "
+                 + juce::String(juce::roundToInt(sampleRate)) + " Hz");
+            return false;
+        }
+
+        stream.release(); // now owned by the writer
+    }
+
+    samplesInFile = 0;
+    filesWritten.fetch_add(1, std::memory_order_relaxed);
+
+    const juce::ScopedLock lock(statusLock);
+    currentFile = file;
+    return true;
+}
+
+void CaptureRecorder::closeFile()
+{
+    writer.reset();     // finalises the header
+    rawStream.reset();
+}
+
+void CaptureRecorder::flush()
+{
+    // For WAV this rewrites the header, so a crash loses at most the latency window
+    if (writer != nullptr)
+        writer->flush();
+    if (rawStream != nullptr)
+        rawStream->flush();
+
+    lastFlushMs = juce::Time::getMillisecondCounter();
+}
+
+void CaptureRecorder::fail(const juce::String& message)
+{
+    recording = false;
+
+    const juce::ScopedLock lock(statusLock);
+    error = message;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Long-duration recording of the captured inputs to disk. The audio thread copies each
+// block into a lock-free FIFO (two seconds deep) and never waits or allocates: when the
+// writer falls behind, the whole block is dropped and counted as an overrun. A writer
+// thread drains the FIFO in large chunks and writes WAV (32-bit float), FLAC (24-bit) or
+// raw interleaved float32, starting a new file every rotation period so an overnight
+// capture is a series of manageable files. Captured audio reaches the file (and a WAV
+// header that covers it) within maxLatencyMs.
+class CaptureRecorder : public juce::Thread
+{
+public:
+    enum class Format { wav, flac, raw };
+
+    struct Status
+    {
+        bool recording = false;
+        juce::uint64 samplesWritten = 0;    // per channel, over all files of the recording
+        juce::uint64 droppedSamples = 0;    // per channel, lost to overruns
+        int overruns = 0;                   // blocks dropped because the FIFO was full
+        int filesWritten = 0;
+        juce::File currentFile;
+        juce::String error;
+    };
+
+    static constexpr int chunkFrames = 16384;       // frames per write: 64 kB per channel
+    static constexpr double fifoSeconds = 2.0;
+    static constexpr int maxLatencyMs = 250;
+    static constexpr double defaultRotationSeconds = 3600.0;
+    static constexpr int maxChannels = 32;
+
+    CaptureRecorder();
+    ~CaptureRecorder() override;
+
+    // Sizes the FIFO. A recording in progress continues if the rate and channel count are
+    // unchanged; otherwise it stops, with the reason in Status::error.
+    void prepare(double sampleRate, int numChannels);
+
+    // Message thread. Files are named after the start time and numbered per rotation.
+    bool start(const juce::File& folder, Format format, double rotationSeconds = defaultRotationSeconds);
+    void stop();
+    bool isRecording() const noexcept { return recording.load(); }
+    Status getStatus() const;
+
+    static juce::String getName(Format format);
+    static juce::File getDefaultFolder();
+
+    // Audio thread: records the first numChannels of block (fewer are padded with silence)
+    void push(const juce::AudioBuffer<float>& block, int numChannels) noexcept;
+
+private:
+    void run() override;
+
+    // Writer thread
+    bool writeChunk(int numFrames);
+    bool openNextFile();
+    void closeFile();
+    void flush();
+    void fail(const juce::String& message);
+
+    double sampleRate = 48000.0;
+    int numChannels = 1;
+
+    juce::AbstractFifo fifo{ 1 };
+    juce::AudioBuffer<float> fifoBuffer;
+    std::atomic<bool> recording{ false };
+
+    std::atomic<juce::uint64> samplesWritten{ 0 };
+    std::atomic<juce::uint64> droppedSamples{ 0 };
+    std::atomic<int> overruns{ 0 };
+    std::atomic<int> filesWritten{ 0 };
+
+    // Writer thread state, set up by start() before the thread runs
+    juce::File folder;
+    Format format = Format::wav;
+    juce::String baseName;
+    juce::int64 rotationSamples = 0;
+    juce::int64 samplesInFile = 0;
+    int fileIndex = 0;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    std::unique_ptr<juce::FileOutputStream> rawStream;
+    juce::AudioBuffer<float> chunk;
+    std::vector<float> interleaved;
+    juce::uint32 lastFlushMs = 0;
+
+    mutable juce::CriticalSection statusLock;
+    juce::File currentFile;
+    juce::String error;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CaptureRecorder)
+};
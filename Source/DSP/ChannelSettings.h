@@ -0,0 +1,17 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Display settings of one captured channel, shared by the time and frequency views. Written
+// from the message thread (channel menu, state restore) and read by either view. The
+// capture holds the inputs first and the math channels after them.
+struct ChannelSettings
+{
+    static constexpr int maxInputChannels = 8;
+    static constexpr int maxMathChannels = 2;
+    static constexpr int maxCaptureChannels = maxInputChannels + maxMathChannels;
+
+    std::atomic<bool> visible{ true };
+    std::atomic<float> scale{ 1.0f };     // multiplier on the common vertical scale
+    std::atomic<float> offset{ 0.0f };    // divisions, on top of the common vertical position
+};
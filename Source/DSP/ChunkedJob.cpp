@@ -0,0 +1,98 @@
+#include "ChunkedJob.h"
+
+class ChunkedJob::Worker : public juce::Thread
+{
+public:
+    Worker(ChunkedJob& ownerToUse, const juce::String& threadName)
+        : juce::Thread(threadName), owner(ownerToUse)
+    {
+    }
+
+    void run() override
+    {
+        const auto process = owner.makeWorker();
+
+        for (int chunk = owner.nextChunk++; chunk < owner.numChunks && !threadShouldExit(); chunk = owner.nextChunk++)
+        {
+            process(chunk);
+            ++owner.chunksDone;
+        }
+
+        owner.workerFinished();
+    }
+
+private:
+    ChunkedJob& owner;
+};
+
+ChunkedJob::ChunkedJob(const juce::String& threadName)
+    : name(threadName)
+{
+}
+
+ChunkedJob::~ChunkedJob()
+{
+    cancel();
+}
+
+void ChunkedJob::start(int newNumChunks, std::function<ChunkFunction()> newMakeWorker,
+                       std::function<void()> newOnComplete, std::function<void()> newOnFinished)
+{
+    cancel();
+
+    numChunks = juce::jmax(0, newNumChunks);
+    makeWorker = std::move(newMakeWorker);
+    onComplete = std::move(newOnComplete);
+    onFinished = std::move(newOnFinished);
+    nextChunk = 0;
+    chunksDone = 0;
+    cancelled = false;
+    wallSeconds = 0.0;
+    startTicks = juce::Time::getHighResolutionTicks();
+
+    const int numWorkers = juce::jlimit(1, juce::jmax(1, numChunks), juce::SystemStats::getNumCpus());
+    workersRunning = numWorkers;
+    running = true;
+
+    for (int w = 0; w < numWorkers; ++w)
+        workers.push_back(std::make_unique<Worker>(*this, name));
+
+    for (auto& worker : workers)
+        worker->startThread(juce::Thread::Priority::low);
+}
+
+void ChunkedJob::cancel()
+{
+    cancelled = true;
+
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    for (auto& worker : workers)
+        worker->stopThread(2000);
+
+    workers.clear();
+    workersRunning = 0;
+    running = false;
+}
+
+float ChunkedJob::getProgress() const noexcept
+{
+    return numChunks == 0 ? 0.0f : (float)chunksDone.load() / (float)numChunks;
+}
+
+void ChunkedJob::workerFinished()
+{
+    // The last worker out completes the job and reports
+    if (--workersRunning > 0 || cancelled.load())
+        return;
+
+    if (onComplete != nullptr)
+        onComplete();
+
+    wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    running = false;
+
+    if (onFinished != nullptr)
+        juce::MessageManager::callAsync(onFinished);
+}
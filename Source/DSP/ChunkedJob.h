@@ -0,0 +1,48 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Background job made of independent chunks, for the offline scans (recording analysis,
+// event search): one low-priority worker per core (at most one per chunk) takes chunk
+// indices in order from a shared counter until none are left or the job is cancelled.
+// The last worker out runs onComplete on its own thread, then posts onFinished to the
+// message thread; neither runs after cancel().
+class ChunkedJob
+{
+public:
+    using ChunkFunction = std::function<void(int chunk)>;
+
+    explicit ChunkedJob(const juce::String& threadName);
+    ~ChunkedJob();
+
+    // Message thread. makeWorker runs once on each worker thread and returns the function
+    // that worker calls per chunk, so per-worker scratch can live in its captures.
+    void start(int numChunks, std::function<ChunkFunction()> makeWorker,
+               std::function<void()> onComplete, std::function<void()> onFinished);
+    void cancel();
+
+    bool isRunning() const noexcept { return running.load(); }
+    float getProgress() const noexcept;
+    double getWallSeconds() const noexcept { return wallSeconds; }   // valid once finished
+
+private:
+    class Worker;
+
+    void workerFinished();
+
+    juce::String name;
+    int numChunks = 0;
+    std::function<ChunkFunction()> makeWorker;
+    std::function<void()> onComplete, onFinished;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> nextChunk{ 0 };
+    std::atomic<int> chunksDone{ 0 };
+    std::atomic<int> workersRunning{ 0 };
+    std::atomic<bool> running{ false };
+    std::atomic<bool> cancelled{ false };
+    juce::int64 startTicks = 0;
+    double wallSeconds = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChunkedJob)
+};
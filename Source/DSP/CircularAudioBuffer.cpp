@@ -5,24 +5,61 @@ void CircularAudioBuffer::prepare(int numChannels, int capacitySamples)
     capacity = capacitySamples;
     writePos = 0;
     storedSamples = 0;
+    totalWritten.store(0);
+    maxBlockSamples.store(0);
     buffer.setSize(numChannels, capacity, false, true, true);
     buffer.clear();
+
+    channelStarts = std::make_unique<std::atomic<juce::int64>[]>((size_t)juce::jmax(1, numChannels));
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelStarts[(size_t)ch].store(0);
+}
+
+juce::int64 CircularAudioBuffer::getChannelStart(int channel) const noexcept
+{
+    return juce::isPositiveAndBelow(channel, buffer.getNumChannels()) ? channelStarts[(size_t)channel].load(std::memory_order_acquire) : 0;
 }
 
-void CircularAudioBuffer::pushBlock(const juce::AudioBuffer<float>& input)
+void CircularAudioBuffer::pushBlock(const juce::AudioBuffer<float>& input, juce::uint32 channelMask)
 {
     const int numChannels = juce::jmin(buffer.getNumChannels(), input.getNumChannels());
-    const int blockSamples = input.getNumSamples();
+    const int blockSamples = juce::jmin(input.getNumSamples(), capacity);
+
+    if (blockSamples <= 0)
+        return;
+
+    // Channel-planar storage: one or two contiguous copies per channel
+    const int firstPart = juce::jmin(capacity - writePos, blockSamples);
+    const int secondPart = blockSamples - firstPart;
+    const int source = input.getNumSamples() - blockSamples;
+
+    const juce::int64 end = totalWritten.load(std::memory_order_relaxed) + blockSamples;
+
+    // Published before the copy, so a reader checking its spans allows for this block
+    if (blockSamples > maxBlockSamples.load(std::memory_order_relaxed))
+        maxBlockSamples.store(blockSamples, std::memory_order_seq_cst);
 
-    for (int i = 0; i < blockSamples; ++i)
+    for (int ch = 0; ch < numChannels; ++ch)
     {
-        for (int ch = 0; ch < numChannels; ++ch)
-            buffer.setSample(ch, writePos, input.getSample(ch, i));
+        // Published before the new total, so no reader takes the skipped block for data
+        if ((channelMask & (1u << ch)) == 0)
+        {
+            channelStarts[(size_t)ch].store(end, std::memory_order_release);
+            continue;
+        }
+
+        const float* src = input.getReadPointer(ch, source);
+        float* dst = buffer.getWritePointer(ch);
 
-        writePos = (writePos + 1) % capacity;
+        juce::FloatVectorOperations::copy(dst + writePos, src, firstPart);
+        if (secondPart > 0)
+            juce::FloatVectorOperations::copy(dst, src + firstPart, secondPart);
     }
 
+    writePos = (writePos + blockSamples) % capacity;
+
     storedSamples = juce::jmin(storedSamples + blockSamples, capacity);
+    totalWritten.fetch_add(blockSamples, std::memory_order_release);
 }
 
 void CircularAudioBuffer::getMostRecentWindow(juce::AudioBuffer<float>& out, int numSamples) const
@@ -47,6 +84,60 @@ void CircularAudioBuffer::getMostRecentWindow(juce::AudioBuffer<float>& out, int
     }
 }
 
+bool CircularAudioBuffer::copyRange(int channel, juce::int64 startSample, int numSamples, float* dest) const noexcept
+{
+    const juce::int64 written = totalWritten.load(std::memory_order_acquire);
+
+    if (capacity == 0 || startSample < written - storedSamples || startSample + numSamples > written
+        || startSample < getChannelStart(channel))
+        return false;
+
+    const int start = static_cast<int>(startSample % capacity);
+    const int firstPart = juce::jmin(capacity - start, numSamples);
+    const float* src = buffer.getReadPointer(channel);
+
+    std::memcpy(dest, src + start, sizeof(float) * firstPart);
+    if (numSamples > firstPart)
+        std::memcpy(dest + firstPart, src, sizeof(float) * (numSamples - firstPart));
+
+    return true;
+}
+
+bool CircularAudioBuffer::getSpans(int channel, juce::int64 startSample, int numSamples, HistorySpans& spans) const noexcept
+{
+    spans.count = 0;
+
+    const juce::int64 written = totalWritten.load(std::memory_order_acquire);
+
+    if (capacity == 0 || !juce::isPositiveAndBelow(channel, buffer.getNumChannels()) || numSamples < 0
+        || startSample < written - juce::jmin<juce::int64>(written, capacity) || startSample + numSamples > written
+        || startSample < getChannelStart(channel))
+        return false;
+
+    const int start = static_cast<int>(startSample % capacity);
+    const int firstPart = juce::jmin(capacity - start, numSamples);
+    const float* src = buffer.getReadPointer(channel);
+
+    spans.add(src + start, firstPart);
+    spans.add(src, numSamples - firstPart);
+    spans.start = startSample;
+    spans.ringStart = startSample;
+    return true;
+}
+
+bool CircularAudioBuffer::isStillValid(const HistorySpans& spans) const noexcept
+{
+    return spans.ringStart >= getOldestIntactSample();
+}
+
+juce::int64 CircularAudioBuffer::getOldestIntactSample() const noexcept
+{
+    // The block being written now is not counted in totalWritten yet, and overwrites up to
+    // one block past the oldest sample held
+    const juce::int64 written = totalWritten.load(std::memory_order_seq_cst);
+    return juce::jmax<juce::int64>(0, written + maxBlockSamples.load(std::memory_order_seq_cst) - capacity);
+}
+
 float CircularAudioBuffer::computeLastVpp()
 {
     float min = FLT_MAX, max = -FLT_MIN;
@@ -1,20 +1,46 @@
 #pragma once
 #include <JuceHeader.h>
+#include "CaptureHistory.h"
 
-class CircularAudioBuffer
+// The RAM history ring (the hot tail of the capture), written by the audio thread
+class CircularAudioBuffer : public CaptureHistory
 {
 public:
     CircularAudioBuffer() = default;
     ~CircularAudioBuffer() = default;
 
     void prepare(int numChannels, int capacitySamples);
-    void pushBlock(const juce::AudioBuffer<float>& input);
+
+    // channelMask has bit c set for every channel carrying data in this block. A channel left
+    // out (a math channel that is off) is not written, and its history restarts after the
+    // block: reads of it from before then fail.
+    void pushBlock(const juce::AudioBuffer<float>& input, juce::uint32 channelMask = ~0u);
     void getMostRecentWindow(juce::AudioBuffer<float>& out, int numSamples) const;
     float computeLastVpp();
 
+    // Absolute sample index (since prepare) of the next sample to be written.
+    juce::int64 getTotalSamplesWritten() const noexcept override { return totalWritten.load(std::memory_order_acquire); }
+    juce::int64 getOldestSample() const noexcept override { return juce::jmax<juce::int64>(0, getTotalSamplesWritten() - capacity); }
+    int getNumChannels() const noexcept override { return buffer.getNumChannels(); }
+    int getCapacity() const noexcept { return capacity; }
+
+    // First absolute sample the channel holds data from
+    juce::int64 getChannelStart(int channel) const noexcept;
+
+    bool getSpans(int channel, juce::int64 startSample, int numSamples, HistorySpans& spans) const noexcept override;
+    bool isStillValid(const HistorySpans& spans) const noexcept override;
+    juce::int64 getOldestIntactSample() const noexcept override;
+
+    // Copies numSamples starting at the absolute index startSample without allocating.
+    // Returns false if that range is no longer (or not yet) held for the channel.
+    bool copyRange(int channel, juce::int64 startSample, int numSamples, float* dest) const noexcept;
+
 private:
     juce::AudioBuffer<float> buffer;
     int capacity = 0;
     int writePos = 0;
     int storedSamples = 0;
+    std::atomic<juce::int64> totalWritten{ 0 };
+    std::atomic<int> maxBlockSamples{ 0 };   // largest block pushed, the most a write in progress can overwrite
+    std::unique_ptr<std::atomic<juce::int64>[]> channelStarts;
 };
@@ -0,0 +1,330 @@
+#include "DeepCaptureBuffer.h"
+
+static const char deepMagic[8] = { 'A', 'U', 'R', 'A', 'D', 'E', 'E', 'P' };
+
+DeepCaptureBuffer::DeepCaptureBuffer(const CircularAudioBuffer& hotTail)
+    : juce::Thread("Deep-Capture"), hot(hotTail)
+{
+}
+
+DeepCaptureBuffer::~DeepCaptureBuffer()
+{
+    release();
+}
+
+juce::File DeepCaptureBuffer::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::tempDirectory)
+        .getChildFile("Auralyzer")
+        .getNonexistentChildFile("capture", ".deep", false);
+}
+
+bool DeepCaptureBuffer::prepare(double newSampleRate, double depthSeconds, const juce::File& file)
+{
+    release();
+
+    if (depthSeconds <= 0.0 || newSampleRate <= 0.0 || hot.getNumChannels() == 0)
+        return false;
+
+    // Whole pages per plane, so every plane starts on a page boundary after the header page
+    const juce::int64 samples = static_cast<juce::int64>(depthSeconds * newSampleRate);
+    const juce::int64 newCapacity = (samples + pageSamples - 1) / pageSamples * pageSamples;
+    const int newNumChannels = hot.getNumChannels();
+    const juce::int64 bytes = (juce::int64)pageSamples * (juce::int64)sizeof(float)
+                            + newCapacity * newNumChannels * (juce::int64)sizeof(float);
+
+    file.getParentDirectory().createDirectory();
+    file.deleteFile();
+
+    {
+        // Extending with truncate leaves a sparse file: disk is only used as history accumulates
+        juce::FileOutputStream out(file);
+        if (!out.openedOk() || !out.setPosition(bytes) || out.truncate().failed())
+            return false;
+    }
+
+    auto newMapping = std::make_unique<Mapping>();
+    newMapping->mappedFile = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite);
+
+    if (newMapping->mappedFile->getData() == nullptr || (juce::int64)newMapping->mappedFile->getSize() < bytes)
+    {
+        newMapping.reset();
+        file.deleteFile();
+        return false;
+    }
+
+    newMapping->file = file;
+    newMapping->storage = static_cast<char*>(newMapping->mappedFile->getData());
+    newMapping->numChannels = newNumChannels;
+    newMapping->sampleRate = newSampleRate;
+    newMapping->capacity = newCapacity;
+    newMapping->planeStride = newCapacity;
+    newMapping->channelStarts = std::make_unique<std::atomic<juce::int64>[]>((size_t)newNumChannels);
+
+    // The deep history starts with what the RAM ring already holds, less one chunk at its
+    // oldest end: the audio thread would overwrite that before the first copy finished
+    const juce::int64 start = juce::jlimit(hot.getOldestSample(), hot.getTotalSamplesWritten(),
+                                           hot.getOldestIntactSample() + copyChunk);
+    for (int c = 0; c < newNumChannels; ++c)
+        newMapping->channelStarts[(size_t)c].store(juce::jmax(start, hot.getChannelStart(c)));
+
+    firstSample = start;
+    written = start;
+    lostSamples = 0;
+
+    auto& header = *reinterpret_cast<Header*>(newMapping->storage);
+    std::memcpy(header.magic, deepMagic, sizeof(deepMagic));
+    header.version = formatVersion;
+    header.numChannels = (juce::uint32)newNumChannels;
+    header.sampleRate = newSampleRate;
+    header.capacity = newCapacity;
+    header.planeStride = newCapacity;
+    header.firstSample = start;
+    header.written = start;
+
+    mapping = std::move(newMapping);
+    current = mapping.get();
+
+    startThread(juce::Thread::Priority::low);
+    return true;
+}
+
+void DeepCaptureBuffer::release()
+{
+    stopThread(2000);
+
+    if (mapping == nullptr)
+        return;
+
+    // Unpublish, then wait out the readers that may have taken the mapping before it went.
+    // A reader counts itself before it loads current, and readers arriving after the flip
+    // count in the other slot and can only see nullptr.
+    current = nullptr;
+    const int previous = epoch.fetch_xor(1);
+
+    while (readers[(size_t)previous].load() > 0)
+        juce::Thread::yield();
+
+    const auto file = mapping->file;
+    mapping.reset();
+    file.deleteFile();
+}
+
+int DeepCaptureBuffer::beginRead() const noexcept
+{
+    // Retry if the epoch flipped between choosing the slot and counting in it: release
+    // might already have drained that slot
+    for (;;)
+    {
+        const int slot = epoch.load();
+        ++readers[(size_t)slot];
+
+        if (epoch.load() == slot)
+            return slot;
+
+        --readers[(size_t)slot];
+    }
+}
+
+double DeepCaptureBuffer::getDepthSeconds() const noexcept
+{
+    const ScopedRead read(*this);
+    const auto* m = current.load();
+    return m != nullptr ? m->capacity / m->sampleRate : 0.0;
+}
+
+float* DeepCaptureBuffer::Mapping::plane(int channel) const noexcept
+{
+    return reinterpret_cast<float*>(storage) + pageSamples + planeStride * channel;
+}
+
+juce::int64 DeepCaptureBuffer::getTotalSamplesWritten() const noexcept
+{
+    return hot.getTotalSamplesWritten();
+}
+
+juce::int64 DeepCaptureBuffer::getDeepOldest(const Mapping& m) const noexcept
+{
+    // Keep clear of the region the copy thread may be overwriting right now
+    const juce::int64 guard = juce::jmin<juce::int64>(copyChunk, m.capacity / 2);
+    return juce::jmax(firstSample.load(), written.load(std::memory_order_acquire) - m.capacity + guard);
+}
+
+juce::int64 DeepCaptureBuffer::getOldestSample() const noexcept
+{
+    const ScopedRead read(*this);
+    const auto* m = current.load();
+
+    if (m == nullptr)
+        return hot.getOldestSample();
+
+    return juce::jmin(getDeepOldest(*m), hot.getOldestSample());
+}
+
+juce::int64 DeepCaptureBuffer::getOldestIntactSample() const noexcept
+{
+    // The deep oldest already keeps clear of the copy thread
+    const ScopedRead read(*this);
+    const auto* m = current.load();
+
+    if (m == nullptr)
+        return hot.getOldestIntactSample();
+
+    return juce::jmin(getDeepOldest(*m), hot.getOldestIntactSample());
+}
+
+bool DeepCaptureBuffer::getSpans(int channel, juce::int64 start, int numSamples, HistorySpans& spans) const noexcept
+{
+    spans.count = 0;
+
+    const ScopedRead read(*this);
+    const auto* m = current.load();
+
+    // The RAM tail serves everything it still holds
+    const juce::int64 hotOldest = hot.getOldestSample();
+    if (m == nullptr || start >= hotOldest)
+        return hot.getSpans(channel, start, numSamples, spans);
+
+    const juce::int64 deepEnd = written.load(std::memory_order_acquire);
+    const juce::int64 end = start + numSamples;
+
+    if (end <= deepEnd)
+        return getDeepSpans(*m, channel, start, numSamples, spans);
+
+    // Older part from the mapping, the rest from RAM
+    HistorySpans tail;
+    if (deepEnd < hotOldest
+        || !getDeepSpans(*m, channel, start, static_cast<int>(deepEnd - start), spans)
+        || !hot.getSpans(channel, deepEnd, static_cast<int>(end - deepEnd), tail))
+    {
+        spans.count = 0;
+        return false;
+    }
+
+    for (int p = 0; p < tail.count; ++p)
+        spans.add(tail.parts[(size_t)p].data, tail.parts[(size_t)p].size);
+
+    spans.start = start;
+    spans.ringStart = deepEnd;
+    return true;
+}
+
+bool DeepCaptureBuffer::isStillValid(const HistorySpans& spans) const noexcept
+{
+    // The part read from the RAM tail is checked against the ring, the part read from the
+    // mapping against what the copy thread has overwritten since
+    if (spans.ringStart != std::numeric_limits<juce::int64>::max() && !hot.isStillValid(spans))
+        return false;
+
+    if (spans.start >= spans.ringStart)
+        return true;
+
+    const ScopedRead read(*this);
+    const auto* m = current.load();
+    return m != nullptr && spans.start >= getDeepOldest(*m);
+}
+
+bool DeepCaptureBuffer::getDeepSpans(const Mapping& m, int channel, juce::int64 start, int numSamples, HistorySpans& spans) const noexcept
+{
+    const juce::int64 end = written.load(std::memory_order_acquire);
+
+    if (!juce::isPositiveAndBelow(channel, m.numChannels) || numSamples < 0 || start < getDeepOldest(m) || start + numSamples > end
+        || start < m.channelStarts[(size_t)channel].load(std::memory_order_acquire))
+        return false;
+
+    const juce::int64 position = start % m.capacity;
+    const int firstPart = static_cast<int>(juce::jmin<juce::int64>(m.capacity - position, numSamples));
+
+    spans.add(m.plane(channel) + position, firstPart);
+    spans.add(m.plane(channel), numSamples - firstPart);
+    spans.start = start;
+    spans.ringStart = std::numeric_limits<juce::int64>::max();
+    return true;
+}
+
+void DeepCaptureBuffer::run()
+{
+    // The mapping cannot change while this thread runs: release stops it first
+    const Mapping& m = *mapping;
+
+    while (!threadShouldExit())
+    {
+        copyNewSamples(m);
+        wait(copyIntervalMs);
+    }
+}
+
+bool DeepCaptureBuffer::copyLane(const Mapping& m, int channel, juce::int64 start, juce::int64 end) const noexcept
+{
+    const int n = static_cast<int>(end - start);
+    const juce::int64 position = start % m.capacity;
+    const int firstPart = static_cast<int>(juce::jmin<juce::int64>(m.capacity - position, n));
+
+    return hot.copyRange(channel, start, firstPart, m.plane(channel) + position)
+        && (n == firstPart || hot.copyRange(channel, start + firstPart, n - firstPart, m.plane(channel)));
+}
+
+void DeepCaptureBuffer::restartAt(juce::int64 sample) noexcept
+{
+    const juce::int64 from = written.load();
+
+    if (from < sample)
+        lostSamples.fetch_add((juce::uint64)(sample - from));
+
+    firstSample = sample;
+    written.store(sample, std::memory_order_release);
+}
+
+void DeepCaptureBuffer::copyNewSamples(const Mapping& m)
+{
+    const juce::int64 hotEnd = hot.getTotalSamplesWritten();
+    juce::int64 from = written.load();
+
+    // Fell further behind than the RAM ring reaches (or the ring restarted): the deep
+    // history restarts at what is still available, and the gap is counted
+    if (from < hot.getOldestSample() || from > hotEnd)
+    {
+        restartAt(hot.getOldestSample());
+        from = written.load();
+    }
+
+    while (from < hotEnd && !threadShouldExit())
+    {
+        const int n = static_cast<int>(juce::jmin<juce::int64>(copyChunk, hotEnd - from));
+        bool copied = true;
+
+        for (int c = 0; c < m.numChannels && copied; ++c)
+        {
+            // A channel that was off (a math channel) holds nothing before its start in the
+            // ring, and its deep copy starts there too
+            const juce::int64 laneFrom = juce::jlimit(from, from + n, hot.getChannelStart(c));
+            if (laneFrom > from)
+                m.channelStarts[(size_t)c].store(laneFrom, std::memory_order_release);
+
+            if (laneFrom == from + n || copyLane(m, c, laneFrom, from + n))
+                continue;
+
+            // Switched off while being copied: only that channel restarts
+            if (hot.getChannelStart(c) > laneFrom && hot.getOldestSample() <= from)
+                m.channelStarts[(size_t)c].store(from + n, std::memory_order_release);
+            else
+                copied = false;
+        }
+
+        // A range the ring refused, or overwrote while it was copied, is garbage in the
+        // mapping: it is never published, and the deep history restarts after it
+        if (!copied || hot.getOldestIntactSample() > from)
+        {
+            restartAt(juce::jmax(from + n, hot.getOldestIntactSample()));
+            from = written.load();
+            break;
+        }
+
+        from += n;
+        written.store(from, std::memory_order_release);
+    }
+
+    auto& header = *reinterpret_cast<Header*>(m.storage);
+    header.firstSample = firstSample.load();
+    header.written = from;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CaptureHistory.h"
+#include "CircularAudioBuffer.h"
+
+// Capture history far beyond the RAM ring: hours of every captured channel in a
+// memory-mapped file ring, so deep memory costs disk and page cache rather than heap.
+// The audio thread is not involved: a background thread copies what the RAM ring (the
+// hot tail) received since its last pass into the mapping, so a page fault can never
+// stall processBlock. Reads use the CaptureHistory spans: the newest samples come from
+// the RAM ring, older ones straight from the mapped pages.
+//
+// File layout: one header page, then one page-aligned plane per channel.
+//
+// The mapping is published through an atomic pointer and never changed while published;
+// release() unpublishes it and unmaps only after the readers that may still hold it
+// left (beginRead/endRead).
+// Spans returned by getSpans stay mapped only inside such a read.
+class DeepCaptureBuffer : public CaptureHistory,
+                          private juce::Thread
+{
+public:
+    explicit DeepCaptureBuffer(const CircularAudioBuffer& hotTail);
+    ~DeepCaptureBuffer() override;
+
+    // Call after the hot tail was prepared. A depth of 0 turns the deep history off;
+    // otherwise the file is created (sparse) and the copy thread started.
+    bool prepare(double sampleRate, double depthSeconds, const juce::File& file);
+    void release();
+
+    bool isActive() const noexcept { return current.load() != nullptr; }
+    double getDepthSeconds() const noexcept;
+    juce::uint64 getLostSamples() const noexcept { return lostSamples.load(); }
+
+    static juce::File getDefaultFile();
+
+    // CaptureHistory, any thread
+    int getNumChannels() const noexcept override { return hot.getNumChannels(); }
+    juce::int64 getTotalSamplesWritten() const noexcept override;
+    juce::int64 getOldestSample() const noexcept override;
+    bool getSpans(int channel, juce::int64 start, int numSamples, HistorySpans& spans) const noexcept override;
+    bool isStillValid(const HistorySpans& spans) const noexcept override;
+    juce::int64 getOldestIntactSample() const noexcept override;
+    int beginRead() const noexcept override;
+    void endRead(int token) const noexcept override { --readers[(size_t)token]; }
+
+private:
+    struct Header
+    {
+        char magic[8];
+        juce::uint32 version;
+        juce::uint32 numChannels;
+        double sampleRate;
+        juce::int64 capacity;       // samples per channel
+        juce::int64 planeStride;    // samples between channel planes
+        juce::int64 firstSample;    // oldest absolute index copied since prepare
+        juce::int64 written;        // absolute index of the next sample to copy
+    };
+
+    // Fixed from prepare until release
+    struct Mapping
+    {
+        juce::File file;
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        char* storage = nullptr;
+        int numChannels = 0;
+        double sampleRate = 0.0;
+        juce::int64 capacity = 0;
+        juce::int64 planeStride = 0;
+        std::unique_ptr<std::atomic<juce::int64>[]> channelStarts;   // as CircularAudioBuffer's
+
+        float* plane(int channel) const noexcept;
+    };
+
+    void run() override;
+    void copyNewSamples(const Mapping& m);
+    bool copyLane(const Mapping& m, int channel, juce::int64 start, juce::int64 end) const noexcept;
+    void restartAt(juce::int64 sample) noexcept;
+    juce::int64 getDeepOldest(const Mapping& m) const noexcept;
+    bool getDeepSpans(const Mapping& m, int channel, juce::int64 start, int numSamples, HistorySpans& spans) const noexcept;
+
+    static constexpr juce::uint32 formatVersion = 1;
+    static constexpr int pageSamples = 4096 / (int)sizeof(float);
+    static constexpr int copyIntervalMs = 50;
+    static constexpr int copyChunk = 1 << 16;   // samples per channel per copy step
+
+    const CircularAudioBuffer& hot;
+
+    std::unique_ptr<Mapping> mapping;          // owned here, published through current
+    std::atomic<const Mapping*> current{ nullptr };
+
+    // Readers count themselves in the slot of the current epoch; release flips the epoch
+    // and drains only the old slot, so a stream of new readers cannot hold it up
+    mutable std::array<std::atomic<int>, 2> readers{};
+    std::atomic<int> epoch{ 0 };
+
+    std::atomic<juce::int64> firstSample{ 0 };
+    std::atomic<juce::int64> written{ 0 };
+    std::atomic<juce::uint64> lostSamples{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeepCaptureBuffer)
+};
@@ -0,0 +1,117 @@
+#include "EquivalentTimeSampler.h"
+
+void EquivalentTimeSampler::prepare(double newSampleRate, int newNumBins)
+{
+    sampleRate = newSampleRate;
+    numBins = newNumBins;
+
+    binValue.assign((size_t)numBins, 0.0f);
+    binCount.assign((size_t)numBins, 0);
+
+    const juce::SpinLock::ScopedLockType lock(publishLock);
+    publishedBins.assign((size_t)numBins, std::numeric_limits<float>::quiet_NaN());
+    publishedPeriod = 0.0;
+
+    crossingCount = 0;
+    period = 0.0;
+    lastCrossing = -1.0;
+    sampleIndex = 0;
+    previousSample = 0.0f;
+    samplesSincePublish = 0;
+}
+
+void EquivalentTimeSampler::reset()
+{
+    std::fill(binValue.begin(), binValue.end(), 0.0f);
+    std::fill(binCount.begin(), binCount.end(), 0u);
+}
+
+void EquivalentTimeSampler::process(const float* data, int numSamples)
+{
+    if (!enabled.load(std::memory_order_relaxed) || binValue.empty())
+    {
+        sampleIndex += numSamples;
+        crossingCount = 0;
+        period = 0.0;
+        return;
+    }
+
+    double binsPerSample = period > 0.0 ? numBins / period : 0.0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float x = data[i];
+
+        if (previousSample < level && x >= level)
+        {
+            // Linear interpolation of the crossing between the two samples
+            const double fraction = (level - previousSample) / (double)(x - previousSample);
+            addCrossing((double)(sampleIndex + i - 1) + fraction);
+            binsPerSample = period > 0.0 ? numBins / period : 0.0;
+        }
+
+        previousSample = x;
+
+        if (period <= 0.0 || lastCrossing < 0.0)
+            continue;
+
+        double phase = ((double)(sampleIndex + i) - lastCrossing) * binsPerSample;
+        if (phase >= numBins)
+            phase = std::fmod(phase, (double)numBins);
+
+        const int bin = static_cast<int>(phase);
+        auto& count = binCount[(size_t)bin];
+        if (count < maxBinWeight)
+            ++count;
+
+        binValue[(size_t)bin] += (x - binValue[(size_t)bin]) / (float)count;
+    }
+
+    sampleIndex += numSamples;
+    samplesSincePublish += numSamples;
+
+    if (samplesSincePublish >= (int)(sampleRate / 60.0))
+        publish();
+}
+
+void EquivalentTimeSampler::addCrossing(double time)
+{
+    crossings[(size_t)(crossingCount % numCrossings)] = time;
+    ++crossingCount;
+    lastCrossing = time;
+
+    if (crossingCount < minCrossingsToLock)
+        return;
+
+    // Period from the span of the stored crossings: the timestamp error is divided by
+    // the number of cycles, so the estimate gets finer the longer the signal is stable
+    const int span = juce::jmin(crossingCount, numCrossings) - 1;
+    const double oldest = crossings[(size_t)((crossingCount - 1 - span) % numCrossings)];
+    const double estimate = (time - oldest) / span;
+
+    if (period <= 0.0 || std::abs(estimate - period) > period * 0.005)
+        reset(); // a different signal, start folding again
+
+    period = estimate;
+}
+
+void EquivalentTimeSampler::publish()
+{
+    samplesSincePublish = 0;
+
+    const juce::SpinLock::ScopedTryLockType lock(publishLock);
+    if (!lock.isLocked())
+        return;
+
+    for (int bin = 0; bin < numBins; ++bin)
+        publishedBins[(size_t)bin] = binCount[(size_t)bin] > 0 ? binValue[(size_t)bin]
+                                                               : std::numeric_limits<float>::quiet_NaN();
+    publishedPeriod = period;
+}
+
+double EquivalentTimeSampler::getFoldedPeriod(std::vector<float>& dest) const
+{
+    const juce::SpinLock::ScopedLockType lock(publishLock);
+    dest = publishedBins;
+    return publishedPeriod;
+}
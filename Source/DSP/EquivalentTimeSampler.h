@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Equivalent-time sampling for repetitive signals. Rising crossings are timestamped with
+// sub-sample precision, the period is estimated over many cycles and every incoming sample
+// is folded onto a single period and averaged into a high-resolution phase bin array.
+// process() runs on the audio thread and only does incremental accumulation.
+class EquivalentTimeSampler
+{
+public:
+    static constexpr int defaultNumBins = 4096;
+
+    EquivalentTimeSampler() = default;
+
+    void prepare(double sampleRate, int numBins = defaultNumBins);
+    void reset();
+
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept { return enabled.load(); }
+    void setLevel(float newLevel) noexcept { level = newLevel; }
+
+    // Audio thread
+    void process(const float* data, int numSamples);
+
+    // Message thread: copies the folded period into dest (NaN for bins not hit yet).
+    // Returns the period in samples, or 0 when not locked onto a periodic signal.
+    double getFoldedPeriod(std::vector<float>& dest) const;
+
+private:
+    void addCrossing(double time);
+    void publish();
+
+    static constexpr int numCrossings = 64;     // crossings used for the period estimate
+    static constexpr int minCrossingsToLock = 8;
+    static constexpr int maxBinWeight = 64;     // bins behave as a moving average afterwards
+
+    std::atomic<bool> enabled{ false };
+    float level = 0.0f;
+    double sampleRate = 48000.0;
+    int numBins = defaultNumBins;
+
+    // Audio thread state
+    std::vector<float> binValue;
+    std::vector<juce::uint32> binCount;
+    std::array<double, numCrossings> crossings{};
+    int crossingCount = 0;
+    double period = 0.0;
+    double lastCrossing = -1.0;
+    juce::int64 sampleIndex = 0;
+    float previousSample = 0.0f;
+    int samplesSincePublish = 0;
+
+    // Published copy for the UI
+    mutable juce::SpinLock publishLock;
+    std::vector<float> publishedBins;
+    double publishedPeriod = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EquivalentTimeSampler)
+};
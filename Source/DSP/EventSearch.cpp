@@ -0,0 +1,388 @@
+#include "EventSearch.h"
+
+namespace
+{
+    using Hit = EventSearch::Hit;
+    using Condition = EventSearch::Condition;
+
+    constexpr int blockSamples = 256;       // min/max pre-screen granularity
+    constexpr int spanSamples = 1 << 16;    // largest range requested from the history at once
+
+    // Streaming detector for one chunk. Samples arrive in order from the start of the
+    // context; only hits starting in [from, to) are kept.
+    class Scanner
+    {
+    public:
+        Scanner(const EventSearch::Query& queryToUse, double sampleRate, juce::int64 fromSample, juce::int64 toSample,
+                std::vector<Hit>& hitsToFill)
+            : query(queryToUse), from(fromSample), to(toSample), hits(hitsToFill)
+        {
+            widthSamples = juce::jmax<juce::int64>(1, static_cast<juce::int64>(query.maxWidthSeconds * sampleRate));
+            minPeriod = query.maxFrequency > 0.0f ? static_cast<juce::int64>(sampleRate / query.maxFrequency) : 0;
+            maxPeriod = query.minFrequency > 0.0f ? static_cast<juce::int64>(sampleRate / query.minFrequency) : 0;
+        }
+
+        void setPrevious(float sample) noexcept
+        {
+            previous = sample;
+            hasPrevious = true;
+            wasOutside = isOutside(sample);
+        }
+
+        // Returns false once nothing past position can add a hit to this chunk
+        bool process(const float* data, int numSamples, juce::int64 position) noexcept
+        {
+            for (int i = 0; i < numSamples; i += blockSamples)
+            {
+                const int n = juce::jmin(blockSamples, numSamples - i);
+                const juce::int64 blockStart = position + i;
+
+                if (blockStart >= to && !isPending(blockStart))
+                    return false;
+
+                if (!hasPrevious)
+                    setPrevious(data[i]);
+
+                if (canSkip(juce::FloatVectorOperations::findMinAndMax(data + i, n)))
+                {
+                    previous = data[i + n - 1];
+                    wasOutside = isOutside(previous);
+                    checkTimeout(blockStart + n);
+                    continue;
+                }
+
+                for (int k = 0; k < n; ++k)
+                    processSample(data[i + k], blockStart + k);
+
+                checkTimeout(blockStart + n);
+            }
+
+            return true;
+        }
+
+        // The scan ended (end of history or of the context): close a run still open
+        void finish(juce::int64 end) noexcept
+        {
+            if (query.condition == Condition::outsideWindow && runStart >= 0)
+                addHit(runStart, end - runStart);
+
+            runStart = -1;
+        }
+
+    private:
+        bool isOutside(float x) const noexcept { return x > query.upper || x < query.lower; }
+
+        bool isPending(juce::int64 position) const noexcept
+        {
+            switch (query.condition)
+            {
+                case Condition::glitch:
+                    return lastCrossing >= from && lastCrossing < to && position - lastCrossing <= widthSamples;
+                case Condition::frequencyExcursion:
+                    return lastRising >= from && lastRising < to && !timeoutReported
+                        && position - lastRising <= juce::jmax(minPeriod, maxPeriod);
+                case Condition::outsideWindow:
+                    return runStart >= from && runStart < to;
+                case Condition::risingEdge:
+                case Condition::fallingEdge:
+                default:
+                    return false;
+            }
+        }
+
+        // True if no sample of the block (with the one before it) can change the state
+        bool canSkip(juce::Range<float> range) const noexcept
+        {
+            const float lo = juce::jmin(range.getStart(), previous);
+            const float hi = juce::jmax(range.getEnd(), previous);
+
+            if (query.condition == Condition::outsideWindow)
+                return runStart < 0 && lo >= query.lower && hi <= query.upper;
+
+            return !(lo < query.level && hi >= query.level);
+        }
+
+        void processSample(float x, juce::int64 position) noexcept
+        {
+            if (query.condition == Condition::outsideWindow)
+            {
+                const bool outside = isOutside(x);
+
+                if (outside && !wasOutside)
+                    runStart = position;
+                else if (!outside && runStart >= 0)
+                {
+                    addHit(runStart, position - runStart);
+                    runStart = -1;
+                }
+
+                wasOutside = outside;
+            }
+            else if (previous < query.level && x >= query.level)
+            {
+                onCrossing(position, true);
+            }
+            else if (previous >= query.level && x < query.level)
+            {
+                onCrossing(position, false);
+            }
+
+            previous = x;
+        }
+
+        void onCrossing(juce::int64 position, bool rising) noexcept
+        {
+            switch (query.condition)
+            {
+                case Condition::risingEdge:
+                    if (rising)
+                        addHit(position, 0);
+                    break;
+
+                case Condition::fallingEdge:
+                    if (!rising)
+                        addHit(position, 0);
+                    break;
+
+                case Condition::glitch:
+                    if (lastCrossing >= 0 && position - lastCrossing < widthSamples)
+                        addHit(lastCrossing, position - lastCrossing);
+                    lastCrossing = position;
+                    break;
+
+                case Condition::frequencyExcursion:
+                    if (!rising)
+                        break;
+
+                    checkTimeout(position);
+                    if (lastRising >= 0 && position - lastRising < minPeriod)
+                        addHit(lastRising, position - lastRising);
+
+                    lastRising = position;
+                    timeoutReported = false;
+                    break;
+
+                case Condition::outsideWindow:
+                default:
+                    break;
+            }
+        }
+
+        // A period longer than the slowest allowed one is reported as soon as it is
+        // overdue, so a signal that stops is found without waiting for its next edge.
+        // Its length is then only known to exceed maxPeriod.
+        void checkTimeout(juce::int64 position) noexcept
+        {
+            if (query.condition != Condition::frequencyExcursion || maxPeriod <= 0 || lastRising < 0 || timeoutReported)
+                return;
+
+            if (position - lastRising > maxPeriod)
+            {
+                addHit(lastRising, maxPeriod + 1);
+                timeoutReported = true;
+            }
+        }
+
+        void addHit(juce::int64 sample, juce::int64 length) noexcept
+        {
+            if (sample >= from && sample < to && hits.size() < EventSearch::maxHits)
+                hits.push_back({ sample, length });
+        }
+
+        const EventSearch::Query& query;
+        const juce::int64 from, to;
+        std::vector<Hit>& hits;
+
+        juce::int64 widthSamples = 1, minPeriod = 0, maxPeriod = 0;
+        float previous = 0.0f;
+        bool hasPrevious = false;
+        bool wasOutside = true;     // a run already in progress when the scan starts is not an event
+        juce::int64 lastCrossing = -1;
+        juce::int64 lastRising = -1;
+        bool timeoutReported = false;
+        juce::int64 runStart = -1;
+    };
+}
+
+EventSearch::~EventSearch()
+{
+    cancel();
+}
+
+juce::Result EventSearch::start(const CaptureHistory& historyToSearch, double newSampleRate, const Query& newQuery,
+                                std::function<void()> finished)
+{
+    cancel();
+
+    if (!juce::isPositiveAndBelow(newQuery.channel, historyToSearch.getNumChannels()) || newSampleRate <= 0.0)
+        return juce::Result::fail("Nothing captured on that channel yet");
+
+    history = &historyToSearch;
+    sampleRate = newSampleRate;
+    query = newQuery;
+    rangeStart = history->getOldestSample();
+    rangeEnd = history->getTotalSamplesWritten();
+
+    // Context each chunk scans beyond its own range
+    const juce::int64 width = static_cast<juce::int64>(query.maxWidthSeconds * sampleRate) + 1;
+    const juce::int64 slowest = query.minFrequency > 0.0f ? static_cast<juce::int64>(sampleRate / query.minFrequency) + 1 : 0;
+    const juce::int64 fastest = query.maxFrequency > 0.0f ? static_cast<juce::int64>(sampleRate / query.maxFrequency) + 1 : 0;
+
+    switch (query.condition)
+    {
+        case Condition::glitch:             contextBefore = contextAfter = width; break;
+        case Condition::frequencyExcursion: contextBefore = contextAfter = juce::jmax(slowest, fastest); break;
+        case Condition::outsideWindow:
+        case Condition::risingEdge:
+        case Condition::fallingEdge:
+        default:                            contextBefore = contextAfter = 0; break;
+    }
+
+    // A few chunks per core so uneven chunks still balance, but no chunk shorter than the
+    // context it needs (or so short that setting it up dominates). The context is then
+    // capped at one chunk either side.
+    const juce::int64 length = juce::jmax<juce::int64>(0, rangeEnd - rangeStart);
+    const juce::int64 perChunk = length / ((juce::int64)juce::SystemStats::getNumCpus() * chunksPerCore);
+    chunkSamples = juce::jlimit(minChunkSamples, maxChunkSamples, juce::jmax(perChunk, contextBefore));
+
+    if (query.condition == Condition::outsideWindow)
+        contextAfter = chunkSamples;
+
+    contextBefore = juce::jmin(contextBefore, chunkSamples);
+    contextAfter = juce::jmin(contextAfter, chunkSamples);
+
+    const auto numChunks = (length + chunkSamples - 1) / chunkSamples;
+    chunkHits.assign((size_t)numChunks, {});
+    hits.clear();
+    truncated = false;
+    skippedSamples = 0;
+
+    job.start((int)numChunks,
+              [this] { return [this](int index) { searchChunk(index, chunkHits[(size_t)index]); }; },
+              [this] { mergeChunks(); },
+              std::move(finished));
+
+    return juce::Result::ok();
+}
+
+void EventSearch::cancel()
+{
+    job.cancel();
+}
+
+void EventSearch::clear()
+{
+    cancel();
+    hits.clear();
+    chunkHits.clear();
+    truncated = false;
+}
+
+void EventSearch::searchChunk(int index, std::vector<Hit>& found) noexcept
+{
+    const juce::int64 from = rangeStart + (juce::int64)index * chunkSamples;
+    const juce::int64 to = juce::jmin(from + chunkSamples, rangeEnd);
+    const juce::int64 scanStart = juce::jmax(history->getOldestIntactSample(), from - contextBefore);
+    const juce::int64 scanEnd = juce::jmin(history->getTotalSamplesWritten(), to + contextAfter);
+
+    std::optional<Scanner> scanner;
+    scanner.emplace(query, sampleRate, from, to, found);
+
+    // The deep history keeps its mapping while this chunk reads from it
+    const CaptureHistory::ScopedRead read(*history);
+
+    float previous = 0.0f;
+    if (HistoryScan::copy(*history, query.channel, scanStart - 1, 1, &previous))
+        scanner->setPrevious(previous);
+
+    HistorySpans spans;
+    juce::int64 position = scanStart;
+
+    while (position < scanEnd)
+    {
+        const int n = static_cast<int>(juce::jmin<juce::int64>(spanSamples, scanEnd - position));
+        const size_t kept = found.size();
+
+        if (history->getSpans(query.channel, position, n, spans))
+        {
+            bool more = true;
+            juce::int64 spanPosition = position;
+
+            for (int p = 0; p < spans.count && more; ++p)
+            {
+                const auto& span = spans.parts[(size_t)p];
+                more = scanner->process(span.data, span.size, spanPosition);
+                spanPosition += span.size;
+            }
+
+            // The hits stand only if the audio thread did not overwrite the spans meanwhile
+            if (history->isStillValid(spans))
+            {
+                if (!more)
+                    return;
+
+                position += n;
+                continue;
+            }
+
+            found.resize(kept);
+        }
+
+        // Overwritten before or while it was read (at the oldest end of the live ring): its
+        // hits are dropped, and the scan restarts past what the ring has overwritten, with no
+        // state carried over
+        const juce::int64 intact = history->getOldestIntactSample();
+        const juce::int64 next = intact > position ? juce::jmin(position + n, intact) : position + n;
+
+        skippedSamples += juce::jmax<juce::int64>(0, juce::jmin(to, next) - juce::jmax(position, from));
+        position = next;
+        scanner.emplace(query, sampleRate, from, to, found);
+    }
+
+    scanner->finish(scanEnd);
+}
+
+void EventSearch::mergeChunks()
+{
+    // On the last worker out: the chunks are already in order
+    for (auto& chunk : chunkHits)
+    {
+        const size_t room = maxHits - hits.size();
+        truncated = truncated || chunk.size() > room;
+        hits.insert(hits.end(), chunk.begin(), chunk.begin() + (std::ptrdiff_t)juce::jmin(room, chunk.size()));
+        std::vector<Hit>().swap(chunk);
+    }
+}
+
+int EventSearch::findNext(juce::int64 sample) const noexcept
+{
+    const auto it = std::upper_bound(hits.begin(), hits.end(), sample,
+                                     [](juce::int64 s, const Hit& hit) { return s < hit.sample; });
+    return it == hits.end() ? -1 : (int)std::distance(hits.begin(), it);
+}
+
+int EventSearch::findPrevious(juce::int64 sample) const noexcept
+{
+    const auto it = std::lower_bound(hits.begin(), hits.end(), sample,
+                                     [](const Hit& hit, juce::int64 s) { return hit.sample < s; });
+    return it == hits.begin() ? -1 : (int)std::distance(hits.begin(), it) - 1;
+}
+
+juce::String EventSearch::describe(const Query& query)
+{
+    auto formatSeconds = [](double seconds)
+    {
+        return seconds >= 1.0e-3 ? juce::String(seconds * 1.0e3, 2) + " ms" : juce::String(seconds * 1.0e6, 1) + " us";
+    };
+
+    switch (query.condition)
+    {
+        case Condition::risingEdge:     return "Rising edges through " + juce::String(query.level, 3);
+        case Condition::fallingEdge:    return "Falling edges through " + juce::String(query.level, 3);
+        case Condition::glitch:         return "Glitches narrower than " + formatSeconds(query.maxWidthSeconds);
+        case Condition::outsideWindow:  return "Outside " + juce::String(query.lower, 3) + " .. " + juce::String(query.upper, 3);
+        case Condition::frequencyExcursion:
+            return "Frequency outside " + juce::String(query.minFrequency, 1) + " .. " + juce::String(query.maxFrequency, 1) + " Hz";
+        default:                        return {};
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CaptureHistory.h"
+#include "ChunkedJob.h"
+
+// Finds every occurrence of a condition across the whole capture history (seconds in RAM
+// or hours in the deep history) and keeps the hits as a sorted index the time view steps
+// through. The range is cut into chunks, a few per core and sized from the range, that
+// one worker per core (ChunkedJob) scans in place through the history spans. Each
+// 256-sample block is first reduced to its min/max with the vectorised
+// FloatVectorOperations, and only blocks that can hold an event are walked sample by
+// sample, so quiet stretches cost little more than a memory read.
+//
+// The spans are checked after each read: hits from audio the ring overwrote meanwhile are
+// dropped and the samples counted as skipped.
+//
+// Chunks overlap by the context a condition needs (a glitch's width, a period), and a hit
+// belongs to the chunk its first sample falls in, so none is lost or found twice at the
+// seams.
+class EventSearch
+{
+public:
+    enum class Condition
+    {
+        risingEdge,             // crossing up through level
+        fallingEdge,            // crossing down through level
+        glitch,                 // pulse either side of level narrower than maxWidthSeconds
+        outsideWindow,          // runs of samples above upper or below lower
+        frequencyExcursion      // period between rising crossings outside [minFrequency, maxFrequency]
+    };
+
+    struct Query
+    {
+        Condition condition = Condition::risingEdge;
+        int channel = 0;
+        float level = 0.0f;
+        float lower = -1.0f, upper = 1.0f;
+        double maxWidthSeconds = 1.0e-3;
+        float minFrequency = 0.0f;          // 0: no lower bound
+        float maxFrequency = 0.0f;          // 0: no upper bound
+    };
+
+    struct Hit
+    {
+        juce::int64 sample = 0;             // absolute history index of the event's start
+        juce::int64 length = 0;             // pulse width, run length or period; 0 for edges
+    };
+
+    static constexpr juce::int64 minChunkSamples = 1 << 14;
+    static constexpr juce::int64 maxChunkSamples = 1 << 20;
+    static constexpr int chunksPerCore = 4;
+    static constexpr size_t maxHits = 1 << 20;
+
+    EventSearch() = default;
+    ~EventSearch();
+
+    // Message thread. Searches everything the history holds now; onFinished is posted to
+    // the message thread when the scan completes (not after cancel()). The history must
+    // outlive the search.
+    juce::Result start(const CaptureHistory& history, double sampleRate, const Query& query, std::function<void()> onFinished);
+    void cancel();
+
+    // Cancels and forgets the hits, for when the history they index is restarted
+    void clear();
+
+    bool isRunning() const noexcept { return job.isRunning(); }
+    float getProgress() const noexcept { return job.getProgress(); }
+
+    // Valid once finished, ordered by position
+    const std::vector<Hit>& getHits() const noexcept { return hits; }
+    const Query& getQuery() const noexcept { return query; }
+    bool wasTruncated() const noexcept { return truncated; }
+    juce::int64 getSkippedSamples() const noexcept { return skippedSamples.load(); }   // overwritten before or while scanned
+    double getWallSeconds() const noexcept { return job.getWallSeconds(); }
+
+    // Index of the first hit after / last hit before an absolute sample, or -1
+    int findNext(juce::int64 sample) const noexcept;
+    int findPrevious(juce::int64 sample) const noexcept;
+
+    static juce::String describe(const Query& query);
+
+private:
+    void searchChunk(int index, std::vector<Hit>& chunkHits) noexcept;
+    void mergeChunks();
+
+    const CaptureHistory* history = nullptr;
+    double sampleRate = 0.0;
+    Query query;
+    juce::int64 rangeStart = 0, rangeEnd = 0;
+    juce::int64 chunkSamples = maxChunkSamples;
+    juce::int64 contextBefore = 0, contextAfter = 0;
+
+    std::vector<std::vector<Hit>> chunkHits;
+    std::vector<Hit> hits;
+    bool truncated = false;
+
+    std::atomic<juce::int64> skippedSamples{ 0 };
+    ChunkedJob job{ "Event-Search" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EventSearch)
+};
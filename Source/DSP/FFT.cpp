@@ -2,41 +2,78 @@
 
 FFT::FFT() : juce::Thread("FFT-Processor")
 {
-    averager.clear();
+    clearAveragers();
 }
 
 FFT::~FFT() 
 {
 }
 
-void FFT::addAudioData(const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels)
+void FFT::addAudioData(const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels, juce::uint32 laneMask)
 {
+    if (!active.load(std::memory_order_relaxed))
+        return;
+
     if (abstractFifo.getFreeSpace() < buffer.getNumSamples())
+    {
+        droppedSamples.fetch_add((juce::uint64)buffer.getNumSamples(), std::memory_order_relaxed);
         return;
+    }
 
     int start1, block1, start2, block2;
     abstractFifo.prepareToWrite(buffer.getNumSamples(), start1, block1, start2, block2);
 
-    audioFifo.copyFrom(0, start1, buffer.getReadPointer(startChannel), block1);
-    if (block2 > 0)
-        audioFifo.copyFrom(0, start2, buffer.getReadPointer(startChannel, block1), block2);
+    // One FIFO lane per analysed channel. With a single lane the inputs are summed, as
+    // before; otherwise missing and masked inputs are written as silence so the lanes stay aligned.
+    const int lanes = audioFifo.getNumChannels();
+    activeLanes.store(lanes == 1 ? ~0u : laneMask, std::memory_order_relaxed);
 
-    for (int channel = startChannel + 1; channel < startChannel + numChannels; ++channel)
+    for (int lane = 0; lane < lanes; ++lane)
     {
-        if (block1 > 0) audioFifo.addFrom(0, start1, buffer.getReadPointer(channel), block1);
-        if (block2 > 0) audioFifo.addFrom(0, start2, buffer.getReadPointer(channel, block1), block2);
+        const bool summed = lanes == 1;
+        const int first = startChannel + lane;
+        const int last = summed ? startChannel + numChannels : first + 1;
+
+        if (first >= buffer.getNumChannels() || first >= startChannel + numChannels
+            || (!summed && (laneMask & (1u << lane)) == 0))
+        {
+            if (block1 > 0) audioFifo.clear(lane, start1, block1);
+            if (block2 > 0) audioFifo.clear(lane, start2, block2);
+            continue;
+        }
+
+        if (block1 > 0) audioFifo.copyFrom(lane, start1, buffer.getReadPointer(first), block1);
+        if (block2 > 0) audioFifo.copyFrom(lane, start2, buffer.getReadPointer(first, block1), block2);
+
+        for (int channel = first + 1; channel < juce::jmin(last, buffer.getNumChannels()); ++channel)
+        {
+            if (block1 > 0) audioFifo.addFrom(lane, start1, buffer.getReadPointer(channel), block1);
+            if (block2 > 0) audioFifo.addFrom(lane, start2, buffer.getReadPointer(channel, block1), block2);
+        }
     }
     abstractFifo.finishedWrite(block1 + block2);
     waitForData.signal();
 }
 
-void FFT::setUpFrequencyAnalyzer(int audioFifoSize, float sampleRateToUse)
+void FFT::setUpFrequencyAnalyzer(int audioFifoSize, float sampleRateToUse, bool startAnalysisThread, int numChannels)
 {
+    // The thread reads the FIFO and the averagers; never resize them under it
+    stopThread(1000);
+
+    numChannels = juce::jmax(1, numChannels);
     sampleRate = sampleRateToUse;
-    audioFifo.setSize(1, audioFifoSize);
+    audioFifo.setSize(numChannels, audioFifoSize);
     abstractFifo.setTotalSize(audioFifoSize);
 
-    startThread(juce::Thread::Priority::normal);
+    {
+        juce::ScopedLock lock(pathCreationLock);
+        averagers.resize((size_t)numChannels, juce::AudioBuffer<float>{ 9, fft.getSize() / 2 });
+        framesAveraged.resize((size_t)numChannels);
+        clearAveragers();
+    }
+
+    if (startAnalysisThread)
+        startThread(juce::Thread::Priority::normal);
 }
 
 void FFT::run()
@@ -45,43 +82,93 @@ void FFT::run()
 
     while (!threadShouldExit())
     {
-        if (abstractFifo.getNumReady() >= fftSize)
+        if (!active.load(std::memory_order_relaxed))
         {
-            fftBuffer.clear();
+            abstractFifo.finishedRead(abstractFifo.getNumReady());
+            wasActive = false;
+            waitForData.wait(100);
+            continue;
+        }
 
-            int start1, block1, start2, block2;
-            abstractFifo.prepareToRead(fftSize, start1, block1, start2, block2);
+        if (!wasActive)
+        {
+            juce::ScopedLock lock(pathCreationLock);
+            clearAveragers();
+            wasActive = true;
+        }
 
-            if (block1 > 0)
-                fftBuffer.copyFrom(0, 0, audioFifo.getReadPointer(0, start1), block1);
+        processNextFrame();
 
-            if (block2 > 0)
-                fftBuffer.copyFrom(0, block1, audioFifo.getReadPointer(0, start2), block2);
+        if (abstractFifo.getNumReady() < fftSize)
+            waitForData.wait(100);
+    }
+}
 
-            abstractFifo.finishedRead((block1 + block2) / 2);
+bool FFT::processNextFrame()
+{
+    const int fftSize = fft.getSize();
 
-            // Normilized Hann windw
-            windowing.multiplyWithWindowingTable(fftBuffer.getWritePointer(0), fftSize);
+    if (abstractFifo.getNumReady() < fftSize)
+        return false;
 
-            // FFT magnitudes
-            fft.performFrequencyOnlyForwardTransform(fftBuffer.getWritePointer(0));
+    int start1, block1, start2, block2;
+    abstractFifo.prepareToRead(fftSize, start1, block1, start2, block2);
 
+    const auto lanes = activeLanes.load(std::memory_order_relaxed);
 
-            // Averaging thread-safe
-            juce::ScopedLock lockedForWriting(pathCreationLock);
-            averager.addFrom(0, 0, averager.getReadPointer(averagerPtr), averager.getNumSamples(), -1.0f);
-            averager.copyFrom(averagerPtr, 0, fftBuffer.getReadPointer(0), averager.getNumSamples(), 1.0f / (averager.getNumSamples() * (averager.getNumChannels() - 1)));
-            averager.addFrom(0, 0, averager.getReadPointer(averagerPtr), averager.getNumSamples());
+    for (int channel = 0; channel < audioFifo.getNumChannels(); ++channel)
+    {
+        const auto bit = 1u << channel;
 
-            if (++averagerPtr == averager.getNumChannels())
-                averagerPtr = 1;
+        if ((lanes & bit) == 0)
+        {
+            analysedLanes &= ~bit;
+            continue;
+        }
 
-            newDataAvailable = true;
+        if ((analysedLanes & bit) == 0)
+        {
+            juce::ScopedLock lock(pathCreationLock);
+            averagers[(size_t)channel].clear();
+            framesAveraged[(size_t)channel] = 0;
+            analysedLanes |= bit;
         }
 
-        if (abstractFifo.getNumReady() < fftSize)
-            waitForData.wait(100);
+        fftBuffer.clear();
+
+        if (block1 > 0)
+            fftBuffer.copyFrom(0, 0, audioFifo.getReadPointer(channel, start1), block1);
+
+        if (block2 > 0)
+            fftBuffer.copyFrom(0, block1, audioFifo.getReadPointer(channel, start2), block2);
+
+        // Normilized Hann windw
+        windowing.multiplyWithWindowingTable(fftBuffer.getWritePointer(0), fftSize);
+
+        // FFT magnitudes
+        fft.performFrequencyOnlyForwardTransform(fftBuffer.getWritePointer(0));
+
+        // Averaging thread-safe
+        juce::ScopedLock lockedForWriting(pathCreationLock);
+        auto& averager = averagers[(size_t)channel];
+        averager.addFrom(0, 0, averager.getReadPointer(averagerPtr), averager.getNumSamples(), -1.0f);
+        averager.copyFrom(averagerPtr, 0, fftBuffer.getReadPointer(0), averager.getNumSamples(), 1.0f / (averager.getNumSamples() * (averager.getNumChannels() - 1)));
+        averager.addFrom(0, 0, averager.getReadPointer(averagerPtr), averager.getNumSamples());
+
+        auto& frames = framesAveraged[(size_t)channel];
+        frames = juce::jmin(frames + 1, averager.getNumChannels() - 1);
+    }
+
+    abstractFifo.finishedRead((block1 + block2) / 2);
+
+    {
+        juce::ScopedLock lockedForWriting(pathCreationLock);
+        if (++averagerPtr == averagers.front().getNumChannels())
+            averagerPtr = 1;
     }
+
+    newDataAvailable = true;
+    return true;
 }
 
 bool FFT::checkForNewData()
@@ -91,26 +178,65 @@ bool FFT::checkForNewData()
     return available;
 }
 
-void FFT::createPath(juce::Path& p, const juce::Rectangle<float> bounds, float minFreq, float dBMin, float dBMax)
+void FFT::createPath(juce::Path& p, const juce::Rectangle<float> bounds, float minFreq, float dBMin, float dBMax, int channel)
 {
+    juce::ScopedLock lockedForReading(pathCreationLock);
+    const auto& averager = getAverager(channel);
+    const float gain = getAverageGain(channel);
+
     p.clear();
     p.preallocateSpace(8 + averager.getNumSamples() * 3);
 
-    juce::ScopedLock lockedForReading(pathCreationLock);
     const auto* fftData = averager.getReadPointer(0);
     const auto factor = bounds.getWidth() / 10.0f;
 
     p.startNewSubPath(bounds.getX() + factor * indexToX(0.0f, minFreq),
-        binToY(fftData[0], bounds, dBMin, dBMax));
+        binToY(fftData[0] * gain, bounds, dBMin, dBMax));
 
     for (int i = 1; i < averager.getNumSamples(); ++i)
     {
         float x = bounds.getX() + factor * indexToX(static_cast<float>(i), minFreq);
-        float y = binToY(fftData[i], bounds, dBMin, dBMax);
+        float y = binToY(fftData[i] * gain, bounds, dBMin, dBMax);
         p.lineTo(x, y);
     }
 }
 
+void FFT::createPoints(std::vector<float>& x, std::vector<float>& y, const juce::Rectangle<float> bounds, float minFreq, float dBMin, float dBMax, int channel)
+{
+    juce::ScopedLock lockedForReading(pathCreationLock);
+    const auto& averager = getAverager(channel);
+    const float gain = getAverageGain(channel);
+
+    const int numBins = averager.getNumSamples();
+    x.resize((size_t)numBins);
+    y.resize((size_t)numBins);
+
+    const auto* fftData = averager.getReadPointer(0);
+    const auto factor = bounds.getWidth() / 10.0f;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        x[(size_t)i] = bounds.getX() + factor * indexToX(static_cast<float>(i), minFreq);
+        y[(size_t)i] = binToY(fftData[i] * gain, bounds, dBMin, dBMax);
+    }
+}
+
+void FFT::clearAveragers()
+{
+    for (auto& averager : averagers)
+        averager.clear();
+
+    std::fill(framesAveraged.begin(), framesAveraged.end(), 0);
+    averagerPtr = 1;
+}
+
+float FFT::getAverageGain(int channel) const noexcept
+{
+    // Each frame goes in at 1 / slots, so the sum is the mean only once every slot is filled
+    const int frames = framesAveraged[(size_t)getAveragerIndex(channel)];
+    return frames > 0 ? (float)(getAverager(channel).getNumChannels() - 1) / (float)frames : 1.0f;
+}
+
 float FFT::indexToX(float index, float minFreq) const
 {
     const auto freq = (sampleRate * index) / fft.getSize();
@@ -123,9 +249,11 @@ float FFT::binToY(float bin, const juce::Rectangle<float> bounds, float dBMin, f
     return juce::jmap(valDB, dBMin, dBMax, bounds.getBottom(), bounds.getY());
 }
 
-std::vector<std::pair<float, float>> FFT::getHarmonicsInDB(int maxHarmonics, float minDB) const
+std::vector<std::pair<float, float>> FFT::getHarmonicsInDB(int maxHarmonics, float minDB, int channel) const
 {
     juce::ScopedLock lock(pathCreationLock);
+    const auto& averager = getAverager(channel);
+    const float gain = getAverageGain(channel);
 
     std::vector<std::pair<float, float>> result;
 
@@ -157,8 +285,8 @@ std::vector<std::pair<float, float>> FFT::getHarmonicsInDB(int maxHarmonics, flo
         if (bin >= numBins) break;
 
         float freq = bin * binHz;
-        float gain = magnitudes[bin];
-        float dB = juce::Decibels::gainToDecibels(gain, minDB);
+        float magnitude = magnitudes[bin] * gain;
+        float dB = juce::Decibels::gainToDecibels(magnitude, minDB);
         result.push_back({ freq, dB });
     }
 
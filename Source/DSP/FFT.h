@@ -8,16 +8,42 @@ public:
 	FFT();
 	~FFT() override;
 
-    void addAudioData(const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels);
-    void setUpFrequencyAnalyzer(int audioFifoSize, float sampleRateToUse);
+    // Lanes whose bit in laneMask is clear (math channels that are off) are queued as
+    // silence and not analysed; an averager restarts when its lane comes back.
+    void addAudioData(const juce::AudioBuffer<float>& buffer, int startChannel, int numChannels, juce::uint32 laneMask = ~0u);
+    // Each channel gets its own FIFO lane and averager, so every input has its own spectrum
+    void setUpFrequencyAnalyzer(int audioFifoSize, float sampleRateToUse, bool startAnalysisThread = true, int numChannels = 1);
+    int getNumChannels() const noexcept { return (int)averagers.size(); }
+
+    // Analyses one frame from the FIFO if a full frame is queued. The analysis thread
+    // calls this in its loop; offline tools without the thread can call it directly.
+    bool processNextFrame();
+
+    // Cheap suspend flag. While inactive addAudioData() returns straight away and the
+    // analysis thread discards whatever is left in the FIFO; on reactivation the averager
+    // restarts, so the spectrum never mixes in audio from before the suspension. It is
+    // empty until the first frame is analysed; from then on it is the mean of the frames
+    // since the restart, so it is at full level at once and only gets smoother.
+    void setActive(bool shouldBeActive) noexcept { active.store(shouldBeActive, std::memory_order_relaxed); }
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
     bool checkForNewData();
-    void createPath(juce::Path& p, const juce::Rectangle<float> bounds, float minFreq, float dBMin, float dBMax);
-    std::vector<std::pair<float, float>> getHarmonicsInDB(int maxHarmonics = 5, float minDB = -80.0f) const;
+    bool isNewDataPending() const noexcept { return newDataAvailable.load(); }
+    juce::uint64 getDroppedSamples() const noexcept { return droppedSamples.load(); }
+    void createPath(juce::Path& p, const juce::Rectangle<float> bounds, float minFreq, float dBMin, float dBMax, int channel = 0);
+    // Same curve as createPath as plain point arrays, for the software trace rasteriser
+    void createPoints(std::vector<float>& x, std::vector<float>& y, const juce::Rectangle<float> bounds, float minFreq, float dBMin, float dBMax, int channel = 0);
+    std::vector<std::pair<float, float>> getHarmonicsInDB(int maxHarmonics = 5, float minDB = -80.0f, int channel = 0) const;
 
 private:
     void run() override;
     float indexToX(float index, float minFreq) const;
     float binToY(float bin, const juce::Rectangle<float> bounds, float dBMin, float dBMax) const;
+    int getAveragerIndex(int channel) const noexcept { return juce::jlimit(0, getNumChannels() - 1, channel); }
+    const juce::AudioBuffer<float>& getAverager(int channel) const { return averagers[(size_t)getAveragerIndex(channel)]; }
+    // Scales an averager's sum to the mean of the frames it holds so far
+    float getAverageGain(int channel) const noexcept;
+    void clearAveragers();
 
     juce::WaitableEvent waitForData;
     juce::CriticalSection pathCreationLock;
@@ -27,11 +53,17 @@ private:
     juce::dsp::FFT fft{ 12 };
     juce::dsp::WindowingFunction<float> windowing{ 1 << 12, juce::dsp::WindowingFunction<float>::hann, true };
     juce::AudioBuffer<float> fftBuffer{ 1, (1 << 12) * 2 };
-    juce::AudioBuffer<float> averager{ 9, (1 << 12) / 2 };
-    int averagerPtr = 1;
+    std::vector<juce::AudioBuffer<float>> averagers = std::vector<juce::AudioBuffer<float>>(1, juce::AudioBuffer<float>(9, (1 << 12) / 2));
+    int averagerPtr = 1;        // shared: every channel advances once per frame
+    std::vector<int> framesAveraged = std::vector<int>(1, 0);   // per averager, up to its slots
     juce::AbstractFifo abstractFifo{ 48000 };
     juce::AudioBuffer<float> audioFifo{ 1, 48000 };
     std::atomic<bool> newDataAvailable{ false };
+    std::atomic<juce::uint32> activeLanes{ ~0u };
+    juce::uint32 analysedLanes = ~0u;   // analysis thread only
+    std::atomic<bool> active{ true };
+    bool wasActive = true;      // analysis thread only
+    std::atomic<juce::uint64> droppedSamples{ 0 };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FFT)
 };
\ No newline at end of file
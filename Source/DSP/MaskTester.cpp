@@ -0,0 +1,289 @@
+#include "MaskTester.h"
+
+MaskTester::~MaskTester()
+{
+    stop();
+}
+
+juce::Result MaskTester::start(const juce::Path& newPolygon, const Geometry& newGeometry)
+{
+    if (newGeometry.windowSamples < 2 || newGeometry.valuePerDivision == 0.0f)
+        return juce::Result::fail("The time base is too short to test a mask");
+
+    auto newMask = std::make_unique<Mask>();
+    newMask->geometry = newGeometry;
+    newMask->trigger.setParameters(newGeometry.triggerLevel, 0.0f, false);
+
+    // Limits in divisions, from where every polygon edge crosses the column centres. A
+    // column the polygon does not reach keeps the infinite limits and always passes.
+    std::array<float, numColumns> top, bottom;
+    top.fill(std::numeric_limits<float>::lowest());
+    bottom.fill(std::numeric_limits<float>::max());
+
+    const float columnsPerDivision = numColumns / numHorizontalDivisions;
+
+    for (juce::PathFlatteningIterator edge(newPolygon); edge.next();)
+    {
+        const float x1 = edge.x1 * columnsPerDivision - 0.5f, x2 = edge.x2 * columnsPerDivision - 0.5f;
+        const int first = juce::jmax(0, (int)std::ceil(juce::jmin(x1, x2)));
+        const int last = juce::jmin(numColumns - 1, (int)std::floor(juce::jmax(x1, x2)));
+
+        for (int column = first; column <= last; ++column)
+        {
+            const float y = x1 == x2 ? juce::jmax(edge.y1, edge.y2) : edge.y1 + (edge.y2 - edge.y1) * (column - x1) / (x2 - x1);
+            const float yLow = x1 == x2 ? juce::jmin(edge.y1, edge.y2) : y;
+            top[(size_t)column] = juce::jmax(top[(size_t)column], y);
+            bottom[(size_t)column] = juce::jmin(bottom[(size_t)column], yLow);
+        }
+    }
+
+    int covered = 0;
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const bool limited = top[(size_t)column] >= bottom[(size_t)column];
+        const float a = (top[(size_t)column] - newGeometry.offsetDivisions) * newGeometry.valuePerDivision;
+        const float b = (bottom[(size_t)column] - newGeometry.offsetDivisions) * newGeometry.valuePerDivision;
+
+        // A negative scale turns the band upside down
+        newMask->upper[(size_t)column] = limited ? juce::jmax(a, b) : std::numeric_limits<float>::max();
+        newMask->lower[(size_t)column] = limited ? juce::jmin(a, b) : std::numeric_limits<float>::lowest();
+        covered += limited ? 1 : 0;
+    }
+
+    if (covered == 0)
+        return juce::Result::fail("The mask does not cover any part of the screen");
+
+    // Each column is at least one sample, so a window shorter than the columns still has
+    // every sample tested against the columns over it
+    for (int column = 0; column <= numColumns; ++column)
+        newMask->columnStarts[(size_t)column] = (int)((juce::int64)column * newGeometry.windowSamples / numColumns);
+
+    for (int column = 0; column < numColumns; ++column)
+        newMask->columnStarts[(size_t)column] = juce::jmin(newMask->columnStarts[(size_t)column], newGeometry.windowSamples - 1);
+
+    // Counts of the previous mask go before the new one tests anything
+    resetCounts();
+
+    {
+        const juce::SpinLock::ScopedLockType lock(maskLock);
+        std::swap(mask, newMask);
+    }
+
+    polygon = newPolygon;
+    geometry = newGeometry;
+    active = true;
+
+    // newMask now holds the previous mask and is freed here, off the audio thread
+    return juce::Result::ok();
+}
+
+void MaskTester::stop()
+{
+    std::unique_ptr<Mask> previous;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(maskLock);
+        std::swap(mask, previous);
+    }
+
+    active = false;
+}
+
+juce::Result MaskTester::setGeometry(const Geometry& newGeometry)
+{
+    if (!isActive() || newGeometry == geometry)
+        return juce::Result::ok();
+
+    const auto samePolygon = polygon;
+    const auto result = start(samePolygon, newGeometry);
+
+    if (result.failed())
+        stop();
+
+    return result;
+}
+
+void MaskTester::clearCounts() noexcept
+{
+    tested = 0;
+    passed = 0;
+    failed = 0;
+    violations = 0;
+    skipped = 0;
+
+    for (auto& count : columnFailures)
+        count.store(0, std::memory_order_relaxed);
+}
+
+juce::uint32 MaskTester::getColumnFailures(int column) const noexcept
+{
+    return resetRequested.load() ? 0 : columnFailures[(size_t)column].load(std::memory_order_relaxed);
+}
+
+MaskTester::Counts MaskTester::getCounts() const noexcept
+{
+    Counts counts;
+    if (resetRequested.load())
+        return counts;
+
+    counts.tested = tested.load();
+    counts.passed = passed.load();
+    counts.failed = failed.load();
+    counts.violations = violations.load();
+    counts.skipped = skipped.load();
+    return counts;
+}
+
+juce::Path MaskTester::polygonAroundReference(const ReferenceTraceStore::Record& record, float verticalTolerance, float horizontalTolerance)
+{
+    const float divisionsPerColumn = numHorizontalDivisions / numColumns;
+    const int spread = juce::jmax(0, juce::roundToInt(horizontalTolerance / divisionsPerColumn));
+
+    std::array<float, numColumns> top, bottom;
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const int first = juce::jmax(0, column - spread);
+        const int last = juce::jmin(numColumns - 1, column + spread);
+
+        top[(size_t)column] = juce::FloatVectorOperations::findMaximum(record.top + first, last - first + 1) + verticalTolerance;
+        bottom[(size_t)column] = juce::FloatVectorOperations::findMinimum(record.bottom + first, last - first + 1) - verticalTolerance;
+    }
+
+    // Along the top from left to right, back along the bottom, through the column centres
+    juce::Path band;
+    auto columnX = [divisionsPerColumn](int column) { return (column + 0.5f) * divisionsPerColumn; };
+
+    band.startNewSubPath(columnX(0), top[0]);
+    for (int column = 1; column < numColumns; ++column)
+        band.lineTo(columnX(column), top[(size_t)column]);
+
+    for (int column = numColumns; --column >= 0;)
+        band.lineTo(columnX(column), bottom[(size_t)column]);
+
+    band.closeSubPath();
+    return band;
+}
+
+void MaskTester::prepare() noexcept
+{
+    // The history restarts, and with it the sample indices of a pending acquisition
+    const juce::SpinLock::ScopedLockType lock(maskLock);
+
+    if (mask != nullptr)
+    {
+        mask->pendingTrigger = -1;
+        mask->nextSearch = 0;
+        mask->lastSample = 0.0f;
+    }
+}
+
+void MaskTester::process(const juce::AudioBuffer<float>& block, const CircularAudioBuffer& history) noexcept
+{
+    // Only this thread writes the counts, so only it clears them
+    if (resetRequested.exchange(false))
+        clearCounts();
+
+    // The message thread only holds the lock to swap masks; that block goes untested
+    const juce::SpinLock::ScopedTryLockType lock(maskLock);
+    if (!lock.isLocked() || mask == nullptr)
+        return;
+
+    auto& m = *mask;
+    const int numSamples = block.getNumSamples();
+    if (numSamples == 0 || m.geometry.triggerChannel >= block.getNumChannels() || m.geometry.channel >= history.getNumChannels())
+        return;
+
+    const float* data = block.getReadPointer(m.geometry.triggerChannel);
+    const juce::int64 written = history.getTotalSamplesWritten();
+    const juce::int64 blockStart = written - numSamples;
+
+    // Like SegmentedCapture: test each acquisition once its window is in the history and
+    // rearm after it, so several short acquisitions may complete inside one block
+    for (;;)
+    {
+        if (m.pendingTrigger >= 0)
+        {
+            const juce::int64 windowEnd = m.pendingTrigger + m.geometry.offsetSamples + m.geometry.windowSamples;
+            if (windowEnd > written)
+                break;
+
+            test(m, history);
+            m.nextSearch = juce::jmax(windowEnd, m.pendingTrigger + 1);
+            m.pendingTrigger = -1;
+            continue;
+        }
+
+        const auto searchFrom = juce::jmax<juce::int64>(0, m.nextSearch - blockStart);
+        if (searchFrom >= numSamples)
+            break;
+
+        const int hit = m.trigger.findNextTrigger(data, (int)searchFrom, numSamples, m.lastSample);
+        if (hit < 0)
+            break;
+
+        m.pendingTrigger = blockStart + hit;
+    }
+
+    m.lastSample = data[numSamples - 1];
+}
+
+void MaskTester::test(Mask& m, const CircularAudioBuffer& history) noexcept
+{
+    const auto& g = m.geometry;
+    HistorySpans spans;
+
+    // Read in place: the acquisition is at most two runs of the ring
+    if (!history.getSpans(g.channel, m.pendingTrigger + g.offsetSamples, g.windowSamples, spans))
+    {
+        ++skipped;
+        return;
+    }
+
+    int violatingColumns = 0;
+
+    for (int column = 0; column < numColumns; ++column)
+    {
+        const int first = m.columnStarts[(size_t)column];
+        const int end = first + juce::jmax(1, m.columnStarts[(size_t)column + 1] - first);
+
+        // The column's min/max over the runs it falls in
+        juce::Range<float> range;
+        bool found = false;
+        int spanStart = 0;
+
+        for (int p = 0; p < spans.count; ++p)
+        {
+            const auto& span = spans.parts[(size_t)p];
+            const int from = juce::jmax(first, spanStart);
+            const int to = juce::jmin(end, spanStart + span.size);
+
+            if (from < to)
+            {
+                const auto partRange = juce::FloatVectorOperations::findMinAndMax(span.data + (from - spanStart), to - from);
+                range = found ? range.getUnionWith(partRange) : partRange;
+                found = true;
+            }
+
+            spanStart += span.size;
+        }
+
+        if (range.getEnd() > m.upper[(size_t)column] || range.getStart() < m.lower[(size_t)column])
+        {
+            ++violatingColumns;
+            columnFailures[(size_t)column].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    ++tested;
+
+    if (violatingColumns == 0)
+    {
+        ++passed;
+        return;
+    }
+
+    ++failed;
+    violations += (juce::uint64)violatingColumns;
+}
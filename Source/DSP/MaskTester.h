@@ -0,0 +1,113 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CircularAudioBuffer.h"
+#include "ReferenceTraceStore.h"
+#include "Trigger.h"
+
+// Pass/fail mask testing for production runs. The mask is a polygon in screen divisions,
+// usually drawn around a golden reference, that every acquisition must stay inside. When
+// it is started the polygon is turned into one upper and one lower limit per reference
+// column, in signal units, so the audio thread checks each triggered acquisition in place
+// in the history by reducing every column to its min/max (FloatVectorOperations) and
+// comparing: no copy, no rendering, and every trigger is tested rather than only the ones
+// that happen to be painted. The polygon stays put on screen, so when the scale, time base,
+// offsets or trigger change the limits are rebuilt for the new geometry.
+class MaskTester
+{
+public:
+    static constexpr int numColumns = ReferenceTraceStore::numColumns;
+    static constexpr float numHorizontalDivisions = 10.0f;
+
+    // How the polygon maps onto the captured samples, taken from the time view when the
+    // test starts: acquisitions are windows of the tested channel starting offsetSamples
+    // after each rising crossing of triggerLevel on the trigger channel.
+    struct Geometry
+    {
+        int channel = 0;
+        int triggerChannel = 0;
+        float triggerLevel = 0.0f;              // signal domain
+        int windowSamples = 0;                  // the ten divisions across the screen
+        int offsetSamples = 0;                  // window start relative to the trigger
+        float valuePerDivision = 1.0f;          // signal = (divisions - offsetDivisions) * valuePerDivision
+        float offsetDivisions = 0.0f;
+
+        bool operator== (const Geometry& other) const noexcept
+        {
+            return channel == other.channel && triggerChannel == other.triggerChannel && triggerLevel == other.triggerLevel
+                && windowSamples == other.windowSamples && offsetSamples == other.offsetSamples
+                && valuePerDivision == other.valuePerDivision && offsetDivisions == other.offsetDivisions;
+        }
+
+        bool operator!= (const Geometry& other) const noexcept { return !operator== (other); }
+    };
+
+    struct Counts
+    {
+        juce::uint64 tested = 0;
+        juce::uint64 passed = 0;
+        juce::uint64 failed = 0;
+        juce::uint64 violations = 0;            // columns outside the mask, summed over the failures
+        juce::uint64 skipped = 0;               // triggers whose window the history no longer held
+    };
+
+    MaskTester() = default;
+    ~MaskTester();
+
+    // Message thread. The polygon is in divisions: x from 0 to 10 across the screen, y
+    // from the centre line, positive up. Columns it does not cover are not limited.
+    juce::Result start(const juce::Path& polygon, const Geometry& geometry);
+    void stop();
+
+    // Message thread. Rebuilds the limits of a running test when the geometry differs and
+    // restarts its counts; a geometry the mask cannot be tested with stops the test.
+    juce::Result setGeometry(const Geometry& geometry);
+
+    // Any thread. The audio thread clears the counts at its next block; until then they
+    // read as zero.
+    void resetCounts() noexcept { resetRequested = true; }
+
+    bool isActive() const noexcept { return active.load(); }
+    Counts getCounts() const noexcept;
+    const juce::Path& getPolygon() const noexcept { return polygon; }
+    const Geometry& getGeometry() const noexcept { return geometry; }
+    juce::uint32 getColumnFailures(int column) const noexcept;
+
+    // Band within verticalTolerance divisions of the reference, widened by horizontalTolerance
+    // divisions either side so that jitter of a fast edge does not fail
+    static juce::Path polygonAroundReference(const ReferenceTraceStore::Record& record, float verticalTolerance, float horizontalTolerance);
+
+    // Audio thread: call right after the block was pushed into history
+    void prepare() noexcept;
+    void process(const juce::AudioBuffer<float>& block, const CircularAudioBuffer& history) noexcept;
+
+private:
+    // Everything the audio thread touches, built on the message thread and swapped in
+    struct Mask
+    {
+        Geometry geometry;
+        std::array<int, numColumns + 1> columnStarts{};     // window sample of each column, plus the end
+        std::array<float, numColumns> upper{}, lower{};
+        Trigger trigger;
+
+        juce::int64 pendingTrigger = -1;
+        juce::int64 nextSearch = 0;                         // hold-off: the next trigger starts after the window
+        float lastSample = 0.0f;
+    };
+
+    void test(Mask& mask, const CircularAudioBuffer& history) noexcept;
+    void clearCounts() noexcept;
+
+    juce::SpinLock maskLock;
+    std::unique_ptr<Mask> mask;
+    std::atomic<bool> active{ false };
+    std::atomic<bool> resetRequested{ false };
+
+    juce::Path polygon;
+    Geometry geometry;
+
+    std::atomic<juce::uint64> tested{ 0 }, passed{ 0 }, failed{ 0 }, violations{ 0 }, skipped{ 0 };
+    std::array<std::atomic<juce::uint32>, numColumns> columnFailures{};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MaskTester)
+};
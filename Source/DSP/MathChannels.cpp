@@ -0,0 +1,329 @@
+#include "MathChannels.h"
+
+// Recursive descent parser that emits register code while it parses: every node gets the
+// next free register, so the program runs in emission order with no further passes.
+class MathChannels::Compiler
+{
+public:
+    explicit Compiler(const juce::String& source) : text(source.toLowerCase().removeCharacters(" \t\r\n")) {}
+
+    juce::Result compile(Program& program)
+    {
+        program = {};
+        code = &program.code;
+
+        const int result = parseExpression();
+
+        if (error.isEmpty() && position < text.length())
+            fail("unexpected '" + text.substring(position, position + 1) + "'");
+
+        if (error.isNotEmpty())
+        {
+            program = {};
+            return juce::Result::fail(error);
+        }
+
+        // A bare input ("a") still needs a register to hand out
+        program.result = result >= 0 ? result : emit(OpCode::add, result, constant(0.0f));
+        program.state.assign(program.code.size(), 0.0f);
+        program.enabled = error.isEmpty();
+
+        return error.isEmpty() ? juce::Result::ok() : juce::Result::fail(error);
+    }
+
+private:
+    // expression := term (('+' | '-') term)*
+    int parseExpression()
+    {
+        int left = parseTerm();
+
+        while (error.isEmpty() && (peek() == '+' || peek() == '-'))
+        {
+            const auto op = next() == '+' ? OpCode::add : OpCode::subtract;
+            left = emit(op, left, parseTerm());
+        }
+
+        return left;
+    }
+
+    // term := factor (('*' | '/') factor)*
+    int parseTerm()
+    {
+        int left = parseFactor();
+
+        while (error.isEmpty() && (peek() == '*' || peek() == '/'))
+        {
+            const auto op = next() == '*' ? OpCode::multiply : OpCode::divide;
+            left = emit(op, left, parseFactor());
+        }
+
+        return left;
+    }
+
+    // factor := '-' factor | number | input | function '(' expression ')' | '(' expression ')'
+    int parseFactor()
+    {
+        if (error.isNotEmpty())
+            return 0;
+
+        const auto c = peek();
+
+        if (c == '-')
+        {
+            next();
+            return emit(OpCode::negate, parseFactor(), 0);
+        }
+
+        if (c == '(')
+        {
+            next();
+            const int inner = parseExpression();
+            expect(')');
+            return inner;
+        }
+
+        if (juce::CharacterFunctions::isDigit(c) || c == '.')
+        {
+            const int start = position;
+            while (juce::CharacterFunctions::isDigit(peek()) || peek() == '.')
+                next();
+
+            return constant(text.substring(start, position).getFloatValue());
+        }
+
+        if (juce::CharacterFunctions::isLetter(c))
+        {
+            const int start = position;
+            while (juce::CharacterFunctions::isLetter(peek()))
+                next();
+
+            const auto name = text.substring(start, position);
+
+            if (name.length() == 1 && c >= 'a' && c < 'a' + ChannelSettings::maxInputChannels)
+                return -1 - (int)(c - 'a');
+
+            const std::pair<const char*, OpCode> functions[] = {
+                { "abs", OpCode::abs }, { "diff", OpCode::diff }, { "integ", OpCode::integ }
+            };
+
+            for (const auto& [function, op] : functions)
+            {
+                if (name == function)
+                {
+                    expect('(');
+                    const int argument = parseExpression();
+                    expect(')');
+                    return emit(op, argument, 0);
+                }
+            }
+
+            fail("unknown name '" + name + "'");
+            return 0;
+        }
+
+        fail(c == 0 ? juce::String("expression ends too early") : "unexpected '" + juce::String::charToString(c) + "'");
+        return 0;
+    }
+
+    int constant(float value)
+    {
+        const int dst = emit(OpCode::constant, 0, 0);
+        if (error.isEmpty())
+            code->back().value = value;
+        return dst;
+    }
+
+    int emit(OpCode op, int a, int b)
+    {
+        if (error.isNotEmpty())
+            return 0;
+
+        const int dst = (int)code->size();
+        if (dst >= maxRegisters - 1)
+        {
+            fail("expression too long");
+            return 0;
+        }
+
+        code->push_back({ op, dst, a, b, 0.0f });
+        return dst;
+    }
+
+    juce::juce_wchar peek() const { return position < text.length() ? text[position] : 0; }
+    juce::juce_wchar next() { return position < text.length() ? text[position++] : 0; }
+
+    void expect(juce::juce_wchar c)
+    {
+        if (error.isEmpty() && next() != c)
+            fail("expected '" + juce::String::charToString(c) + "'");
+    }
+
+    void fail(const juce::String& message)
+    {
+        if (error.isEmpty())
+            error = message;
+    }
+
+    juce::String text;
+    int position = 0;
+    std::vector<Instruction>* code = nullptr;
+    juce::String error;
+};
+
+MathChannels::MathChannels()
+{
+    prepare(sampleRate, 512);
+}
+
+void MathChannels::prepare(double newSampleRate, int maxBlockSize)
+{
+    sampleRate = newSampleRate;
+    registers.setSize(maxRegisters, juce::jmax(1, maxBlockSize), false, true, false);
+}
+
+juce::Result MathChannels::setExpression(int slotIndex, const juce::String& expression)
+{
+    if (!juce::isPositiveAndBelow(slotIndex, maxChannels))
+        return juce::Result::fail("no such math channel");
+
+    Program program;
+
+    if (expression.trim().isNotEmpty())
+    {
+        const auto result = Compiler(expression).compile(program);
+        if (result.failed())
+            return result;
+    }
+
+    auto& slot = slots[(size_t)slotIndex];
+
+    {
+        // The audio thread never reads the inactive copy; it only swaps under the lock
+        const juce::SpinLock::ScopedLockType lock(slot.lock);
+        slot.programs[1 - slot.active.load()] = std::move(program);
+        slot.swapPending = true;
+    }
+
+    slot.expression = expression.trim();
+    slot.enabled = slot.expression.isNotEmpty();
+    return juce::Result::ok();
+}
+
+juce::String MathChannels::getExpression(int slotIndex) const
+{
+    return juce::isPositiveAndBelow(slotIndex, maxChannels) ? slots[(size_t)slotIndex].expression : juce::String();
+}
+
+bool MathChannels::isEnabled(int slotIndex) const noexcept
+{
+    return juce::isPositiveAndBelow(slotIndex, maxChannels) && slots[(size_t)slotIndex].enabled.load();
+}
+
+juce::StringArray MathChannels::getPresets()
+{
+    return { "A+B", "A-B", "A*B", "abs(A)", "diff(A)", "integ(A)" };
+}
+
+juce::uint32 MathChannels::process(const float* const* inputs, int numInputs, float* const* outputs, int numSamples) noexcept
+{
+    juce::uint32 computed = 0;
+
+    for (int s = 0; s < maxChannels; ++s)
+    {
+        auto& slot = slots[(size_t)s];
+
+        {
+            // Skipped for this block if the message thread is writing the other copy
+            const juce::SpinLock::ScopedTryLockType lock(slot.lock);
+            if (lock.isLocked() && slot.swapPending)
+            {
+                slot.active.store(1 - slot.active.load());
+                slot.swapPending = false;
+            }
+        }
+
+        auto& program = slot.programs[slot.active.load()];
+
+        if (!program.enabled)
+            continue;
+
+        computed |= 1u << s;
+
+        const int chunk = registers.getNumSamples();
+        for (int start = 0; start < numSamples; start += chunk)
+        {
+            const float* chunkInputs[ChannelSettings::maxInputChannels];
+            for (int c = 0; c < juce::jmin(numInputs, ChannelSettings::maxInputChannels); ++c)
+                chunkInputs[c] = inputs[c] + start;
+
+            run(program, chunkInputs, numInputs, outputs[s] + start, juce::jmin(chunk, numSamples - start));
+        }
+    }
+
+    return computed;
+}
+
+void MathChannels::run(Program& program, const float* const* inputs, int numInputs, float* output, int numSamples) noexcept
+{
+    // Inputs beyond the connected channels read as silence
+    const float* silence = registers.getReadPointer(maxRegisters - 1);
+
+    auto source = [&](int operand) -> const float*
+    {
+        if (operand >= 0)
+            return registers.getReadPointer(operand);
+
+        const int input = -1 - operand;
+        return input < numInputs ? inputs[input] : silence;
+    };
+
+    // The last register is never allocated by the compiler; keep it zeroed for silence
+    juce::FloatVectorOperations::clear(registers.getWritePointer(maxRegisters - 1), numSamples);
+
+    const float msPerSample = (float)(1000.0 / sampleRate);
+    const float samplesPerMs = (float)(sampleRate / 1000.0);
+    const float leak = 1.0f - (float)(juce::MathConstants<double>::twoPi / sampleRate); // ~1 Hz
+
+    for (size_t i = 0; i < program.code.size(); ++i)
+    {
+        const auto& instruction = program.code[i];
+        float* dst = registers.getWritePointer(instruction.dst);
+        const float* a = source(instruction.a);
+        const float* b = source(instruction.b);
+        float& state = program.state[i];
+
+        switch (instruction.op)
+        {
+            case OpCode::constant:  juce::FloatVectorOperations::fill(dst, instruction.value, numSamples); break;
+            case OpCode::add:       juce::FloatVectorOperations::add(dst, a, b, numSamples); break;
+            case OpCode::subtract:  juce::FloatVectorOperations::subtract(dst, a, b, numSamples); break;
+            case OpCode::multiply:  juce::FloatVectorOperations::multiply(dst, a, b, numSamples); break;
+            case OpCode::negate:    juce::FloatVectorOperations::negate(dst, a, numSamples); break;
+            case OpCode::abs:       juce::FloatVectorOperations::abs(dst, a, numSamples); break;
+
+            case OpCode::divide:
+                // Division by zero gives zero rather than an inf that would break the display
+                for (int n = 0; n < numSamples; ++n)
+                    dst[n] = b[n] != 0.0f ? a[n] / b[n] : 0.0f;
+                break;
+
+            case OpCode::diff:
+                dst[0] = a[0] - state;
+                juce::FloatVectorOperations::subtract(dst + 1, a + 1, a, numSamples - 1);
+                juce::FloatVectorOperations::multiply(dst, samplesPerMs, numSamples);
+                state = a[numSamples - 1];
+                break;
+
+            case OpCode::integ:
+                // The only recursive operation, hence the only scalar loop
+                for (int n = 0; n < numSamples; ++n)
+                {
+                    state = state * leak + a[n] * msPerSample;
+                    dst[n] = state;
+                }
+                break;
+        }
+    }
+
+    juce::FloatVectorOperations::copy(output, registers.getReadPointer(program.result), numSamples);
+}
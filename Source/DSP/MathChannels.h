@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChannelSettings.h"
+
+// Computed channels derived from the inputs, evaluated on the audio thread and stored in
+// the capture history next to the real inputs, so the views, trigger, measurements and
+// FFT treat them like any other channel.
+//
+// Expressions use A..H for inputs 1..8, numbers, + - * /, unary minus, parentheses and
+// abs(x), diff(x) (d/dt in V/ms) and integ(x) (running integral in V*ms, leaky below
+// about 1 Hz so an input offset does not ramp off screen). An expression is compiled
+// once on the message thread into a short register program of whole-block vector
+// operations; nothing is interpreted per sample. Each slot double-buffers its program:
+// the message thread writes the inactive copy and the audio thread swaps it in at the
+// start of a block.
+class MathChannels
+{
+public:
+    static constexpr int maxChannels = ChannelSettings::maxMathChannels;
+
+    MathChannels();
+
+    // Scratch for the largest block processed in one pass; longer blocks are chunked
+    void prepare(double sampleRate, int maxBlockSize);
+
+    // Message thread. An empty expression turns the slot off.
+    juce::Result setExpression(int slot, const juce::String& expression);
+    juce::String getExpression(int slot) const;
+    bool isEnabled(int slot) const noexcept;
+
+    // Audio thread: writes numSamples of every enabled slot into outputs[slot] and returns
+    // those slots as a bit mask. The outputs of slots that are off are left untouched.
+    juce::uint32 process(const float* const* inputs, int numInputs, float* const* outputs, int numSamples) noexcept;
+
+    // Expressions offered in the channel menu
+    static juce::StringArray getPresets();
+
+private:
+    enum class OpCode { constant, add, subtract, multiply, divide, negate, abs, diff, integ };
+
+    // Operands >= 0 are registers, negative ones are inputs: -1 is A, -2 is B, ...
+    struct Instruction
+    {
+        OpCode op;
+        int dst = 0, a = 0, b = 0;
+        float value = 0.0f;
+    };
+
+    struct Program
+    {
+        std::vector<Instruction> code;
+        std::vector<float> state;   // per instruction: previous sample / integrator
+        int result = 0;
+        bool enabled = false;
+    };
+
+    struct Slot
+    {
+        Program programs[2];
+        std::atomic<int> active{ 0 };
+        bool swapPending = false;       // guarded by lock
+        juce::SpinLock lock;
+        std::atomic<bool> enabled{ false };
+        juce::String expression;        // message thread
+    };
+
+    class Compiler;
+
+    void run(Program& program, const float* const* inputs, int numInputs, float* output, int numSamples) noexcept;
+
+    static constexpr int maxRegisters = 32;
+
+    std::array<Slot, maxChannels> slots;
+    juce::AudioBuffer<float> registers;
+    double sampleRate = 48000.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MathChannels)
+};
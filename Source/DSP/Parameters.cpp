@@ -1,25 +1,72 @@
 #include "Parameters.h"
 
-template<typename T>
-static void castParameter(juce::AudioProcessorValueTreeState& apvts,
-	const juce::ParameterID& id, T& destination)
+static float getScaleInVolts(int rangeValue, int verticalScaleIndex)
 {
-	destination = dynamic_cast<T>(apvts.getParameter(id.getParamID()));
-	jassert(destination);
+	if (rangeValue >= 0 && rangeValue < verticalScaleByRange.size() &&
+		verticalScaleIndex >= 0 && verticalScaleIndex < 4)
+		return verticalScaleByRange[rangeValue][verticalScaleIndex].second;
+
+	return 1.0f; 
+}
+
+static float getScaleInSeconds(int horizontalScaleIndex)
+{
+	if (horizontalScaleIndex >= 0 && horizontalScaleIndex < horizontalScaleOptions.size())
+		return horizontalScaleOptions[horizontalScaleIndex].second;
+
+	return 0.01f; // default: 10 ms/div
 }
 
+float ParameterSnapshot::getVerticalScaleInVolts() const
+{
+	return getScaleInVolts(rangeValue, verticalScaleIndex);
+}
+
+float ParameterSnapshot::getHorizontalScaleInSeconds() const
+{
+	return getScaleInSeconds(horizontalScaleIndex);
+}
+
+// In RawParameter order
+static const juce::ParameterID* const rawParameterIDs[] = {
+	&horizontalPositionParamID, &horizontalScaleParamID, &verticalPositionParamID, &verticalScaleParamID,
+	&rangeParamID, &modeParamID, &plotModeParamID, &triggerLevelParamID, &movingAverageParamID, &bypassParamID
+};
+
 Parameters::Parameters(juce::AudioProcessorValueTreeState& apvts)
+	: state(apvts)
 {
-	castParameter(apvts, horizontalPositionParamID, horizontalPositionParam);
-	castParameter(apvts, horizontalScaleParamID, horizontalScaleParam);
-	castParameter(apvts, verticalPositionParamID, verticalPositionParam);
-	castParameter(apvts, verticalScaleParamID, verticalScaleParam);
-	castParameter(apvts, rangeParamID, rangeParam);
-	castParameter(apvts, modeParamID, modeParam);
-	castParameter(apvts, plotModeParamID, plotModeParam);
-	castParameter(apvts, triggerLevelParamID, triggerLevelParam);
-	castParameter(apvts, movingAverageParamID, movingAverageParam);
-	castParameter(apvts, bypassParamID, bypassParam);
+	static_assert(std::size(rawParameterIDs) == (size_t)RawParameter::count, "one ID per raw parameter");
+
+	for (size_t i = 0; i < raw.size(); ++i)
+	{
+		raw[i] = state.getRawParameterValue(rawParameterIDs[i]->getParamID());
+		jassert(raw[i] != nullptr);
+		state.addParameterListener(rawParameterIDs[i]->getParamID(), this);
+	}
+
+	publishIfChanged();
+}
+
+Parameters::~Parameters()
+{
+	for (const auto* id : rawParameterIDs)
+		state.removeParameterListener(id->getParamID(), this);
+
+	cancelPendingUpdate();
+}
+
+void Parameters::parameterChanged(const juce::String&, float)
+{
+	// Called on whichever thread set the parameter (the audio thread for host automation):
+	// the snapshot is published from the message thread
+	triggerAsyncUpdate();
+}
+
+void Parameters::handleAsyncUpdate()
+{
+	const juce::SpinLock::ScopedLockType lock(writerLock);
+	publishIfChanged();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterLayout()
@@ -107,38 +154,86 @@ juce::AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterL
 
 void Parameters::update() noexcept
 {
-	horizontalScaleIndex = horizontalScaleParam->getIndex();
-	horizontalPosition = horizontalPositionParam->get();
-	
-	verticalScaleIndex = verticalScaleParam->getIndex();
-	verticalPosition = verticalPositionParam->get();
+	// The message thread is publishing the same live values
+	const juce::SpinLock::ScopedTryLockType lock(writerLock);
+	if (lock.isLocked())
+		publishIfChanged();
+}
 
-	modeValue = modeParam->getIndex();
-	rangeValue = rangeParam->getIndex();
+void Parameters::publishIfChanged() noexcept
+{
+	ParameterSnapshot next;
+	next.horizontalPosition   = load(RawParameter::horizontalPosition);
+	next.horizontalScaleIndex = juce::roundToInt(load(RawParameter::horizontalScale));
+	next.verticalPosition     = load(RawParameter::verticalPosition);
+	next.verticalScaleIndex   = juce::roundToInt(load(RawParameter::verticalScale));
+	next.rangeValue           = juce::roundToInt(load(RawParameter::range));
+	next.modeValue            = juce::roundToInt(load(RawParameter::mode));
+	next.triggerLevel         = load(RawParameter::triggerLevel);
+	next.plotMode             = juce::roundToInt(load(RawParameter::plotMode));
+	next.movingAverage        = load(RawParameter::movingAverage) > 0.5f ? 1u : 0u;
+	next.bypass               = load(RawParameter::bypass) > 0.5f ? 1u : 0u;
+	next.generation           = current.generation;
+
+	if (std::memcmp(&next, &current, sizeof(ParameterSnapshot)) == 0 && sequence.load(std::memory_order_relaxed) != 0)
+		return;
+
+	++next.generation;
+	current = next;
+	publish(current);
+}
 
-	triggerLevel = triggerLevelParam->get();
+void Parameters::publish(const ParameterSnapshot& snapshot) noexcept
+{
+	std::array<juce::uint32, snapshotWords> words{};
+	std::memcpy(words.data(), &snapshot, sizeof(ParameterSnapshot));
+
+	// Odd sequence while writing; readers retry until they see the same even value twice
+	const auto seq = sequence.load(std::memory_order_relaxed);
+	sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (size_t i = 0; i < snapshotWords; ++i)
+		published[i].store(words[i], std::memory_order_relaxed);
 
-	plotMode = plotModeParam->getIndex();
+	sequence.store(seq + 2, std::memory_order_release);
+	generation.store(snapshot.generation, std::memory_order_release);
 }
 
-float Parameters::getTriggerLevel() const noexcept
+ParameterSnapshot Parameters::getSnapshot() const noexcept
 {
-	return triggerLevelParam != nullptr ? triggerLevelParam->get() : triggerLevel;
+	std::array<juce::uint32, snapshotWords> words{};
+
+	for (;;)
+	{
+		const auto before = sequence.load(std::memory_order_acquire);
+		if ((before & 1) != 0)
+			continue;
+
+		for (size_t i = 0; i < snapshotWords; ++i)
+			words[i] = published[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (sequence.load(std::memory_order_relaxed) == before)
+			break;
+	}
+
+	ParameterSnapshot snapshot;
+	std::memcpy(&snapshot, words.data(), sizeof(ParameterSnapshot));
+	return snapshot;
 }
 
-float Parameters::getVerticalScaleInVolts() const
+float Parameters::getTriggerLevel() const noexcept
 {
-	if (rangeValue >= 0 && rangeValue < verticalScaleByRange.size() &&
-		verticalScaleIndex >= 0 && verticalScaleIndex < 4)
-		return verticalScaleByRange[rangeValue][verticalScaleIndex].second;
-
-	return 1.0f; 
+	return load(RawParameter::triggerLevel);
 }
 
-float Parameters::getHorizontalScaleInSeconds() const
+int Parameters::getRangeIndex() const noexcept
 {
-	if (horizontalScaleIndex >= 0 && horizontalScaleIndex < horizontalScaleOptions.size())
-		return horizontalScaleOptions[horizontalScaleIndex].second;
+	return juce::jlimit(0, (int)rangeCompensationFactors.size() - 1, juce::roundToInt(load(RawParameter::range)));
+}
 
-	return 0.01f; // default: 10 ms/div
+float Parameters::getVerticalScaleInVolts() const noexcept
+{
+	return getScaleInVolts(getRangeIndex(), juce::roundToInt(load(RawParameter::verticalScale)));
 }
@@ -29,47 +29,84 @@ inline const std::vector<float> rangeCompensationFactors = {
 	0.01f, 0.1f, 1.0f, 10.0f
 };
 
+// Plain copy of every parameter value, taken once per block by the audio thread and by the
+// message thread when a parameter changes. generation increases whenever any value differs
+// from the previous snapshot.
+struct ParameterSnapshot
+{
+	float horizontalPosition   = 0.0f;
+	int   horizontalScaleIndex = 0;
+	float verticalPosition     = 0.0f;
+	int   verticalScaleIndex   = 0;
+	int   rangeValue           = 0;
+	int   modeValue            = 0;
+	float triggerLevel         = 0.0f;
+	int   plotMode             = 0;
+	juce::uint32 movingAverage = 0;
+	juce::uint32 bypass        = 1;
+	juce::uint32 generation    = 0;
+
+	float getVerticalScaleInVolts() const;
+	float getHorizontalScaleInSeconds() const;
+};
 
-class Parameters
+class Parameters : private juce::AudioProcessorValueTreeState::Listener,
+                   private juce::AsyncUpdater
 {
 public:
 	Parameters(juce::AudioProcessorValueTreeState& apvts);
+	~Parameters() override;
 
 	static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+	// Audio thread: reads the raw values through pointers resolved in the constructor (no
+	// string lookups) and publishes a new snapshot when anything changed. Changes are also
+	// published from the message thread, so the views follow them while the host is not
+	// processing; the audio thread skips its turn while the message thread publishes.
 	void update() noexcept;
 
-	// Parameters initial Values
-	float horizontalPosition = 0.0f;
-	int   horizontalScale    = 0;
-	float verticalPosition   = 0.0f;
-	int verticalScaleIndex   = 0;
-	int	  rangeValue	     = 0;
-	int   modeValue          = 0;
-
-	juce::AudioParameterFloat* triggerLevelParam;
-	float triggerLevel = 0.0f;
-	
-	int plotMode = 0;
-	juce::AudioParameterChoice* plotModeParam;
+	// Any thread: a consistent copy of the last published values (seqlock, never blocks the writer)
+	ParameterSnapshot getSnapshot() const noexcept;
+	juce::uint32 getGeneration() const noexcept { return generation.load(std::memory_order_acquire); }
 
-	juce::AudioParameterChoice* rangeParam;
-
-	juce::AudioParameterBool* movingAverageParam;
-	bool movingAverage = true;
+	// Any thread: live values straight from the parameter atomics
+	bool isBypassed() const noexcept { return load(RawParameter::bypass) > 0.5f; }
+	bool isFrequencyMode() const noexcept { return load(RawParameter::plotMode) > 0.5f; }
+	bool isDCMode() const noexcept { return juce::roundToInt(load(RawParameter::mode)) == 1; }
+	int getRangeIndex() const noexcept;
 
 	float getTriggerLevel() const noexcept;
-	float getVerticalScaleInVolts() const;
-	float getHorizontalScaleInSeconds() const;
-	int horizontalScaleIndex = 0;
+	float getVerticalScaleInVolts() const noexcept;
 
 private:
+	void parameterChanged(const juce::String& parameterID, float newValue) override;
+	void handleAsyncUpdate() override;
+
+	void publishIfChanged() noexcept;
+	void publish(const ParameterSnapshot& snapshot) noexcept;
+
+	enum class RawParameter
+	{
+		horizontalPosition, horizontalScale, verticalPosition, verticalScale, range, mode,
+		plotMode, triggerLevel, movingAverage, bypass, count
+	};
+
+	float load(RawParameter p) const noexcept { return raw[(size_t)p]->load(std::memory_order_relaxed); }
+
+	// Resolved once; the choice parameters hold their index, the bools 0 or 1
+	std::array<std::atomic<float>*, (size_t)RawParameter::count> raw{};
+
+	juce::AudioProcessorValueTreeState& state;
+
+	// Held by whichever thread publishes; the audio thread only ever tries it
+	juce::SpinLock writerLock;
+
+	// Last published values, compared against to detect changes (under writerLock)
+	ParameterSnapshot current;
 
-	// Parameters definition
-	juce::AudioParameterFloat*  horizontalPositionParam;
-	juce::AudioParameterChoice* horizontalScaleParam;
-	juce::AudioParameterFloat*  verticalPositionParam;
-	juce::AudioParameterChoice* verticalScaleParam;
-	juce::AudioParameterChoice* modeParam;
-	juce::AudioParameterBool* bypassParam;
+	// Seqlock-published copy, stored as words so readers never race on plain memory
+	static constexpr size_t snapshotWords = (sizeof(ParameterSnapshot) + 3) / 4;
+	std::array<std::atomic<juce::uint32>, snapshotWords> published{};
+	std::atomic<juce::uint32> sequence{ 0 };
+	std::atomic<juce::uint32> generation{ 0 };
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "PerformanceCounters.h"
+
+void PerformanceCounters::prepare(double newSampleRate, int /*maximumBlockSize*/)
+{
+    sampleRate = newSampleRate;
+    samplesSinceRoll = 0;
+    triggersAtRoll = triggers.load();
+    waveformsAtRoll = waveforms.load();
+    shownAtRoll = samplesShown.load();
+    blockUsMax.store(0.0f);
+}
+
+void PerformanceCounters::addProcessBlockTime(juce::int64 ticks, int numSamples) noexcept
+{
+    const float micros = static_cast<float>(ticks * ticksToMicroseconds);
+    const float deadlineMicros = static_cast<float>(numSamples * 1.0e6 / sampleRate);
+
+    // Exponential average over roughly the last hundred blocks
+    const float average = blockUsAverage.load(std::memory_order_relaxed);
+    blockUsAverage.store(average + 0.01f * (micros - average), std::memory_order_relaxed);
+    blockLoad.store(deadlineMicros > 0.0f ? blockUsAverage.load(std::memory_order_relaxed) / deadlineMicros : 0.0f,
+                    std::memory_order_relaxed);
+
+    if (micros > blockUsMax.load(std::memory_order_relaxed))
+        blockUsMax.store(micros, std::memory_order_relaxed);
+
+    rollRates(numSamples);
+}
+
+void PerformanceCounters::rollRates(int numSamples) noexcept
+{
+    samplesSinceRoll += (juce::uint64)numSamples;
+    if (samplesSinceRoll < (juce::uint64)sampleRate)
+        return;
+
+    const double seconds = samplesSinceRoll / sampleRate;
+    const auto triggersNow = triggers.load(std::memory_order_relaxed);
+    const auto waveformsNow = waveforms.load(std::memory_order_relaxed);
+    const auto shownNow = samplesShown.load(std::memory_order_relaxed);
+
+    triggersPerSecond.store(static_cast<float>((triggersNow - triggersAtRoll) / seconds), std::memory_order_relaxed);
+    waveformsPerSecond.store(static_cast<float>((waveformsNow - waveformsAtRoll) / seconds), std::memory_order_relaxed);
+
+    const double shownFraction = (double)(shownNow - shownAtRoll) / (double)samplesSinceRoll;
+    deadTimeFraction.store(static_cast<float>(juce::jlimit(0.0, 1.0, 1.0 - shownFraction)), std::memory_order_relaxed);
+
+    triggersAtRoll = triggersNow;
+    waveformsAtRoll = waveformsNow;
+    shownAtRoll = shownNow;
+    samplesSinceRoll = 0;
+}
+
+void PerformanceCounters::addWaveforms(int count, int samplesPerWaveform) noexcept
+{
+    waveforms.fetch_add((juce::uint64)count, std::memory_order_relaxed);
+    samplesShown.fetch_add((juce::uint64)count * (juce::uint64)juce::jmax(0, samplesPerWaveform), std::memory_order_relaxed);
+}
+
+void PerformanceCounters::addPaintTime(juce::int64 ticks) noexcept
+{
+    const juce::SpinLock::ScopedLockType lock(paintLock);
+    paintMs[(size_t)paintWritePos] = static_cast<float>(ticks * ticksToMicroseconds * 0.001);
+    paintWritePos = (paintWritePos + 1) % paintHistorySize;
+    paintCount = juce::jmin(paintCount + 1, paintHistorySize);
+}
+
+ScopeStats PerformanceCounters::getStats() const
+{
+    ScopeStats stats;
+    stats.triggersDetected = triggers.load();
+    stats.waveformsDrawn = waveforms.load();
+    stats.triggersPerSecond = triggersPerSecond.load();
+    stats.waveformsPerSecond = waveformsPerSecond.load();
+    stats.deadTimeFraction = deadTimeFraction.load();
+    stats.processBlockUsAverage = blockUsAverage.load();
+    stats.processBlockUsMax = blockUsMax.load();
+    stats.processBlockLoad = blockLoad.load();
+
+    std::array<float, paintHistorySize> sorted;
+    int count = 0;
+    {
+        const juce::SpinLock::ScopedLockType lock(paintLock);
+        count = paintCount;
+        std::copy(paintMs.begin(), paintMs.begin() + count, sorted.begin());
+    }
+
+    if (count > 0)
+    {
+        std::sort(sorted.begin(), sorted.begin() + count);
+        auto percentile = [&](float p) { return sorted[(size_t)juce::jmin(count - 1, static_cast<int>(p * count))]; };
+        stats.paintMsP50 = percentile(0.50f);
+        stats.paintMsP95 = percentile(0.95f);
+        stats.paintMsP99 = percentile(0.99f);
+        stats.paintMsMax = sorted[(size_t)count - 1];
+    }
+
+    return stats;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Timing summary of one processBlock stage over the profiler history
+struct StageTiming
+{
+    const char* name = "";
+    float p50Us = 0.0f;
+    float p99Us = 0.0f;
+    float maxUs = 0.0f;
+    float deadlineFraction = 0.0f;  // mean duration / block deadline
+};
+
+// Snapshot of the instrumentation counters, safe to copy around and display
+struct ScopeStats
+{
+    juce::uint64 triggersDetected = 0;
+    juce::uint64 waveformsDrawn = 0;
+    juce::uint64 fftDroppedSamples = 0;
+
+    float triggersPerSecond = 0.0f;
+    float waveformsPerSecond = 0.0f;
+    float deadTimeFraction = 0.0f;      // share of the input never shown in any waveform
+
+    float paintMsP50 = 0.0f;
+    float paintMsP95 = 0.0f;
+    float paintMsP99 = 0.0f;
+    float paintMsMax = 0.0f;
+
+    float processBlockUsAverage = 0.0f;
+    float processBlockUsMax = 0.0f;
+    float processBlockLoad = 0.0f;      // average duration / block deadline
+
+    // Per-stage breakdown, only filled while the block profiler is enabled
+    std::vector<StageTiming> stageTimings;
+    int blockOverruns = 0;
+
+    // Disk recorder, per channel
+    bool recording = false;
+    juce::uint64 recordedSamples = 0;
+    juce::uint64 recorderDroppedSamples = 0;
+    int recorderOverruns = 0;
+    juce::String recorderError;             // why the last recording stopped on its own, if it did
+
+    // Deep history, while it is on
+    float historySeconds = 0.0f;
+    juce::uint64 historyLostSamples = 0;
+
+    // Recording played back in place of the inputs, while one is loaded
+    bool playbackLoaded = false;
+    bool playbackPlaying = false;
+    float playbackSeconds = 0.0f;
+    float playbackLengthSeconds = 0.0f;
+    int playbackSpeed = 1;
+    int playbackPasses = 1;                 // the speed reached: blocks per host block, within the time budget
+};
+
+// Lock-free counters written from the audio thread (trigger count, processBlock timing)
+// and the message thread (waveforms drawn, paint timing). Rates are rolled once per
+// second of processed audio so they don't depend on who queries them.
+class PerformanceCounters
+{
+public:
+    PerformanceCounters() = default;
+
+    void prepare(double sampleRate, int maximumBlockSize);
+
+    // Audio thread
+    void addTriggers(int count) noexcept { triggers.fetch_add((juce::uint64)count, std::memory_order_relaxed); }
+    void addProcessBlockTime(juce::int64 ticks, int numSamples) noexcept;
+
+    // Message thread
+    void addWaveforms(int count, int samplesPerWaveform) noexcept;
+    void addPaintTime(juce::int64 ticks) noexcept;
+
+    ScopeStats getStats() const;
+
+private:
+    void rollRates(int numSamples) noexcept;
+
+    static constexpr int paintHistorySize = 256;
+
+    double sampleRate = 48000.0;
+    double ticksToMicroseconds = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+    std::atomic<juce::uint64> triggers{ 0 };
+    std::atomic<juce::uint64> waveforms{ 0 };
+    std::atomic<juce::uint64> samplesShown{ 0 };
+
+    // Audio thread only
+    juce::uint64 samplesSinceRoll = 0;
+    juce::uint64 triggersAtRoll = 0, waveformsAtRoll = 0, shownAtRoll = 0;
+
+    std::atomic<float> triggersPerSecond{ 0.0f };
+    std::atomic<float> waveformsPerSecond{ 0.0f };
+    std::atomic<float> deadTimeFraction{ 0.0f };
+
+    std::atomic<float> blockUsAverage{ 0.0f };
+    std::atomic<float> blockUsMax{ 0.0f };
+    std::atomic<float> blockLoad{ 0.0f };
+
+    mutable juce::SpinLock paintLock;
+    std::array<float, paintHistorySize> paintMs{};
+    int paintWritePos = 0;
+    int paintCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceCounters)
+};
+
+// Records the duration of the enclosing paint() call
+struct ScopedPaintTimer
+{
+    explicit ScopedPaintTimer(PerformanceCounters& c) : counters(c) {}
+    ~ScopedPaintTimer() { counters.addPaintTime(juce::Time::getHighResolutionTicks() - start); }
+
+    PerformanceCounters& counters;
+    const juce::int64 start = juce::Time::getHighResolutionTicks();
+};
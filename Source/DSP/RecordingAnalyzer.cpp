@@ -0,0 +1,113 @@
+#include "RecordingAnalyzer.h"
+#include "SignalAnalysis.h"
+
+RecordingAnalyzer::~RecordingAnalyzer()
+{
+    cancel();
+}
+
+juce::Result RecordingAnalyzer::start(const juce::File& file, const Settings& newSettings, std::function<void()> finished)
+{
+    cancel();
+
+    const auto result = recording.open(file);
+    if (result.failed())
+        return result;
+
+    if (!juce::isPositiveAndBelow(newSettings.channel, recording.getNumChannels()))
+        return juce::Result::fail(file.getFileName() + " has no channel " + juce::String(newSettings.channel + 1));
+
+    settings = newSettings;
+    segmentSamples = juce::jmax<juce::int64>(2, static_cast<juce::int64>(settings.segmentSeconds * recording.getSampleRate()));
+
+    const auto numSegments = (recording.getLengthInSamples() + segmentSamples - 1) / segmentSamples;
+    segments.assign((size_t)numSegments, Segment());
+
+    // Each worker measures its segments with its own scratch buffer and trigger
+    auto makeWorker = [this]() -> ChunkedJob::ChunkFunction
+    {
+        auto scratch = std::make_shared<juce::AudioBuffer<float>>(1, (int)segmentSamples);
+        auto trigger = std::make_shared<Trigger>();
+        trigger->setParameters(settings.triggerLevel, 0.0f, false);
+
+        return [this, scratch, trigger](int index) { measureSegment(index, *scratch, *trigger); };
+    };
+
+    job.start((int)numSegments, makeWorker, nullptr, std::move(finished));
+    return juce::Result::ok();
+}
+
+void RecordingAnalyzer::cancel()
+{
+    job.cancel();
+}
+
+void RecordingAnalyzer::measureSegment(int index, juce::AudioBuffer<float>& scratch, const Trigger& trigger) noexcept
+{
+    const juce::int64 start = (juce::int64)index * segmentSamples;
+    const int numSamples = static_cast<int>(juce::jmin(segmentSamples, recording.getLengthInSamples() - start));
+    float* data = scratch.getWritePointer(0);
+
+    // The sample before the segment decides whether its first sample is an edge
+    float previous = 0.0f;
+    recording.readChannel(settings.channel, start - 1, 1, &previous);
+    recording.readChannel(settings.channel, start, numSamples, data);
+
+    const juce::AudioBuffer<float> view(scratch.getArrayOfWritePointers(), 1, numSamples);
+    const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+    const float sampleRate = (float)recording.getSampleRate();
+    const int triggers = trigger.countTriggers(data, numSamples, previous);
+
+    auto& segment = segments[(size_t)index];
+    segment.startSeconds = start / recording.getSampleRate();
+    segment.numSamples = numSamples;
+    segment.min = range.getStart();
+    segment.max = range.getEnd();
+    segment.vpp = SignalAnalysis::computeVpp(range.getStart(), range.getEnd(), 1.0f, 1.0f) * settings.calibrationFactor;
+    segment.rms = SignalAnalysis::computeRMS(view, settings.calibrationFactor);
+    segment.frequency = SignalAnalysis::computeFrequency(view, sampleRate);
+    segment.triggers = triggers;
+    segment.triggerRate = triggers * sampleRate / numSamples;
+    segment.thd = SignalAnalysis::computeTHD(view, sampleRate, 11);
+}
+
+RecordingAnalyzer::Summary RecordingAnalyzer::getSummary() const
+{
+    Summary summary;
+    summary.durationSeconds = recording.getLengthInSeconds();
+    summary.wallSeconds = job.getWallSeconds();
+    summary.numSegments = (int)segments.size();
+
+    double sumSquares = 0.0;
+    juce::int64 numSamples = 0;
+
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        const auto& segment = segments[i];
+        summary.min = i == 0 ? segment.min : juce::jmin(summary.min, segment.min);
+        summary.max = i == 0 ? segment.max : juce::jmax(summary.max, segment.max);
+        summary.triggers += segment.triggers;
+        sumSquares += (double)segment.rms * segment.rms * segment.numSamples;
+        numSamples += segment.numSamples;
+    }
+
+    summary.rms = numSamples > 0 ? (float)std::sqrt(sumSquares / (double)numSamples) : 0.0f;
+    return summary;
+}
+
+bool RecordingAnalyzer::writeCsv(const juce::File& file) const
+{
+    juce::String csv("start_s,samples,min,max,vpp,rms,frequency_hz,trigger_rate_hz,thd_percent\n");
+
+    for (const auto& segment : segments)
+        csv << segment.startSeconds << "," << segment.numSamples << "," << segment.min << "," << segment.max << ","
+            << segment.vpp << "," << segment.rms << "," << segment.frequency << "," << segment.triggerRate << ","
+            << segment.thd * 100.0f << "\n";
+
+    return file.replaceWithText(csv);
+}
+
+juce::File RecordingAnalyzer::getDefaultReportFile(const juce::File& recording)
+{
+    return recording.getSiblingFile(recording.getFileNameWithoutExtension() + "-analysis.csv");
+}
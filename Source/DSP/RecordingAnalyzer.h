@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChunkedJob.h"
+#include "RecordingFile.h"
+#include "Trigger.h"
+
+// Offline measurement of a whole recording, far faster than real time. The file is cut
+// into fixed-length segments that one worker per core measures straight from the mapped
+// file, using the trigger and SignalAnalysis code the time view uses: per segment the
+// min/max, peak-to-peak, RMS, frequency, trigger rate and THD of one channel. An hour at
+// 48 kHz is a few hundred MB of page cache and takes seconds, not an hour of playback.
+class RecordingAnalyzer
+{
+public:
+    struct Settings
+    {
+        int channel = 0;
+        double segmentSeconds = 1.0;
+        float triggerLevel = 0.0f;          // signal domain, as the trigger uses it
+        float calibrationFactor = 1.0f;     // applied to Vpp and RMS, as in the time view
+    };
+
+    struct Segment
+    {
+        double startSeconds = 0.0;
+        int numSamples = 0;
+        float min = 0.0f, max = 0.0f;
+        float vpp = 0.0f;
+        float rms = 0.0f;
+        float frequency = -1.0f;            // SignalAnalysis::computeFrequency, -1 if no period
+        int triggers = 0;                   // rising crossings of the trigger level
+        float triggerRate = 0.0f;           // the same per second
+        float thd = 0.0f;                   // ratio
+    };
+
+    struct Summary
+    {
+        double durationSeconds = 0.0;
+        double wallSeconds = 0.0;
+        int numSegments = 0;
+        float min = 0.0f, max = 0.0f;
+        float rms = 0.0f;
+        juce::int64 triggers = 0;
+    };
+
+    RecordingAnalyzer() = default;
+    ~RecordingAnalyzer();
+
+    // Message thread. Analyses file in the background; onFinished is posted to the message
+    // thread when every segment is measured (not after cancel()).
+    juce::Result start(const juce::File& file, const Settings& settings, std::function<void()> onFinished);
+    void cancel();
+
+    bool isRunning() const noexcept { return job.isRunning(); }
+    float getProgress() const noexcept { return job.getProgress(); }
+
+    // Valid once finished
+    const std::vector<Segment>& getSegments() const noexcept { return segments; }
+    Summary getSummary() const;
+    const juce::File& getFile() const noexcept { return recording.getFile(); }
+
+    // One row per segment
+    bool writeCsv(const juce::File& file) const;
+    static juce::File getDefaultReportFile(const juce::File& recording);
+
+private:
+    void measureSegment(int index, juce::AudioBuffer<float>& scratch, const Trigger& trigger) noexcept;
+
+    RecordingFile recording;
+    Settings settings;
+    juce::int64 segmentSamples = 0;
+    std::vector<Segment> segments;
+
+    ChunkedJob job{ "Recording-Analysis" };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordingAnalyzer)
+};
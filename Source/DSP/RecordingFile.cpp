@@ -0,0 +1,229 @@
+#include "RecordingFile.h"
+
+namespace
+{
+    constexpr int wavFormatPcm = 1;
+    constexpr int wavFormatFloat = 3;
+    constexpr int wavFormatExtensible = 0xfffe;
+    constexpr int pageBytes = 4096;
+
+    bool readTag(juce::InputStream& in, const char* expected)
+    {
+        char tag[4] = {};
+        return in.read(tag, 4) == 4 && std::memcmp(tag, expected, 4) == 0;
+    }
+}
+
+juce::Result RecordingFile::open(const juce::File& source)
+{
+    close();
+
+    if (!source.existsAsFile())
+        return juce::Result::fail("File not found: " + source.getFullPathName());
+
+    const auto parsed = source.hasFileExtension(".f32") ? parseRawName(source) : parseWav(source);
+    if (parsed.failed())
+        return parsed;
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(source, juce::MemoryMappedFile::readOnly);
+    const auto mappedBytes = (juce::int64)mapping->getSize();
+
+    if (mapping->getData() == nullptr || mappedBytes < dataOffset)
+        return juce::Result::fail("Cannot map " + source.getFileName());
+
+    // A recording cut short (crash, full disk) may claim more data than the file holds:
+    // everything up to the last complete frame is still readable
+    lengthInSamples = juce::jmin(lengthInSamples, (mappedBytes - dataOffset) / bytesPerFrame);
+
+    mappedFile = std::move(mapping);
+    frames = static_cast<const char*>(mappedFile->getData()) + dataOffset;
+    file = source;
+    return juce::Result::ok();
+}
+
+void RecordingFile::close()
+{
+    mappedFile.reset();
+    frames = nullptr;
+    file = juce::File();
+    numChannels = 0;
+    sampleRate = 0.0;
+    dataOffset = 0;
+    lengthInSamples = 0;
+}
+
+juce::Result RecordingFile::parseWav(const juce::File& source)
+{
+    juce::FileInputStream in(source);
+    if (!in.openedOk())
+        return juce::Result::fail("Cannot open " + source.getFileName());
+
+    char riff[4] = {};
+    in.read(riff, 4);
+    const bool rf64 = std::memcmp(riff, "RF64", 4) == 0;
+
+    if (!(rf64 || std::memcmp(riff, "RIFF", 4) == 0))
+        return juce::Result::fail(source.getFileName() + " is not a WAV file");
+
+    in.readInt();
+    if (!readTag(in, "WAVE"))
+        return juce::Result::fail(source.getFileName() + " is not a WAV file");
+
+    int formatTag = 0, bitsPerSample = 0;
+    juce::int64 dataSize = -1, ds64DataSize = -1;
+    const juce::int64 fileSize = in.getTotalLength();
+
+    while (in.getPosition() + 8 <= fileSize)
+    {
+        char tag[4] = {};
+        in.read(tag, 4);
+        const juce::int64 chunkSize = (juce::uint32)in.readInt();
+        const juce::int64 chunkStart = in.getPosition();
+
+        if (std::memcmp(tag, "ds64", 4) == 0)
+        {
+            in.readInt64();
+            ds64DataSize = in.readInt64();
+        }
+        else if (std::memcmp(tag, "fmt ", 4) == 0)
+        {
+            formatTag = (juce::uint16)in.readShort();
+            numChannels = (juce::uint16)in.readShort();
+            sampleRate = (double)(juce::uint32)in.readInt();
+            in.readInt();
+            bytesPerFrame = (juce::uint16)in.readShort();
+            bitsPerSample = (juce::uint16)in.readShort();
+
+            // The sub-format GUID starts with the plain format tag
+            if (formatTag == wavFormatExtensible && chunkSize >= 40)
+            {
+                in.skipNextBytes(8);
+                formatTag = (juce::uint16)in.readShort();
+            }
+        }
+        else if (std::memcmp(tag, "data", 4) == 0)
+        {
+            dataOffset = chunkStart;
+            dataSize = rf64 && ds64DataSize >= 0 ? ds64DataSize : chunkSize;
+
+            // A header never finalised (the writer was killed) claims no data: take the rest of the file
+            if (dataSize == 0 || dataSize == 0xffffffff)
+                dataSize = fileSize - dataOffset;
+            break;
+        }
+
+        in.setPosition(chunkStart + chunkSize + (chunkSize & 1));
+    }
+
+    if (dataSize < 0 || numChannels <= 0 || sampleRate <= 0.0)
+        return juce::Result::fail(source.getFileName() + " has no audio data");
+
+    if (formatTag == wavFormatFloat && bitsPerSample == 32)
+        encoding = Encoding::float32;
+    else if (formatTag == wavFormatPcm && bitsPerSample == 16)
+        encoding = Encoding::int16;
+    else if (formatTag == wavFormatPcm && bitsPerSample == 24)
+        encoding = Encoding::int24;
+    else if (formatTag == wavFormatPcm && bitsPerSample == 32)
+        encoding = Encoding::int32;
+    else
+        return juce::Result::fail(source.getFileName() + ": unsupported sample format");
+
+    bytesPerSample = bitsPerSample / 8;
+
+    if (bytesPerFrame != bytesPerSample * numChannels)
+        return juce::Result::fail(source.getFileName() + ": unsupported frame layout");
+
+    lengthInSamples = dataSize / bytesPerFrame;
+    return juce::Result::ok();
+}
+
+juce::Result RecordingFile::parseRawName(const juce::File& source)
+{
+    // "<name>-<rate>Hz-<n>ch.f32", as CaptureRecorder names raw captures
+    juce::StringArray tokens;
+    tokens.addTokens(source.getFileNameWithoutExtension(), "-", "");
+
+    if (tokens.size() < 2 || !tokens[tokens.size() - 2].endsWith("Hz") || !tokens[tokens.size() - 1].endsWith("ch"))
+        return juce::Result::fail(source.getFileName() + ": the name does not give the rate and channels (<name>-48000Hz-2ch.f32)");
+
+    sampleRate = tokens[tokens.size() - 2].dropLastCharacters(2).getDoubleValue();
+    numChannels = tokens[tokens.size() - 1].dropLastCharacters(2).getIntValue();
+
+    if (sampleRate <= 0.0 || numChannels <= 0)
+        return juce::Result::fail(source.getFileName() + ": invalid rate or channel count in the name");
+
+    encoding = Encoding::float32;
+    bytesPerSample = (int)sizeof(float);
+    bytesPerFrame = bytesPerSample * numChannels;
+    dataOffset = 0;
+    lengthInSamples = source.getSize() / bytesPerFrame;
+    return juce::Result::ok();
+}
+
+bool RecordingFile::readChannel(int channel, juce::int64 start, int numSamples, float* dest) const noexcept
+{
+    if (!isOpen() || !juce::isPositiveAndBelow(channel, numChannels) || numSamples <= 0)
+        return false;
+
+    const juce::int64 first = juce::jlimit<juce::int64>(0, lengthInSamples, start);
+    const juce::int64 last = juce::jlimit<juce::int64>(0, lengthInSamples, start + numSamples);
+    const int lead = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, first - start));
+    const int count = static_cast<int>(juce::jmax<juce::int64>(0, last - first));
+
+    juce::FloatVectorOperations::clear(dest, lead);
+    juce::FloatVectorOperations::clear(dest + lead + count, numSamples - lead - count);
+
+    if (count == 0)
+        return false;
+
+    const char* src = frames + first * bytesPerFrame + channel * bytesPerSample;
+    float* out = dest + lead;
+
+    switch (encoding)
+    {
+        case Encoding::float32:
+            if (numChannels == 1)
+            {
+                std::memcpy(out, src, (size_t)count * sizeof(float));
+                break;
+            }
+
+            for (int i = 0; i < count; ++i, src += bytesPerFrame)
+                std::memcpy(out + i, src, sizeof(float));
+            break;
+
+        case Encoding::int16:
+            for (int i = 0; i < count; ++i, src += bytesPerFrame)
+                out[i] = (float)(juce::int16)juce::ByteOrder::littleEndianShort(src) * (1.0f / 32768.0f);
+            break;
+
+        case Encoding::int24:
+            for (int i = 0; i < count; ++i, src += bytesPerFrame)
+                out[i] = (float)juce::ByteOrder::littleEndian24Bit(src) * (1.0f / 8388608.0f);
+            break;
+
+        case Encoding::int32:
+            for (int i = 0; i < count; ++i, src += bytesPerFrame)
+                out[i] = (float)((double)(juce::int32)juce::ByteOrder::littleEndianInt(src) * (1.0 / 2147483648.0));
+            break;
+    }
+
+    return true;
+}
+
+void RecordingFile::prefetch(juce::int64 start, juce::int64 numSamples) const noexcept
+{
+    if (!isOpen())
+        return;
+
+    const juce::int64 first = juce::jlimit<juce::int64>(0, lengthInSamples, start) * bytesPerFrame;
+    const juce::int64 last = juce::jlimit<juce::int64>(0, lengthInSamples, start + numSamples) * bytesPerFrame;
+
+    // One read per page is enough to fault it in
+    char sum = 0;
+    for (juce::int64 offset = first; offset < last; offset += pageBytes)
+        sum = (char)(sum + *(static_cast<const volatile char*>(frames + offset)));
+
+    juce::ignoreUnused(sum);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// A recorded capture opened for analysis. The whole file is memory-mapped, so reading an
+// hour of it costs page cache rather than heap and any number of threads can read it at
+// once. WAV files (16/24/32-bit PCM or 32-bit float, RIFF or RF64) are read in place; raw
+// captures are the interleaved float32 files written by CaptureRecorder, whose sample rate
+// and channel count come from their "-<rate>Hz-<n>ch.f32" name.
+class RecordingFile
+{
+public:
+    RecordingFile() = default;
+
+    juce::Result open(const juce::File& file);
+    void close();
+
+    bool isOpen() const noexcept { return mappedFile != nullptr; }
+    const juce::File& getFile() const noexcept { return file; }
+    double getSampleRate() const noexcept { return sampleRate; }
+    int getNumChannels() const noexcept { return numChannels; }
+    juce::int64 getLengthInSamples() const noexcept { return lengthInSamples; }
+    double getLengthInSeconds() const noexcept { return sampleRate > 0.0 ? lengthInSamples / sampleRate : 0.0; }
+
+    // Any thread. Converts [start, start + numSamples) of one channel into dest; samples
+    // outside the file are silence. Returns false if none of the range is in the file.
+    bool readChannel(int channel, juce::int64 start, int numSamples, float* dest) const noexcept;
+
+    // Faults in the pages holding a range ahead of time, so a later read does not wait on disk
+    void prefetch(juce::int64 start, juce::int64 numSamples) const noexcept;
+
+    static constexpr const char* fileWildcard = "*.wav;*.f32";
+
+private:
+    enum class Encoding { int16, int24, int32, float32 };
+
+    juce::Result parseWav(const juce::File& source);
+    juce::Result parseRawName(const juce::File& source);
+
+    juce::File file;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const char* frames = nullptr;       // first byte of the first frame, inside the mapping
+    Encoding encoding = Encoding::float32;
+    int bytesPerSample = 4;
+    int bytesPerFrame = 4;
+    int numChannels = 0;
+    double sampleRate = 0.0;
+    juce::int64 dataOffset = 0;
+    juce::int64 lengthInSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordingFile)
+};
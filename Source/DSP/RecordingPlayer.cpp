@@ -0,0 +1,157 @@
+#include "RecordingPlayer.h"
+
+RecordingPlayer::RecordingPlayer()
+    : juce::Thread("Recording-ReadAhead")
+{
+}
+
+RecordingPlayer::~RecordingPlayer()
+{
+    close();
+}
+
+juce::Result RecordingPlayer::open(const juce::File& file, double processorSampleRate)
+{
+    auto next = std::make_unique<RecordingFile>();
+    const auto result = next->open(file);
+
+    if (result.failed())
+        return result;
+
+    if (std::abs(next->getSampleRate() - processorSampleRate) > 0.5)
+        return juce::Result::fail(file.getFileName() + " was recorded at " + juce::String(next->getSampleRate(), 0)
+                                  + " Hz; the scope runs at " + juce::String(processorSampleRate, 0) + " Hz");
+
+    close();
+
+    lengthInSeconds = next->getLengthInSeconds();
+    position = 0;
+    pendingSeek = -1;
+    residentStart = residentEnd = 0;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(fileLock);
+        recording = std::move(next);
+    }
+
+    loaded = true;
+    startThread(juce::Thread::Priority::low);
+    return juce::Result::ok();
+}
+
+void RecordingPlayer::close()
+{
+    playing = false;
+    loaded = false;
+
+    // The read-ahead thread uses the file without the lock, so it stops first
+    stopThread(1000);
+
+    std::unique_ptr<RecordingFile> old;
+    {
+        const juce::SpinLock::ScopedLockType lock(fileLock);
+        std::swap(old, recording);
+    }
+
+    lengthInSeconds = 0.0;
+}
+
+juce::File RecordingPlayer::getFile() const
+{
+    return recording != nullptr ? recording->getFile() : juce::File();
+}
+
+double RecordingPlayer::getPositionInSeconds() const noexcept
+{
+    return recording != nullptr ? position.load() / recording->getSampleRate() : 0.0;
+}
+
+void RecordingPlayer::setPosition(juce::int64 sample) noexcept
+{
+    sample = juce::jmax<juce::int64>(0, sample);
+
+    {
+        const juce::SpinLock::ScopedLockType lock(residentLock);
+        residentStart = residentEnd = 0;
+        ++seekCount;
+    }
+
+    position = sample;
+    pendingSeek = sample;
+    notify();
+}
+
+bool RecordingPlayer::render(juce::AudioBuffer<float>& buffer, int numChannels, bool onlyIfResident) noexcept
+{
+    if (!playing.load())
+        return false;
+
+    const juce::SpinLock::ScopedTryLockType lock(fileLock);
+    if (!lock.isLocked() || recording == nullptr)
+        return false;
+
+    juce::int64 start = pendingSeek.exchange(-1);
+    if (start < 0)
+        start = position.load();
+
+    if (start >= recording->getLengthInSamples())
+    {
+        position = recording->getLengthInSamples();
+        playing = false;
+        return false;
+    }
+
+    const int numSamples = buffer.getNumSamples();
+    numChannels = juce::jmin(numChannels, buffer.getNumChannels());
+
+    if (onlyIfResident)
+    {
+        const juce::SpinLock::ScopedTryLockType residentTry(residentLock);
+        if (!residentTry.isLocked() || start < residentStart || start + numSamples > residentEnd)
+            return false;
+    }
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        if (!recording->readChannel(c, start, numSamples, buffer.getWritePointer(c)))
+            buffer.clear(c, 0, numSamples);
+    }
+
+    position = start + numSamples;
+    return true;
+}
+
+void RecordingPlayer::run()
+{
+    juce::int64 fetchedUpTo = -1;
+
+    while (!threadShouldExit())
+    {
+        juce::uint32 seeks;
+        {
+            const juce::SpinLock::ScopedLockType lock(residentLock);
+            seeks = seekCount;
+        }
+
+        // Keep the next half second (at the current speed) resident; a seek restarts the window
+        const juce::int64 from = position.load();
+        const juce::int64 ahead = static_cast<juce::int64>(readAheadSeconds * speed.load() * recording->getSampleRate());
+
+        if (fetchedUpTo < from || fetchedUpTo > from + ahead)
+            fetchedUpTo = from;
+
+        recording->prefetch(fetchedUpTo, from + ahead - fetchedUpTo);
+        fetchedUpTo = from + ahead;
+
+        {
+            const juce::SpinLock::ScopedLockType lock(residentLock);
+            if (seekCount == seeks)
+            {
+                residentStart = from;
+                residentEnd = fetchedUpTo;
+            }
+        }
+
+        wait(readAheadIntervalMs);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "RecordingFile.h"
+
+// Plays a recorded capture into the processor in place of the live inputs, so it goes
+// through exactly the trigger, measurement, FFT and rendering path live input takes. At a
+// speed above 1x the processor captures up to that many blocks of the recording per host
+// block, which scans the file faster than real time with every view following along.
+//
+// The audio thread reads the mapped file directly; a read-ahead thread faults in the pages
+// it is about to reach and publishes how far it got. The blocks beyond the first in a host
+// block are only read from there, so a fast scan waits for the disk instead of faulting on
+// the audio thread. Opening and closing swap the file under a spin lock that the audio
+// thread only ever try-locks.
+class RecordingPlayer : private juce::Thread
+{
+public:
+    static constexpr int maxSpeed = 64;
+
+    RecordingPlayer();
+    ~RecordingPlayer() override;
+
+    // Message thread. The recording must be at the rate the processor runs at: the
+    // time base and the analyser both assume it.
+    juce::Result open(const juce::File& file, double processorSampleRate);
+    void close();
+
+    bool isLoaded() const noexcept { return loaded.load(); }
+    juce::File getFile() const;
+    double getSampleRate() const noexcept { return recording != nullptr ? recording->getSampleRate() : 0.0; }
+    double getLengthInSeconds() const noexcept { return lengthInSeconds.load(); }
+    double getPositionInSeconds() const noexcept;
+
+    void setPlaying(bool shouldPlay) noexcept { playing = shouldPlay && isLoaded(); }
+    bool isPlaying() const noexcept { return playing.load(); }
+
+    // Recording blocks captured per host block, 1 to maxSpeed
+    void setSpeed(int blocksPerBlock) noexcept { speed = juce::jlimit(1, maxSpeed, blocksPerBlock); }
+    int getSpeed() const noexcept { return speed.load(); }
+
+    // Message thread; the audio thread picks the new position up with its next block
+    void setPosition(juce::int64 sample) noexcept;
+    juce::int64 getPosition() const noexcept { return position.load(); }
+
+    // Audio thread: replaces the first numChannels channels of buffer with the next block
+    // of the recording (channels the file lacks are silent). Returns false, leaving the
+    // buffer alone, when not playing; playback stops at the end of the file. With
+    // onlyIfResident it also returns false when read-ahead has not faulted the block in.
+    bool render(juce::AudioBuffer<float>& buffer, int numChannels, bool onlyIfResident) noexcept;
+
+private:
+    void run() override;
+
+    static constexpr int readAheadIntervalMs = 20;
+    static constexpr double readAheadSeconds = 0.5;
+
+    juce::SpinLock fileLock;
+    std::unique_ptr<RecordingFile> recording;   // swapped under fileLock
+    std::atomic<bool> loaded{ false };
+    std::atomic<double> lengthInSeconds{ 0.0 };
+
+    std::atomic<bool> playing{ false };
+    std::atomic<int> speed{ 1 };
+    std::atomic<juce::int64> position{ 0 };
+    std::atomic<juce::int64> pendingSeek{ -1 };
+
+    // The range read-ahead last faulted in. A seek empties it, and the read-ahead pass that
+    // was running across the seek does not publish its stale range (seekCount).
+    juce::SpinLock residentLock;
+    juce::int64 residentStart = 0, residentEnd = 0;
+    juce::uint32 seekCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordingPlayer)
+};
@@ -0,0 +1,198 @@
+#include "ReferenceTraceStore.h"
+
+static const char storeMagic[8] = { 'A', 'U', 'R', 'A', 'R', 'E', 'F', 'S' };
+
+// Files held by the live stores of this process, so two plugin instances never map the
+// same one (message thread only, like the stores)
+static juce::Array<juce::File>& getOpenFiles()
+{
+    static juce::Array<juce::File> files;
+    return files;
+}
+
+ReferenceTraceStore::ReferenceTraceStore()
+{
+}
+
+ReferenceTraceStore::~ReferenceTraceStore()
+{
+    close();
+}
+
+void ReferenceTraceStore::initialiseHeader(int capacity)
+{
+    auto& h = header();
+    std::memcpy(h.magic, storeMagic, sizeof(storeMagic));
+    h.version = formatVersion;
+    h.capacity = (juce::uint32)capacity;
+    h.numColumns = numColumns;
+    h.count = 0;
+    h.next = 0;
+    h.sequence = 0;
+}
+
+bool ReferenceTraceStore::isOpenElsewhere(const juce::File& file)
+{
+    return getOpenFiles().contains(file);
+}
+
+void ReferenceTraceStore::open(const juce::File& file, int capacity)
+{
+    close();
+
+    backingFile = file;
+    fileCapacity = juce::jmax(1, capacity);
+    getOpenFiles().add(file);
+    ++changeCount;
+
+    // Keep what a previous session stored if the layout still matches; otherwise stay
+    // empty, and the file is rewritten if the ring ever grows into it
+    const juce::int64 bytes = getBytes(fileCapacity);
+    if (file.getSize() != bytes || !mapFile(bytes))
+        return;
+
+    const auto& h = header();
+    const bool valid = std::memcmp(h.magic, storeMagic, sizeof(storeMagic)) == 0
+                    && h.version == formatVersion && h.capacity == (juce::uint32)fileCapacity
+                    && h.numColumns == (juce::uint32)numColumns && h.count <= h.capacity && h.next < h.capacity;
+    if (!valid || h.count == 0)
+        release();
+}
+
+void ReferenceTraceStore::close()
+{
+    release();
+
+    if (backingFile == juce::File())
+        return;
+
+    getOpenFiles().removeFirstMatchingValue(backingFile);
+
+    // Nothing will ever open an unsaved instance's file again
+    if (!referencedBySavedState)
+        backingFile.deleteFile();
+
+    backingFile = juce::File();
+    referencedBySavedState = false;
+}
+
+void ReferenceTraceStore::release()
+{
+    mappedFile.reset();
+    memory.free();
+    storage = nullptr;
+}
+
+bool ReferenceTraceStore::mapFile(juce::int64 bytes)
+{
+    mappedFile = std::make_unique<juce::MemoryMappedFile>(backingFile, juce::MemoryMappedFile::readWrite);
+
+    if (mappedFile->getData() == nullptr || (juce::int64)mappedFile->getSize() < bytes)
+    {
+        mappedFile.reset();
+        return false;
+    }
+
+    storage = static_cast<char*>(mappedFile->getData());
+    return true;
+}
+
+void ReferenceTraceStore::grow()
+{
+    // The full ring, oldest reference first, written to the file and mapped; it stays on
+    // the heap if the file cannot be written
+    const juce::int64 bytes = getBytes(fileCapacity);
+    const int count = size();
+    const juce::uint32 sequence = header().sequence;
+
+    juce::HeapBlock<char> grown;
+    grown.calloc((size_t)bytes);
+
+    auto* grownRecords = reinterpret_cast<Record*>(grown.get() + sizeof(Header));
+    for (int i = 0; i < count; ++i)
+        grownRecords[i] = get(i);
+
+    release();
+    memory.swapWith(grown);
+    storage = memory.get();
+
+    initialiseHeader(fileCapacity);
+    header().count = (juce::uint32)count;
+    header().next = (juce::uint32)(count % fileCapacity);
+    header().sequence = sequence;
+
+    if (backingFile == juce::File())
+        return;
+
+    backingFile.getParentDirectory().createDirectory();
+    backingFile.deleteFile();
+
+    {
+        juce::FileOutputStream out(backingFile);
+        if (!out.openedOk() || !out.write(storage, (size_t)bytes))
+            return;
+    }
+
+    // Keep the heap copy alive until the mapping has taken over
+    if (mapFile(bytes))
+        memory.free();
+}
+
+void ReferenceTraceStore::add(const Record& record)
+{
+    if (storage == nullptr)
+    {
+        const int capacity = juce::jmin(memoryCapacity, fileCapacity);
+        memory.calloc((size_t)getBytes(capacity));
+        storage = memory.get();
+        initialiseHeader(capacity);
+    }
+    else if (header().count == header().capacity && (int)header().capacity < fileCapacity)
+    {
+        grow();
+    }
+
+    auto& h = header();
+    auto& slot = records()[h.next];
+
+    slot = record;
+    slot.sequence = ++h.sequence;
+
+    h.next = (h.next + 1) % h.capacity;
+    h.count = juce::jmin(h.count + 1, h.capacity);
+    ++changeCount;
+}
+
+void ReferenceTraceStore::clear()
+{
+    release();
+
+    if (backingFile != juce::File())
+        backingFile.deleteFile();
+
+    ++changeCount;
+}
+
+int ReferenceTraceStore::size() const noexcept
+{
+    return storage != nullptr ? (int)header().count : 0;
+}
+
+int ReferenceTraceStore::getCapacity() const noexcept
+{
+    return fileCapacity;
+}
+
+const ReferenceTraceStore::Record& ReferenceTraceStore::get(int index) const
+{
+    const auto& h = header();
+    const juce::uint32 oldest = (h.next + h.capacity - h.count) % h.capacity;
+    return records()[(oldest + (juce::uint32)index) % h.capacity];
+}
+
+juce::File ReferenceTraceStore::getDefaultFolder()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Auralyzer")
+        .getChildFile("References");
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Reference (snapshot) traces kept as fixed-size decimated min/max records in a ring.
+// Nothing is allocated until the first reference is added; the first few live in a small
+// ring in RAM, and only when more are needed does the ring grow into a memory-mapped file,
+// so hundreds of references cost page cache rather than heap. The store belongs to the
+// processor, so references survive the editor being closed and reopened. Only a ring that
+// has moved to its file is found again when a saved session is reloaded: the first
+// memoryCapacity references are not saved.
+//
+// A file belongs to one live store at a time. It is deleted when the store is cleared, or
+// destroyed while no saved state refers to it. Message thread only.
+class ReferenceTraceStore
+{
+public:
+    static constexpr int numColumns = 1024;
+    static constexpr int defaultCapacity = 512;
+    static constexpr int memoryCapacity = 16;     // held in RAM before the ring moves to a file
+
+    // Trace values are in vertical divisions from the centre line (positive up), so a
+    // reference keeps its place on screen whatever the component size.
+    struct Record
+    {
+        float top[numColumns];
+        float bottom[numColumns];
+
+        float vpp = 0.0f;
+        float vrms = 0.0f;
+        float frequency = 0.0f;
+        float thd = 0.0f;         // percent
+        juce::uint32 colour = 0;  // ARGB
+        juce::uint32 isDC = 0;
+        juce::uint32 sequence = 0;
+        juce::uint32 reserved = 0;
+    };
+
+    ReferenceTraceStore();
+    ~ReferenceTraceStore();
+
+    // Maps file if it already holds a ring (references of a previous session), otherwise
+    // stays empty and creates the file only once more than memoryCapacity references are
+    // added. The previous file is closed as by the destructor.
+    void open(const juce::File& file, int capacity = defaultCapacity);
+    bool isFileBacked() const noexcept { return mappedFile != nullptr; }
+
+    // True if another live store has file open; a restored duplicate then takes a copy
+    static bool isOpenElsewhere(const juce::File& file);
+
+    // Called when the plugin state naming the file is saved (from any thread), so the file
+    // outlives the store
+    void setReferencedBySavedState() noexcept { referencedBySavedState = true; }
+
+    void add(const Record& record);
+    void clear();
+
+    int size() const noexcept;
+    int getCapacity() const noexcept;
+
+    // index 0 is the oldest reference still held
+    const Record& get(int index) const;
+
+    // Changes whenever references are added, cleared or reloaded
+    juce::uint32 getChangeCount() const noexcept { return changeCount; }
+
+    static juce::File getDefaultFolder();
+
+private:
+    struct Header
+    {
+        char magic[8];
+        juce::uint32 version;
+        juce::uint32 capacity;
+        juce::uint32 numColumns;
+        juce::uint32 count;
+        juce::uint32 next;
+        juce::uint32 sequence;
+    };
+
+    Header& header() const noexcept { return *reinterpret_cast<Header*>(storage); }
+    Record* records() const noexcept { return reinterpret_cast<Record*>(storage + sizeof(Header)); }
+    static juce::int64 getBytes(int capacity) noexcept { return (juce::int64)sizeof(Header) + (juce::int64)sizeof(Record) * capacity; }
+    void initialiseHeader(int capacity);
+    bool mapFile(juce::int64 bytes);
+    void grow();
+    void close();
+    void release();
+
+    static constexpr juce::uint32 formatVersion = 1;
+
+    juce::File backingFile;
+    int fileCapacity = defaultCapacity;
+    std::atomic<bool> referencedBySavedState{ false };
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::HeapBlock<char> memory;
+    char* storage = nullptr;            // nullptr: no references
+    juce::uint32 changeCount = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReferenceTraceStore)
+};
@@ -0,0 +1,204 @@
+#include "ResponseAnalyzer.h"
+
+namespace
+{
+    std::vector<std::complex<float>> computeSpectrum(juce::dsp::FFT& fft, const std::vector<float>& signal)
+    {
+        const int n = fft.getSize();
+        std::vector<float> data((size_t)n * 2, 0.0f);
+        std::copy_n(signal.begin(), juce::jmin((int)signal.size(), n), data.begin());
+        fft.performRealOnlyForwardTransform(data.data(), true);
+
+        std::vector<std::complex<float>> spectrum((size_t)n / 2 + 1);
+        for (size_t k = 0; k < spectrum.size(); ++k)
+            spectrum[k] = { data[k * 2], data[k * 2 + 1] };
+
+        return spectrum;
+    }
+}
+
+ResponseAnalyzer::ResponseAnalyzer() : juce::Thread("Response-Analyzer")
+{
+}
+
+ResponseAnalyzer::~ResponseAnalyzer()
+{
+    stopThread(1000);
+}
+
+void ResponseAnalyzer::prepare(double newSampleRate, const SignalGenerator& generator)
+{
+    stopThread(1000);
+
+    sampleRate = newSampleRate;
+    startHz = SignalGenerator::stimulusStartHz;
+    endHz = generator.getStimulusEndHz();
+
+    sweepSpectrum = computeSpectrum(fft, generator.getStimulus(SignalGenerator::Waveform::logSweep));
+    multitoneSpectrum = computeSpectrum(fft, generator.getStimulus(SignalGenerator::Waveform::multitoneStimulus));
+
+    capture.assign((size_t)periodLength, 0.0f);
+    fftData.assign((size_t)periodLength * 2, 0.0f);
+    transfer.assign((size_t)periodLength / 2 + 1, {});
+
+    periodStarts = 0;
+    capturing = false;
+    capturePending.store(false);
+
+    startThread(juce::Thread::Priority::low);
+}
+
+void ResponseAnalyzer::pushInput(const float* input, int numSamples, SignalGenerator::Waveform stimulus,
+                                 int position, float amplitude) noexcept
+{
+    if (capture.empty())
+        return;
+
+    // A new stimulus has to play one full period before the response is periodic
+    if (stimulus != lastStimulus)
+    {
+        lastStimulus = stimulus;
+        periodStarts = 0;
+        capturing = false;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int pos = (position + i) % periodLength;
+
+        if (pos == 0)
+        {
+            periodStarts = juce::jmin(periodStarts + 1, 2);
+
+            if (!capturing && periodStarts >= 2 && !capturePending.load(std::memory_order_acquire))
+            {
+                capturing = true;
+                captureStimulus = stimulus;
+                captureAmplitude = amplitude;
+            }
+        }
+
+        if (!capturing)
+            continue;
+
+        capture[(size_t)pos] = input[i];
+
+        if (pos == periodLength - 1)
+        {
+            capturing = false;
+            capturePending.store(true, std::memory_order_release);
+            waitForCapture.signal();
+        }
+    }
+}
+
+void ResponseAnalyzer::run()
+{
+    while (!threadShouldExit())
+    {
+        waitForCapture.wait(100);
+
+        if (capturePending.load(std::memory_order_acquire))
+        {
+            analyse();
+            capturePending.store(false, std::memory_order_release);
+        }
+    }
+}
+
+void ResponseAnalyzer::analyse()
+{
+    const int n = periodLength;
+    const int numBins = n / 2 + 1;
+    const auto& stimulus = captureStimulus == SignalGenerator::Waveform::logSweep ? sweepSpectrum : multitoneSpectrum;
+
+    std::fill(fftData.begin(), fftData.end(), 0.0f);
+    std::copy(capture.begin(), capture.end(), fftData.begin());
+    fft.performRealOnlyForwardTransform(fftData.data(), true);
+
+    // Deconvolve where the stimulus carries energy (within 40 dB of its strongest bin)
+    float maxPower = 0.0f;
+    for (const auto& x : stimulus)
+        maxPower = juce::jmax(maxPower, std::norm(x));
+
+    const float threshold = maxPower * 1.0e-4f;
+    const float inverseAmplitude = 1.0f / juce::jmax(captureAmplitude, 1.0e-6f);
+
+    for (int k = 0; k < numBins; ++k)
+    {
+        const Complex y(fftData[(size_t)k * 2], fftData[(size_t)k * 2 + 1]);
+        const auto& x = stimulus[(size_t)k];
+        transfer[(size_t)k] = std::norm(x) > threshold ? y / x * inverseAmplitude : Complex();
+    }
+
+    // Impulse response; its peak is the loop latency, which would otherwise wrap the phase
+    for (int k = 0; k < numBins; ++k)
+    {
+        fftData[(size_t)k * 2] = transfer[(size_t)k].real();
+        fftData[(size_t)k * 2 + 1] = transfer[(size_t)k].imag();
+    }
+
+    fft.performRealOnlyInverseTransform(fftData.data());
+
+    int peak = 0;
+    for (int i = 1; i < n; ++i)
+        if (std::abs(fftData[(size_t)i]) > std::abs(fftData[(size_t)peak]))
+            peak = i;
+
+    const int latency = peak > n / 2 ? peak - n : peak;
+
+    // Log-spaced bands, averaging the latency-compensated transfer function of every
+    // excited bin in each band at the mean frequency of those bins; bands without
+    // excited bins (gaps between multitone lines) are left out
+    Response result;
+    result.latencySamples = latency;
+
+    const double binHz = sampleRate / n;
+    const double ratio = std::pow((double)endHz / startHz, 1.0 / numPoints);
+    double lowHz = startHz;
+
+    for (int b = 0; b < numPoints; ++b)
+    {
+        const double highHz = lowHz * ratio;
+        const int firstBin = juce::jmax(1, (int)std::ceil(lowHz / binHz));
+        const int lastBin = juce::jmin(numBins - 1, (int)std::ceil(highHz / binHz) - 1);
+
+        Complex sum;
+        int count = 0;
+        double binSum = 0.0;
+
+        for (int k = firstBin; k <= lastBin; ++k)
+        {
+            if (transfer[(size_t)k] == Complex())
+                continue;
+
+            const double delayPhase = juce::MathConstants<double>::twoPi * k * latency / n;
+            sum += transfer[(size_t)k] * std::polar(1.0f, (float)delayPhase);
+            binSum += k;
+            ++count;
+        }
+
+        if (count > 0)
+        {
+            sum /= (float)count;
+            result.frequency.push_back((float)(binSum / count * binHz));
+            result.magnitudeDb.push_back(juce::Decibels::gainToDecibels(std::abs(sum), -200.0f));
+            result.phaseDegrees.push_back(juce::radiansToDegrees(std::arg(sum)));
+        }
+
+        lowHz = highHz;
+    }
+
+    {
+        juce::ScopedLock lock(responseLock);
+        response = std::move(result);
+    }
+
+    newResponseAvailable.store(true);
+}
+
+ResponseAnalyzer::Response ResponseAnalyzer::getResponse() const
+{
+    juce::ScopedLock lock(responseLock);
+    return response;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SignalGenerator.h"
+
+// Synchronous frequency response measurement. While the generator plays a periodic
+// stimulus (log sweep or multitone), the audio thread copies exactly one period of the
+// input, aligned to the stimulus table, once the stimulus has played for a full period.
+// The analysis thread then deconvolves it in the frequency domain, H = Y / X, removes
+// the loop latency (found as the peak of the impulse response) and publishes log-spaced
+// magnitude/phase points. One forward and one inverse FFT per measurement. The phase is
+// relative to that whole-sample latency, which the sparse multitone can misjudge by one.
+class ResponseAnalyzer : public juce::Thread
+{
+public:
+    struct Response
+    {
+        std::vector<float> frequency;
+        std::vector<float> magnitudeDb;
+        std::vector<float> phaseDegrees;
+        int latencySamples = 0;
+    };
+
+    static constexpr int numPoints = 128;
+
+    ResponseAnalyzer();
+    ~ResponseAnalyzer() override;
+
+    // Takes the stimulus spectra from a prepared generator and starts the analysis thread
+    void prepare(double sampleRate, const SignalGenerator& generator);
+
+    // Audio thread. position is the stimulus table index of input[0] and amplitude the
+    // peak level the stimulus is being played at.
+    void pushInput(const float* input, int numSamples, SignalGenerator::Waveform stimulus, int position, float amplitude) noexcept;
+
+    // Message thread
+    bool checkForNewResponse() { return newResponseAvailable.exchange(false); }
+    Response getResponse() const;
+
+private:
+    using Complex = std::complex<float>;
+
+    void run() override;
+    void analyse();
+
+    static constexpr int periodLength = SignalGenerator::stimulusLength;
+
+    juce::WaitableEvent waitForCapture;
+    double sampleRate = 48000.0;
+    float startHz = SignalGenerator::stimulusStartHz;
+    float endHz = SignalGenerator::stimulusEndHz;
+
+    // Spectra of the unit-amplitude stimuli, bins 0..N/2
+    std::vector<Complex> sweepSpectrum, multitoneSpectrum;
+
+    // Audio thread capture state; the buffer belongs to the analysis thread while capturePending is set
+    std::vector<float> capture;
+    SignalGenerator::Waveform lastStimulus = SignalGenerator::Waveform::sine;
+    SignalGenerator::Waveform captureStimulus = SignalGenerator::Waveform::sine;
+    float captureAmplitude = 1.0f;
+    int periodStarts = 0;
+    bool capturing = false;
+    std::atomic<bool> capturePending{ false };
+
+    // Analysis thread scratch
+    juce::dsp::FFT fft{ SignalGenerator::stimulusOrder };
+    std::vector<float> fftData;
+    std::vector<Complex> transfer;
+
+    mutable juce::CriticalSection responseLock;
+    Response response;
+    std::atomic<bool> newResponseAvailable{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseAnalyzer)
+};
@@ -0,0 +1,124 @@
+#include "SegmentedCapture.h"
+
+void SegmentedCapture::prepare(int numChannels, int segmentLengthSamples, int maxSegments, double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    segmentLength = segmentLengthSamples;
+    preTriggerSamples = segmentLength / 4; // 25 % pre-trigger, like the live view
+
+    pool.setSize(numChannels, segmentLength * maxSegments, false, true, true);
+    segments.assign((size_t)maxSegments, {});
+
+    armed.store(false);
+    armRequest.store(0);
+    numCaptured.store(0);
+    requested.store(0);
+    generation.fetch_add(1);
+    pendingTrigger = -1;
+    lastSample = 0.0f;
+}
+
+void SegmentedCapture::arm(int numSegments)
+{
+    armRequest.store(juce::jmax(1, numSegments));
+}
+
+void SegmentedCapture::disarm()
+{
+    armRequest.store(-1);
+}
+
+juce::uint32 SegmentedCapture::endRead() const noexcept
+{
+    // Orders the segment reads before the generation check (a sequence lock)
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return generation.load(std::memory_order_relaxed);
+}
+
+const float* SegmentedCapture::getSegmentData(int index, int channel) const
+{
+    return pool.getReadPointer(channel, index * segmentLength);
+}
+
+void SegmentedCapture::process(const juce::AudioBuffer<float>& block, int triggerChannel, const CircularAudioBuffer& history)
+{
+    const int request = armRequest.exchange(0);
+
+    if (request > 0)
+    {
+        // The new generation is published before any segment of the previous one is
+        // overwritten, so a reader still holding the old one sees the change
+        generation.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const int count = juce::jmin(request, static_cast<int>(segments.size()));
+        requested.store(count, std::memory_order_release);
+        numCaptured.store(0, std::memory_order_release);
+        pendingTrigger = -1;
+        armed.store(count > 0, std::memory_order_release);
+    }
+    else if (request < 0)
+    {
+        pendingTrigger = -1;
+        armed.store(false, std::memory_order_release);
+    }
+
+    const int numSamples = block.getNumSamples();
+    if (numSamples == 0 || block.getNumChannels() == 0)
+        return;
+
+    const float* data = juce::isPositiveAndBelow(triggerChannel, block.getNumChannels()) ? block.getReadPointer(triggerChannel) : nullptr;
+    const juce::int64 written = history.getTotalSamplesWritten();
+    const juce::int64 blockStart = written - numSamples;
+    int searchFrom = 0;
+
+    // Rearm immediately after each segment: several short segments may complete
+    // inside a single block.
+    while (armed.load(std::memory_order_relaxed))
+    {
+        if (pendingTrigger >= 0)
+        {
+            const juce::int64 segmentEnd = pendingTrigger - preTriggerSamples + segmentLength;
+            if (segmentEnd > written)
+                break;
+
+            storeSegment(history);
+            searchFrom = static_cast<int>(juce::jmax<juce::int64>(0, segmentEnd - blockStart));
+            continue;
+        }
+
+        if (searchFrom >= numSamples || data == nullptr)
+            break;
+
+        const int hit = trigger.findNextTrigger(data, searchFrom, numSamples, lastSample);
+        if (hit < 0)
+            break;
+
+        pendingTrigger = blockStart + hit;
+    }
+
+    if (data != nullptr)
+        lastSample = data[numSamples - 1];
+}
+
+void SegmentedCapture::storeSegment(const CircularAudioBuffer& history)
+{
+    const int index = numCaptured.load(std::memory_order_relaxed);
+    const juce::int64 start = pendingTrigger - preTriggerSamples;
+    const int numChannels = juce::jmin(pool.getNumChannels(), history.getNumChannels());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* dest = pool.getWritePointer(ch, index * segmentLength);
+        if (!history.copyRange(ch, start, segmentLength, dest))
+            juce::FloatVectorOperations::clear(dest, segmentLength);
+    }
+
+    segments[(size_t)index] = { pendingTrigger, static_cast<double>(pendingTrigger) / sampleRate };
+    pendingTrigger = -1;
+
+    numCaptured.store(index + 1, std::memory_order_release);
+
+    if (index + 1 >= requested.load(std::memory_order_relaxed))
+        armed.store(false, std::memory_order_release);
+}
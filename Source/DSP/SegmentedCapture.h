@@ -0,0 +1,74 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CircularAudioBuffer.h"
+#include "Trigger.h"
+
+// Fast-frame acquisition: every trigger event copies a fixed-length segment out of the
+// capture history into a preallocated pool. Capture runs on the audio thread and never
+// allocates; the UI reads segments through getSegmentData() only once a capture is
+// complete, and checks the generation afterwards in case it was re-armed meanwhile.
+class SegmentedCapture
+{
+public:
+    struct Segment
+    {
+        juce::int64 triggerSample = 0; // absolute sample index of the trigger edge
+        double timestamp = 0.0;        // seconds since prepareToPlay
+    };
+
+    static constexpr int defaultSegmentLength = 2048;
+    static constexpr int maxSegmentCount = 2000;
+
+    SegmentedCapture() = default;
+
+    void prepare(int numChannels, int segmentLengthSamples, int maxSegments, double sampleRate);
+    void setTriggerLevel(float level) { trigger.setParameters(level, 0.0f, false); }
+
+    // Message thread: request numSegments captures (1 = single shot) or stop.
+    void arm(int numSegments);
+    void disarm();
+
+    // Audio thread: call right after the block was pushed into history. Triggers on
+    // triggerChannel of block; -1 (nothing to trigger on) only completes pending segments.
+    void process(const juce::AudioBuffer<float>& block, int triggerChannel, const CircularAudioBuffer& history);
+
+    bool isArmed() const noexcept { return armed.load(std::memory_order_acquire); }
+    int getNumCaptured() const noexcept { return numCaptured.load(std::memory_order_acquire); }
+    int getNumRequested() const noexcept { return requested.load(std::memory_order_acquire); }
+
+    // Bumped each time a capture starts (before its first segment is written). A reader
+    // takes it with beginRead(), reads the segments of a complete capture, and keeps what
+    // it read only if endRead() returns the same value.
+    juce::uint32 beginRead() const noexcept { return generation.load(std::memory_order_acquire); }
+    juce::uint32 endRead() const noexcept;
+    bool isComplete() const noexcept { return !isArmed() && getNumCaptured() > 0; }
+    int getNumChannels() const noexcept { return pool.getNumChannels(); }
+    int getSegmentLength() const noexcept { return segmentLength; }
+    int getPreTriggerSamples() const noexcept { return preTriggerSamples; }
+
+    const Segment& getSegment(int index) const { return segments[(size_t)index]; }
+    const float* getSegmentData(int index, int channel) const;
+
+private:
+    void storeSegment(const CircularAudioBuffer& history);
+
+    Trigger trigger;
+    juce::AudioBuffer<float> pool;
+    std::vector<Segment> segments;
+
+    double sampleRate = 48000.0;
+    int segmentLength = 0;
+    int preTriggerSamples = 0;
+    std::atomic<int> requested{ 0 };
+    std::atomic<juce::uint32> generation{ 0 };
+
+    std::atomic<int> armRequest{ 0 }; // > 0 arm with that many segments, < 0 disarm
+    std::atomic<int> numCaptured{ 0 };
+    std::atomic<bool> armed{ false };
+
+    juce::int64 pendingTrigger = -1;
+    float lastSample = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SegmentedCapture)
+};
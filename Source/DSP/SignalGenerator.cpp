@@ -0,0 +1,262 @@
+#include "SignalGenerator.h"
+
+void SignalGenerator::Oscillator::setFrequency(double hz, double sampleRate) noexcept
+{
+    const double step = juce::MathConstants<double>::twoPi * hz / sampleRate;
+    cosStep = std::cos(step);
+    sinStep = std::sin(step);
+}
+
+juce::String SignalGenerator::getName(Waveform w)
+{
+    switch (w)
+    {
+        case Waveform::sine:      return "Sine";
+        case Waveform::square:    return "Square";
+        case Waveform::multitone: return "Multitone";
+        case Waveform::logSweep:  return "Log sweep";
+        case Waveform::multitoneStimulus: return "Multitone stimulus";
+        default:                  return {};
+    }
+}
+
+void SignalGenerator::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    buildStimuli();
+    reset();
+}
+
+const std::vector<float>& SignalGenerator::getStimulus(Waveform w) const
+{
+    return w == Waveform::logSweep ? sweepTable : multitoneTable;
+}
+
+void SignalGenerator::buildStimuli()
+{
+    const int n = stimulusLength;
+    const double f1 = stimulusStartHz;
+    const double f2 = getStimulusEndHz();
+
+    // Exponential sweep over one period, with short raised-cosine fades so the wrap back
+    // to f1 does not splash energy across the band
+    sweepTable.assign((size_t)n, 0.0f);
+    const double duration = n / sampleRate;
+    const double rate = duration / std::log(f2 / f1);
+    const int fade = n / 100;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const double t = i / sampleRate;
+        const double phase = juce::MathConstants<double>::twoPi * f1 * rate * (std::exp(t / rate) - 1.0);
+        double gain = 1.0;
+        if (i < fade)
+            gain = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * i / fade);
+        else if (i >= n - fade)
+            gain = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * (n - 1 - i) / fade);
+        sweepTable[(size_t)i] = (float)(std::sin(phase) * gain);
+    }
+
+    // Log-spaced tones placed exactly on FFT bins of the period, random phases, built
+    // with one inverse FFT and normalised to unit peak
+    juce::dsp::FFT fft(stimulusOrder);
+    std::vector<float> spectrum((size_t)n * 2, 0.0f);
+    juce::Random random(0x5eed);
+
+    for (int k = 0; k < multitoneStimulusTones; ++k)
+    {
+        const double hz = f1 * std::pow(f2 / f1, (double)k / (multitoneStimulusTones - 1));
+        const int bin = juce::jlimit(1, n / 2 - 1, (int)std::lround(hz * n / sampleRate));
+        const double phase = random.nextDouble() * juce::MathConstants<double>::twoPi;
+        spectrum[(size_t)bin * 2] = (float)std::cos(phase);
+        spectrum[(size_t)bin * 2 + 1] = (float)std::sin(phase);
+    }
+
+    fft.performRealOnlyInverseTransform(spectrum.data());
+
+    const auto range = juce::FloatVectorOperations::findMinAndMax(spectrum.data(), n);
+    const float peak = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0e-9f);
+    multitoneTable.assign(spectrum.begin(), spectrum.begin() + n);
+    juce::FloatVectorOperations::multiply(multitoneTable.data(), 1.0f / peak, n);
+}
+
+void SignalGenerator::reset()
+{
+    activeFrequency = 0.0f;     // forces updateSettings() to rebuild everything
+    squarePhase = 0.0;
+    stimulusPosition = 0;
+
+    for (auto& osc : oscillators)
+    {
+        osc.re = 1.0;
+        osc.im = 0.0;
+    }
+}
+
+void SignalGenerator::updateSettings() noexcept
+{
+    const auto newWaveform = waveform.load();
+    const float newFrequency = juce::jlimit(1.0f, (float)(sampleRate * 0.45), frequency.load());
+
+    if (newWaveform == activeWaveform && newFrequency == activeFrequency)
+        return;
+
+    const bool waveformChanged = newWaveform != activeWaveform;
+    activeWaveform = newWaveform;
+    activeFrequency = newFrequency;
+
+    // The sine keeps its phasor so a frequency change is click free
+    oscillators[0].setFrequency(newFrequency, sampleRate);
+    squareIncrement = newFrequency / sampleRate;
+
+    // Octave spaced tones below 0.45 fs, with Newman phases to keep the crest factor low
+    numTones = 1;
+    while (numTones < maxTones && newFrequency * (float)(1 << numTones) < sampleRate * 0.45)
+        ++numTones;
+
+    if (activeWaveform == Waveform::multitone)
+    {
+        for (int k = 0; k < numTones; ++k)
+        {
+            auto& osc = oscillators[(size_t)k];
+            const double phase = juce::MathConstants<double>::pi * k * k / numTones;
+            osc.setFrequency(newFrequency * (double)(1 << k), sampleRate);
+            osc.re = std::cos(phase);
+            osc.im = std::sin(phase);
+        }
+    }
+    else if (waveformChanged)
+    {
+        oscillators[0].re = 1.0;
+        oscillators[0].im = 0.0;
+    }
+
+    // Stimuli always start at the top of their period
+    if (waveformChanged)
+        stimulusPosition = 0;
+}
+
+void SignalGenerator::render(juce::AudioBuffer<float>& buffer, float amplitude) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    if (buffer.getNumChannels() == 0 || numSamples == 0)
+        return;
+
+    updateSettings();
+
+    float* dest = buffer.getWritePointer(0);
+
+    switch (activeWaveform)
+    {
+        case Waveform::sine:      renderSine(dest, numSamples, amplitude); break;
+        case Waveform::square:    renderSquare(dest, numSamples, amplitude); break;
+        case Waveform::multitone: renderMultitone(dest, numSamples, amplitude); break;
+        case Waveform::logSweep:
+        case Waveform::multitoneStimulus: renderStimulus(getStimulus(activeWaveform), dest, numSamples, amplitude); break;
+        default:                  break;
+    }
+
+    for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+        buffer.copyFrom(channel, 0, buffer, 0, 0, numSamples);
+}
+
+void SignalGenerator::renderSine(float* dest, int numSamples, float amplitude) noexcept
+{
+    auto& osc = oscillators[0];
+    double re = osc.re, im = osc.im;
+    const double c = osc.cosStep, s = osc.sinStep;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        dest[i] = (float)im * amplitude;
+
+        const double nextRe = re * c - im * s;
+        im = re * s + im * c;
+        re = nextRe;
+    }
+
+    // First order correction back onto the unit circle; the rounding drift per block is tiny
+    const double gain = 1.5 - 0.5 * (re * re + im * im);
+    osc.re = re * gain;
+    osc.im = im * gain;
+}
+
+void SignalGenerator::renderSquare(float* dest, int numSamples, float amplitude) noexcept
+{
+    // PolyBLEP residual smoothing the step at each transition
+    auto polyBlep = [dt = squareIncrement](double t)
+    {
+        if (t < dt)
+        {
+            t /= dt;
+            return t + t - t * t - 1.0;
+        }
+        if (t > 1.0 - dt)
+        {
+            t = (t - 1.0) / dt;
+            return t * t + t + t + 1.0;
+        }
+        return 0.0;
+    };
+
+    double phase = squarePhase;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        double value = phase < 0.5 ? 1.0 : -1.0;
+        value += polyBlep(phase);
+        value -= polyBlep(std::fmod(phase + 0.5, 1.0));
+        dest[i] = (float)value * amplitude;
+
+        phase += squareIncrement;
+        if (phase >= 1.0)
+            phase -= 1.0;
+    }
+
+    squarePhase = phase;
+}
+
+void SignalGenerator::renderMultitone(float* dest, int numSamples, float amplitude) noexcept
+{
+    // Equal tone levels, scaled so the sum can never exceed the requested peak
+    const float toneAmplitude = amplitude / (float)numTones;
+    juce::FloatVectorOperations::clear(dest, numSamples);
+
+    for (int k = 0; k < numTones; ++k)
+    {
+        auto& osc = oscillators[(size_t)k];
+        double re = osc.re, im = osc.im;
+        const double c = osc.cosStep, s = osc.sinStep;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            dest[i] += (float)im * toneAmplitude;
+
+            const double nextRe = re * c - im * s;
+            im = re * s + im * c;
+            re = nextRe;
+        }
+
+        const double gain = 1.5 - 0.5 * (re * re + im * im);
+        osc.re = re * gain;
+        osc.im = im * gain;
+    }
+}
+
+void SignalGenerator::renderStimulus(const std::vector<float>& table, float* dest, int numSamples, float amplitude) noexcept
+{
+    if (table.empty())
+    {
+        juce::FloatVectorOperations::clear(dest, numSamples);
+        return;
+    }
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int count = juce::jmin(numSamples - done, stimulusLength - stimulusPosition);
+        juce::FloatVectorOperations::multiply(dest + done, table.data() + stimulusPosition, amplitude, count);
+
+        done += count;
+        stimulusPosition = (stimulusPosition + count) % stimulusLength;
+    }
+}
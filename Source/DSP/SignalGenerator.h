@@ -0,0 +1,93 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Calibration signal generator. Every waveform is computed once per block into the first
+// channel and copied to the others, so all outputs stay phase aligned. The sine is a
+// recursive quadrature oscillator (one complex rotation per sample, renormalised once per
+// block) instead of a std::sin call per sample; the square is band-limited with PolyBLEP
+// and the multitone is a small bank of quadrature oscillators.
+//
+// The two measurement stimuli (log sweep and a dense multitone) are periodic tables of
+// stimulusLength samples built in prepare(), so a single captured period can be
+// deconvolved against the stimulus with one FFT (see ResponseAnalyzer).
+class SignalGenerator
+{
+public:
+    enum class Waveform
+    {
+        sine,
+        square,
+        multitone,
+        logSweep,
+        multitoneStimulus
+    };
+
+    static constexpr int maxTones = 6;
+    static constexpr int stimulusOrder = 16;
+    static constexpr int stimulusLength = 1 << stimulusOrder;
+    static constexpr float stimulusStartHz = 20.0f;
+    static constexpr float stimulusEndHz = 20000.0f;
+    static constexpr int multitoneStimulusTones = 128;
+
+    SignalGenerator() = default;
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // Any thread; picked up by the audio thread at the start of the next block
+    void setWaveform(Waveform newWaveform) noexcept { waveform.store(newWaveform); }
+    void setFrequency(float newFrequency) noexcept { frequency.store(newFrequency); }
+    Waveform getWaveform() const noexcept { return waveform.load(); }
+    float getFrequency() const noexcept { return frequency.load(); }
+
+    // Audio thread: overwrites every channel of buffer with the signal at the given peak amplitude
+    void render(juce::AudioBuffer<float>& buffer, float amplitude) noexcept;
+
+    // Audio thread: the waveform being rendered and, for stimuli, the table index of the
+    // next sample render() will produce
+    Waveform getActiveWaveform() const noexcept { return activeWaveform; }
+    int getStimulusPosition() const noexcept { return stimulusPosition; }
+
+    // One period of a stimulus at unit peak amplitude (empty before prepare())
+    const std::vector<float>& getStimulus(Waveform w) const;
+    float getStimulusEndHz() const noexcept { return juce::jmin(stimulusEndHz, (float)(sampleRate * 0.45)); }
+
+    static bool isStimulus(Waveform w) noexcept { return w == Waveform::logSweep || w == Waveform::multitoneStimulus; }
+    static juce::String getName(Waveform w);
+
+private:
+    struct Oscillator
+    {
+        void setFrequency(double hz, double sampleRate) noexcept;
+
+        double re = 1.0, im = 0.0;          // current phasor
+        double cosStep = 1.0, sinStep = 0.0;
+    };
+
+    void updateSettings() noexcept;
+    void renderSine(float* dest, int numSamples, float amplitude) noexcept;
+    void renderSquare(float* dest, int numSamples, float amplitude) noexcept;
+    void renderMultitone(float* dest, int numSamples, float amplitude) noexcept;
+    void renderStimulus(const std::vector<float>& table, float* dest, int numSamples, float amplitude) noexcept;
+    void buildStimuli();
+
+    std::atomic<Waveform> waveform{ Waveform::sine };
+    std::atomic<float> frequency{ 1000.0f };
+
+    // Audio thread state
+    double sampleRate = 48000.0;
+    Waveform activeWaveform = Waveform::sine;
+    float activeFrequency = 0.0f;
+
+    std::array<Oscillator, maxTones> oscillators;
+    int numTones = 1;
+
+    double squarePhase = 0.0;       // [0, 1)
+    double squareIncrement = 0.0;
+
+    std::vector<float> sweepTable, multitoneTable;
+    int stimulusPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SignalGenerator)
+};
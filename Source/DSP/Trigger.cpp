@@ -33,6 +33,35 @@ int Trigger::findTriggerPoint(const juce::AudioBuffer<float>& buffer, int channe
     return triggerStart;
 }
 
+int Trigger::findNextTrigger(const float* data, int startSample, int numSamples, float previousSample) const noexcept
+{
+    float previous = startSample > 0 ? data[startSample - 1] : previousSample;
+
+    for (int i = startSample; i < numSamples; ++i)
+    {
+        if (previous < triggerLevel && data[i] >= triggerLevel)
+            return i;
+
+        previous = data[i];
+    }
+
+    return -1;
+}
+
+int Trigger::countTriggers(const float* data, int numSamples, float previousSample) const noexcept
+{
+    int count = 0;
+    float previous = previousSample;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        count += (previous < triggerLevel && data[i] >= triggerLevel) ? 1 : 0;
+        previous = data[i];
+    }
+
+    return count;
+}
+
 void Trigger::movingAverageFilter(const float* input, float* output, int numSamples)
 {
     const int windowSize = 5; // 5-sample window (adjustable)
@@ -14,6 +14,12 @@ public:
 		movingAverageEnabled = useFilter;
 	}
 	int findTriggerPoint(const juce::AudioBuffer<float>& buffer, int channel);
+
+	// Streaming edge search used by the audio-thread consumers: returns the first
+	// rising crossing in [startSample, numSamples) or -1. previousSample is the last
+	// sample of the previous block so edges across block boundaries are not missed.
+	int findNextTrigger(const float* data, int startSample, int numSamples, float previousSample) const noexcept;
+	int countTriggers(const float* data, int numSamples, float previousSample) const noexcept;
 	void movingAverageFilter(const float* input, float* output, int numSamples);
 
 	float getLevel() const { return triggerLevel; }
@@ -5,7 +5,7 @@ static float maxDB = 24.0f;
 
 //==============================================================================
 OscilloscopeAudioProcessorEditor::OscilloscopeAudioProcessorEditor(OscilloscopeAudioProcessor& p)
-    : AudioProcessorEditor(&p), audioProcessor(p), timeVisualizer(p), frequencyVisualizer(p)
+    : AudioProcessorEditor(&p), audioProcessor(p), timeVisualizer(p), frequencyVisualizer(p), xyVisualizer(p)
 {
     tooltipWindow->setMillisecondsBeforeTipAppears(1000);
  
@@ -35,12 +35,12 @@ OscilloscopeAudioProcessorEditor::OscilloscopeAudioProcessorEditor(OscilloscopeA
 
     plotGroup.addChildComponent(timeVisualizer);
     plotGroup.addChildComponent(frequencyVisualizer);
-    timeVisualizer.setVisible(!isFrequencyMode);
-    frequencyVisualizer.setVisible(isFrequencyMode);
+    plotGroup.addChildComponent(xyVisualizer);
+    updateVisibleView();
     addAndMakeVisible(plotGroup);
 
     // Initialize DC mode
-    bool initialDC = audioProcessor.params.modeValue == 1;
+    bool initialDC = audioProcessor.params.isDCMode();
     timeVisualizer.setModeDC(initialDC);
 
     optionsGroup.setText("Controls");
@@ -167,7 +167,7 @@ OscilloscopeAudioProcessorEditor::OscilloscopeAudioProcessorEditor(OscilloscopeA
             audioProcessor.getSerialDevice().setCalibrationMode(isOn ? 1 : 0);
         };
 
-    bool isDC = audioProcessor.params.modeValue == 1;
+    bool isDC = audioProcessor.params.isDCMode();
     levelCalibrationButton.setButtonText(isDC ? "Calibrate DC" : "Calibrate AC");
     levelCalibrationButton.setClickingTogglesState(true);
     levelCalibrationButton.setColour(juce::ToggleButton::ColourIds::tickColourId, juce::Colours::transparentBlack);
@@ -189,8 +189,16 @@ OscilloscopeAudioProcessorEditor::OscilloscopeAudioProcessorEditor(OscilloscopeA
     sineButton.setLookAndFeel(ButtonLookAndFeel::get());
     addAndMakeVisible(sineButton);
 
+    sineButton.setTooltip("Calibration signal (right-click for waveform and frequency)");
     sineButton.onClick = [this]()
         {
+            if (juce::ModifierKeys::currentModifiers.isPopupMenu())
+            {
+                sineButton.setToggleState(!sineButton.getToggleState(), juce::dontSendNotification);
+                showGeneratorMenu();
+                return;
+            }
+
             audioProcessor.setSineEnabled(sineButton.getToggleState());
         };
 
@@ -210,6 +218,87 @@ OscilloscopeAudioProcessorEditor::OscilloscopeAudioProcessorEditor(OscilloscopeA
     addAndMakeVisible(clearSnapshotsButton);
     clearSnapshotsButton.onClick = [this] { timeVisualizer.clearSnapshots(); };
    
+    // Segmented acquisition: Single arms one segment, Seq fills the whole pool
+    singleShotButton.setTooltip("Capture a single triggered segment");
+    singleShotButton.onClick = [this]
+        {
+            audioProcessor.getSegmentedCapture().arm(1);
+            timeVisualizer.showSegment(0);
+        };
+    sequenceButton.setTooltip("Capture up to " + juce::String(SegmentedCapture::maxSegmentCount) + " triggered segments");
+    sequenceButton.onClick = [this]
+        {
+            audioProcessor.getSegmentedCapture().arm(SegmentedCapture::maxSegmentCount);
+            timeVisualizer.showSegment(0);
+        };
+    previousSegmentButton.onClick = [this] { timeVisualizer.stepSegment(-1); };
+    nextSegmentButton.onClick = [this] { timeVisualizer.stepSegment(1); };
+    overlaySegmentsButton.setTooltip("Overlay every captured segment");
+    overlaySegmentsButton.setClickingTogglesState(true);
+    overlaySegmentsButton.onClick = [this] { timeVisualizer.setSegmentOverlay(overlaySegmentsButton.getToggleState()); };
+
+    equivalentTimeButton.setTooltip("Equivalent-time display for repetitive signals");
+    equivalentTimeButton.setClickingTogglesState(true);
+    equivalentTimeButton.onClick = [this] { timeVisualizer.setEquivalentTime(equivalentTimeButton.getToggleState()); };
+
+    persistenceButton.setTooltip("Digital phosphor display with intensity grading");
+    persistenceButton.setClickingTogglesState(true);
+    persistenceButton.onClick = [this]
+        {
+            timeVisualizer.setPersistence(persistenceButton.getToggleState());
+            xyVisualizer.setPersistence(persistenceButton.getToggleState());
+        };
+
+    statsButton.setTooltip("Show capture rate and timing counters, and profile processBlock per stage");
+    statsButton.setClickingTogglesState(true);
+    statsButton.onClick = [this]
+        {
+            // The stage profiler only runs while the counters are shown; its summary goes to the log when hidden
+            auto& profiler = audioProcessor.getBlockProfiler();
+            if (!statsButton.getToggleState() && profiler.isEnabled())
+                juce::Logger::writeToLog(profiler.createReport());
+
+            profiler.setEnabled(statsButton.getToggleState());
+            timeVisualizer.setShowStats(statsButton.getToggleState());
+            frequencyVisualizer.setShowStats(statsButton.getToggleState());
+            xyVisualizer.setShowStats(statsButton.getToggleState());
+        };
+
+    xyButton.setTooltip("Plot channel 2 against channel 1 (Lissajous)");
+    xyButton.setClickingTogglesState(true);
+    xyButton.onClick = [this] { updateVisibleView(); };
+
+    recordButton.setTooltip("Record the inputs to disk (" + CaptureRecorder::getDefaultFolder().getFullPathName() + ")");
+    recordButton.onClick = [this] { toggleRecording(); };
+    recordButton.setToggleState(audioProcessor.getCaptureRecorder().isRecording(), juce::dontSendNotification);
+
+    deepCaptureButton.setTooltip("Keep a deep capture history in a memory-mapped file (costs disk, not RAM)");
+    deepCaptureButton.onClick = [this] { showDeepCaptureMenu(); };
+    deepCaptureButton.setToggleState(audioProcessor.getDeepCaptureSeconds() > 0.0, juce::dontSendNotification);
+
+    playbackButton.setTooltip("Play back a recorded capture in place of the inputs, or measure a whole recording offline");
+    playbackButton.onClick = [this] { showPlaybackMenu(); };
+    playbackButton.setToggleState(audioProcessor.getRecordingPlayer().isPlaying(), juce::dontSendNotification);
+
+    findButton.setTooltip("Search the whole capture history for edges, glitches, out-of-window levels or frequency excursions");
+    findButton.onClick = [this] { showSearchMenu(); };
+    previousHitButton.setTooltip("Previous search hit");
+    previousHitButton.onClick = [this] { timeVisualizer.stepSearchHit(-1); };
+    nextHitButton.setTooltip("Next search hit");
+    nextHitButton.onClick = [this] { timeVisualizer.stepSearchHit(1); };
+
+    maskButton.setTooltip("Test every triggered acquisition against a mask around a reference and count pass / fail");
+    maskButton.onClick = [this] { showMaskMenu(); };
+    maskButton.setToggleState(audioProcessor.getMaskTester().isActive(), juce::dontSendNotification);
+
+    for (auto* button : { &singleShotButton, &sequenceButton, &previousSegmentButton, &nextSegmentButton, &overlaySegmentsButton,
+                          &equivalentTimeButton, &persistenceButton, &statsButton, &xyButton, &recordButton, &deepCaptureButton,
+                          &playbackButton, &findButton, &previousHitButton, &nextHitButton, &maskButton })
+    {
+        button->setLookAndFeel(ButtonLookAndFeel::get());
+        addAndMakeVisible(button);
+    }
+
     screenShotGroup.setText("ScreenShot");
     screenShotGroup.setTextLabelPosition(juce::Justification::centredTop);
     screenShotGroup.addAndMakeVisible(snapshotButton);
@@ -274,6 +363,11 @@ OscilloscopeAudioProcessorEditor::~OscilloscopeAudioProcessorEditor()
     snapshotButton.setLookAndFeel(nullptr);
     clearSnapshotsButton.setLookAndFeel(nullptr);
 
+    for (auto* button : { &singleShotButton, &sequenceButton, &previousSegmentButton, &nextSegmentButton, &overlaySegmentsButton,
+                          &equivalentTimeButton, &persistenceButton, &statsButton, &xyButton, &recordButton, &deepCaptureButton,
+                          &playbackButton, &findButton, &previousHitButton, &nextHitButton, &maskButton })
+        button->setLookAndFeel(nullptr);
+
     audioProcessor.apvts.removeParameterListener(rangeParamID.getParamID(), this);
     audioProcessor.apvts.removeParameterListener(modeParamID.getParamID(), this);
     audioProcessor.apvts.removeParameterListener(plotModeParamID.getParamID(), this);
@@ -335,9 +429,28 @@ void OscilloscopeAudioProcessorEditor::resized()
     // Position the button Time/Frecuency
     plotModeButton.setTopLeftPosition(25, getHeight() - 42);
 
+    // Segment browser next to the plot mode button
+    singleShotButton.setBounds(plotModeButton.getRight() + space, plotModeButton.getY(), 50, plotModeButton.getHeight());
+    sequenceButton.setBounds(singleShotButton.getRight() + space / 2, singleShotButton.getY(), 40, singleShotButton.getHeight());
+    previousSegmentButton.setBounds(sequenceButton.getRight() + space / 2, singleShotButton.getY(), 24, singleShotButton.getHeight());
+    nextSegmentButton.setBounds(previousSegmentButton.getRight() + space / 2, singleShotButton.getY(), 24, singleShotButton.getHeight());
+    overlaySegmentsButton.setBounds(nextSegmentButton.getRight() + space / 2, singleShotButton.getY(), 36, singleShotButton.getHeight());
+    equivalentTimeButton.setBounds(overlaySegmentsButton.getRight() + space, singleShotButton.getY(), 36, singleShotButton.getHeight());
+    persistenceButton.setBounds(equivalentTimeButton.getRight() + space / 2, singleShotButton.getY(), 56, singleShotButton.getHeight());
+    statsButton.setBounds(persistenceButton.getRight() + space, singleShotButton.getY(), 46, singleShotButton.getHeight());
+    xyButton.setBounds(statsButton.getRight() + space, singleShotButton.getY(), 36, singleShotButton.getHeight());
+    recordButton.setBounds(xyButton.getRight() + space, singleShotButton.getY(), 40, singleShotButton.getHeight());
+    deepCaptureButton.setBounds(recordButton.getRight() + space / 2, singleShotButton.getY(), 44, singleShotButton.getHeight());
+    playbackButton.setBounds(deepCaptureButton.getRight() + space / 2, singleShotButton.getY(), 40, singleShotButton.getHeight());
+    findButton.setBounds(playbackButton.getRight() + space, singleShotButton.getY(), 40, singleShotButton.getHeight());
+    previousHitButton.setBounds(findButton.getRight() + space / 2, singleShotButton.getY(), 24, singleShotButton.getHeight());
+    nextHitButton.setBounds(previousHitButton.getRight() + space / 2, singleShotButton.getY(), 24, singleShotButton.getHeight());
+    maskButton.setBounds(nextHitButton.getRight() + space, singleShotButton.getY(), 44, singleShotButton.getHeight());
+
     // Position the time visualizer
     frequencyVisualizer.setBounds(plotGroup.getLocalBounds());
     timeVisualizer.setBounds(plotGroup.getLocalBounds());
+    xyVisualizer.setBounds(plotGroup.getLocalBounds());
 
     //Position the COM Port List
     serialPortSelector.setBounds(25, 12, 180, 24);
@@ -379,9 +492,8 @@ void OscilloscopeAudioProcessorEditor::parameterChanged(const juce::String& para
 {
     if (parameterID == plotModeParamID.getParamID())
     {
-        bool isFrequencyMode = newValue > 0.5f; // 0=Time, 1=Frequency
-        timeVisualizer.setVisible(!isFrequencyMode);
-        frequencyVisualizer.setVisible(isFrequencyMode);
+        isFrequencyMode = newValue > 0.5f; // 0=Time, 1=Frequency
+        updateVisibleView();
         plotModeButton.setButtonText(isFrequencyMode ? "Frequency" : "Time");
     }
 
@@ -410,7 +522,7 @@ void OscilloscopeAudioProcessorEditor::parameterChanged(const juce::String& para
     else if (parameterID == verticalScaleParamID.getParamID())
     {
         int index = static_cast<int>(newValue);
-        int currentRange = audioProcessor.params.rangeValue;
+        int currentRange = audioProcessor.params.getRangeIndex();
         float scaleV = verticalScaleByRange[currentRange][index].second;
 
         timeVisualizer.setVerticalGain(1.0f / scaleV); 
@@ -465,6 +577,379 @@ void OscilloscopeAudioProcessorEditor::timerCallback()
         parameterChanged(rangeParamID.getParamID(), rangeParam->load());
 }
 
+void OscilloscopeAudioProcessorEditor::updateVisibleView()
+{
+    // XY replaces whichever of the time or frequency views the plot mode selects
+    const bool xy = xyButton.getToggleState();
+    timeVisualizer.setVisible(!xy && !isFrequencyMode);
+    frequencyVisualizer.setVisible(!xy && isFrequencyMode);
+    xyVisualizer.setVisible(xy);
+}
+
+void OscilloscopeAudioProcessorEditor::showGeneratorMenu()
+{
+    auto& generator = audioProcessor.getSignalGenerator();
+    const float frequencies[] = { 50.0f, 100.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f };
+    const SignalGenerator::Waveform waveforms[] = { SignalGenerator::Waveform::sine, SignalGenerator::Waveform::square,
+                                                    SignalGenerator::Waveform::multitone };
+    const SignalGenerator::Waveform stimuli[] = { SignalGenerator::Waveform::logSweep, SignalGenerator::Waveform::multitoneStimulus };
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Waveform");
+    for (auto waveform : waveforms)
+        menu.addItem(SignalGenerator::getName(waveform), true, generator.getWaveform() == waveform,
+                     [&generator, waveform] { generator.setWaveform(waveform); });
+
+    menu.addSectionHeader("Response measurement");
+    for (auto waveform : stimuli)
+        menu.addItem(SignalGenerator::getName(waveform), true, generator.getWaveform() == waveform,
+                     [&generator, waveform] { generator.setWaveform(waveform); });
+
+    menu.addSectionHeader("Frequency");
+    const bool fixedFrequency = !SignalGenerator::isStimulus(generator.getWaveform());
+    for (auto frequency : frequencies)
+        menu.addItem(frequency >= 1000.0f ? juce::String(frequency / 1000.0f, 0) + " kHz" : juce::String((int)frequency) + " Hz",
+                     fixedFrequency, generator.getFrequency() == frequency,
+                     [&generator, frequency] { generator.setFrequency(frequency); });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&sineButton));
+}
+
+void OscilloscopeAudioProcessorEditor::toggleRecording()
+{
+    auto& recorder = audioProcessor.getCaptureRecorder();
+
+    // A click while recording stops it; otherwise the format is picked from a menu
+    if (recorder.isRecording())
+    {
+        recorder.stop();
+        recordButton.setToggleState(false, juce::dontSendNotification);
+        return;
+    }
+
+    // Still lit but no longer recording: it stopped on its own (a write error, or the audio
+    // device came back with another rate or channel count), so say why first
+    if (recordButton.getToggleState())
+    {
+        recordButton.setToggleState(false, juce::dontSendNotification);
+
+        const auto error = recorder.getStatus().error;
+        if (error.isNotEmpty())
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Recording",
+                                                   "The recording stopped: " + error);
+            return;
+        }
+    }
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Record inputs to disk");
+
+    for (auto format : { CaptureRecorder::Format::wav, CaptureRecorder::Format::flac, CaptureRecorder::Format::raw })
+    {
+        menu.addItem(CaptureRecorder::getName(format), [this, &recorder, format]
+            {
+                const bool started = recorder.start(CaptureRecorder::getDefaultFolder(), format);
+                recordButton.setToggleState(started, juce::dontSendNotification);
+
+                if (!started)
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Recording",
+                                                           recorder.getStatus().error);
+            });
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&recordButton));
+}
+
+void OscilloscopeAudioProcessorEditor::showDeepCaptureMenu()
+{
+    const std::pair<const char*, double> depths[] = {
+        { "Off", 0.0 }, { "1 min", 60.0 }, { "10 min", 600.0 }, { "1 hour", 3600.0 }, { "4 hours", 14400.0 }
+    };
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Capture history depth");
+
+    for (const auto& [name, seconds] : depths)
+    {
+        menu.addItem(name, true, audioProcessor.getDeepCaptureSeconds() == seconds, [this, seconds]
+            {
+                if (!audioProcessor.setDeepCaptureSeconds(seconds))
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Capture history",
+                                                           "Could not map a history file of that size");
+
+                deepCaptureButton.setToggleState(audioProcessor.getDeepCapture().isActive(), juce::dontSendNotification);
+            });
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&deepCaptureButton));
+}
+
+void OscilloscopeAudioProcessorEditor::showPlaybackMenu()
+{
+    auto& player = audioProcessor.getRecordingPlayer();
+    auto& analyzer = audioProcessor.getRecordingAnalyzer();
+    const int speeds[] = { 1, 2, 4, 8, 16, 32, RecordingPlayer::maxSpeed };
+
+    auto updateButton = [this] { playbackButton.setToggleState(audioProcessor.getRecordingPlayer().isPlaying(), juce::dontSendNotification); };
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader(player.isLoaded() ? player.getFile().getFileName() : juce::String("Recording playback"));
+
+    menu.addItem("Open recording...", [this, &player, updateButton]
+        {
+            chooseRecording("Play back a recording", [this, &player, updateButton](const juce::File& file)
+                {
+                    const auto result = player.open(file, audioProcessor.getSampleRate());
+
+                    if (result.failed())
+                        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Playback", result.getErrorMessage());
+                    else
+                        player.setPlaying(true);
+
+                    updateButton();
+                });
+        });
+
+    if (player.isLoaded())
+    {
+        menu.addItem(player.isPlaying() ? "Pause" : "Play", [&player, updateButton]
+            {
+                // Playing again after the end starts over
+                if (!player.isPlaying() && player.getPositionInSeconds() >= player.getLengthInSeconds())
+                    player.setPosition(0);
+
+                player.setPlaying(!player.isPlaying());
+                updateButton();
+            });
+
+        menu.addItem("Restart", [&player, updateButton] { player.setPosition(0); player.setPlaying(true); updateButton(); });
+
+        juce::PopupMenu speedMenu;
+        for (const int speed : speeds)
+            speedMenu.addItem(juce::String(speed) + "x", true, player.getSpeed() == speed, [&player, speed] { player.setSpeed(speed); });
+
+        menu.addSubMenu("Speed", speedMenu);
+        menu.addItem("Close recording", [&player, updateButton] { player.close(); updateButton(); });
+    }
+
+    menu.addSeparator();
+
+    if (analyzer.isRunning())
+        menu.addItem("Cancel analysis (" + juce::String(juce::roundToInt(analyzer.getProgress() * 100.0f)) + " %)", [&analyzer] { analyzer.cancel(); });
+    else
+        menu.addItem("Analyse a whole recording...", [this]
+            {
+                chooseRecording("Analyse a recording", [this](const juce::File& file) { analyseRecording(file); });
+            });
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&playbackButton));
+}
+
+void OscilloscopeAudioProcessorEditor::chooseRecording(const juce::String& title, std::function<void(const juce::File&)> onChosen)
+{
+    recordingChooser = std::make_unique<juce::FileChooser>(title, CaptureRecorder::getDefaultFolder(), RecordingFile::fileWildcard);
+
+    recordingChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                  [onChosen](const juce::FileChooser& chooser)
+                                  {
+                                      if (chooser.getResult() != juce::File())
+                                          onChosen(chooser.getResult());
+                                  });
+}
+
+void OscilloscopeAudioProcessorEditor::analyseRecording(const juce::File& file)
+{
+    // Measured the way the time view measures: the trigger channel, level and calibration
+    RecordingAnalyzer::Settings settings;
+    settings.channel = audioProcessor.isMathChannel(audioProcessor.getTriggerChannel()) ? 0 : audioProcessor.getTriggerChannel();
+    settings.triggerLevel = audioProcessor.getTriggerLevelInSignalDomain();
+    settings.calibrationFactor = audioProcessor.getCalibrationFactor();
+
+    juce::Component::SafePointer<OscilloscopeAudioProcessorEditor> safeThis(this);
+
+    const auto result = audioProcessor.getRecordingAnalyzer().start(file, settings, [safeThis]
+        {
+            if (safeThis == nullptr)
+                return;
+
+            const auto& analyzer = safeThis->audioProcessor.getRecordingAnalyzer();
+            const auto summary = analyzer.getSummary();
+            const auto report = RecordingAnalyzer::getDefaultReportFile(analyzer.getFile());
+            const bool written = analyzer.writeCsv(report);
+
+            juce::String message;
+            message << juce::String(summary.durationSeconds / 60.0, 1) << " min analysed in " << juce::String(summary.wallSeconds, 2)
+                    << " s (" << juce::String(summary.durationSeconds / juce::jmax(1.0e-3, summary.wallSeconds), 0) << "x real time)\n"
+                    << "Min " << juce::String(summary.min, 4) << ", max " << juce::String(summary.max, 4)
+                    << ", RMS " << juce::String(summary.rms, 4) << ", " << juce::String(summary.triggers) << " triggers\n"
+                    << (written ? "Per-segment report: " + report.getFullPathName() : "Could not write " + report.getFullPathName());
+
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Recording analysis", message);
+        });
+
+    if (result.failed())
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Recording analysis", result.getErrorMessage());
+}
+
+void OscilloscopeAudioProcessorEditor::showSearchMenu()
+{
+    auto& search = audioProcessor.getEventSearch();
+
+    // Searches run on the trigger channel, at the trigger level and around the frequency
+    // the time view measures now
+    EventSearch::Query base;
+    base.channel = audioProcessor.getTriggerChannel();
+    base.level = audioProcessor.getTriggerLevelInSignalDomain();
+
+    const float measuredFrequency = timeVisualizer.currentFrame.valid ? timeVisualizer.currentFrame.frequency : 0.0f;
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Search the capture history (" + audioProcessor.getChannelName(base.channel) + ")");
+
+    if (search.isRunning())
+    {
+        menu.addItem("Cancel search (" + juce::String(juce::roundToInt(search.getProgress() * 100.0f)) + " %)", [this, &search]
+            {
+                search.cancel();
+                timeVisualizer.showSearchHit(-1);
+            });
+        menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&findButton));
+        return;
+    }
+
+    auto withCondition = [base](EventSearch::Condition condition)
+    {
+        auto query = base;
+        query.condition = condition;
+        return query;
+    };
+
+    menu.addItem("Rising edges", [this, query = withCondition(EventSearch::Condition::risingEdge)] { startSearch(query); });
+    menu.addItem("Falling edges", [this, query = withCondition(EventSearch::Condition::fallingEdge)] { startSearch(query); });
+
+    juce::PopupMenu glitchMenu;
+    for (const double width : { 10.0e-6, 100.0e-6, 1.0e-3 })
+    {
+        auto query = withCondition(EventSearch::Condition::glitch);
+        query.maxWidthSeconds = width;
+        glitchMenu.addItem("Narrower than " + (width < 1.0e-3 ? juce::String(width * 1.0e6, 0) + " us" : juce::String(width * 1.0e3, 0) + " ms"),
+                           [this, query] { startSearch(query); });
+    }
+    menu.addSubMenu("Glitches", glitchMenu);
+
+    {
+        auto query = withCondition(EventSearch::Condition::outsideWindow);
+        query.upper = std::abs(base.level);
+        query.lower = -query.upper;
+        menu.addItem("Beyond +/- trigger level", query.upper > 0.0f, false, [this, query] { startSearch(query); });
+    }
+
+    juce::PopupMenu frequencyMenu;
+    for (const float tolerance : { 0.05f, 0.2f })
+    {
+        auto query = withCondition(EventSearch::Condition::frequencyExcursion);
+        query.minFrequency = measuredFrequency * (1.0f - tolerance);
+        query.maxFrequency = measuredFrequency * (1.0f + tolerance);
+        frequencyMenu.addItem("More than " + juce::String(juce::roundToInt(tolerance * 100.0f)) + " % off " + juce::String(measuredFrequency, 1) + " Hz",
+                              measuredFrequency > 0.0f, false, [this, query] { startSearch(query); });
+    }
+    menu.addSubMenu("Frequency excursions", frequencyMenu);
+
+    if (!search.getHits().empty())
+    {
+        menu.addSeparator();
+        menu.addItem("Clear search", [this, &search]
+            {
+                search.clear();
+                timeVisualizer.showSearchHit(-1);
+            });
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&findButton));
+}
+
+void OscilloscopeAudioProcessorEditor::startSearch(const EventSearch::Query& query)
+{
+    juce::Component::SafePointer<OscilloscopeAudioProcessorEditor> safeThis(this);
+    timeVisualizer.showSearchHit(-1);
+
+    const auto result = audioProcessor.getEventSearch().start(audioProcessor.getCaptureHistory(), audioProcessor.getSampleRate(), query, [safeThis]
+        {
+            if (safeThis == nullptr)
+                return;
+
+            const auto& search = safeThis->audioProcessor.getEventSearch();
+
+            if (search.getHits().empty())
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Search",
+                                                       "No hits: " + EventSearch::describe(search.getQuery()));
+                return;
+            }
+
+            // Newest hit first, the one most likely to be on screen a moment ago
+            safeThis->timeVisualizer.showSearchHit((int)search.getHits().size() - 1);
+        });
+
+    if (result.failed())
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Search", result.getErrorMessage());
+}
+
+void OscilloscopeAudioProcessorEditor::showMaskMenu()
+{
+    auto& tester = audioProcessor.getMaskTester();
+    const auto& store = audioProcessor.getReferenceStore();
+    const float tolerances[] = { 0.1f, 0.25f, 0.5f };  // divisions
+
+    auto updateButton = [this] { maskButton.setToggleState(audioProcessor.getMaskTester().isActive(), juce::dontSendNotification); };
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Mask test (" + audioProcessor.getChannelName(0) + ")");
+
+    // The mask goes around the newest reference, as it sits on screen with the current
+    // time base, trigger and scale
+    const bool haveReference = store.size() > 0 && store.get(store.size() - 1).isDC == 0;
+    juce::PopupMenu referenceMenu;
+
+    for (const float tolerance : tolerances)
+    {
+        referenceMenu.addItem("+/- " + juce::String(tolerance, 2) + " div", [this, tolerance, updateButton]
+            {
+                constexpr float horizontalTolerance = 0.05f;   // divisions of edge jitter allowed
+
+                const auto& references = audioProcessor.getReferenceStore();
+                if (references.size() == 0)
+                    return;
+
+                const auto polygon = MaskTester::polygonAroundReference(references.get(references.size() - 1), tolerance, horizontalTolerance);
+                const auto result = audioProcessor.getMaskTester().start(polygon, timeVisualizer.getMaskGeometry());
+
+                if (result.failed())
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Mask test", result.getErrorMessage());
+
+                updateButton();
+                timeVisualizer.repaint();
+            });
+    }
+
+    menu.addSubMenu(haveReference ? "Around the latest reference" : "Around the latest reference (Print one first)", referenceMenu, haveReference);
+
+    if (tester.isActive())
+    {
+        menu.addSeparator();
+        menu.addItem("Reset counts", [this, &tester] { tester.resetCounts(); timeVisualizer.repaint(); });
+        menu.addItem("Stop mask test", [this, &tester, updateButton]
+            {
+                tester.stop();
+                updateButton();
+                timeVisualizer.repaint();
+            });
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&maskButton));
+}
+
 void OscilloscopeAudioProcessorEditor::actualizarKnobsDesdeESP(uint8_t modo, uint8_t rango)
 {
     pluginIsInControl = false;
@@ -7,6 +7,7 @@
 
 #include "UI/TimeVisualizer.h"
 #include "UI/FrequencyVisualizer.h"
+#include "UI/XYVisualizer.h"
 #include "UI/RotaryKnob.h"
 #include "UI/LookAndFeel.h"
 
@@ -30,6 +31,7 @@ private:
 
     TimeVisualizer timeVisualizer;
     FrequencyVisualizer frequencyVisualizer;
+    XYVisualizer xyVisualizer;
     juce::TextButton probesCalibrationButton{ "Probes" };
     bool isCalibrating = false;
 
@@ -62,6 +64,16 @@ private:
     bool pluginIsInControl = true;
 
     void timerCallback() override;
+    void showGeneratorMenu();
+    void toggleRecording();
+    void showDeepCaptureMenu();
+    void showPlaybackMenu();
+    void chooseRecording(const juce::String& title, std::function<void(const juce::File&)> onChosen);
+    void analyseRecording(const juce::File& file);
+    void showSearchMenu();
+    void startSearch(const EventSearch::Query& query);
+    void showMaskMenu();
+    void updateVisibleView();
     juce::ComboBox serialPortSelector;
     juce::Label serialPortLabel;
 
@@ -77,5 +89,24 @@ private:
     juce::TextButton snapshotButton{ "Print" };
     juce::TextButton clearSnapshotsButton{ "Clear" };
 
+    juce::TextButton singleShotButton{ "Single" };
+    juce::TextButton sequenceButton{ "Seq" };
+    juce::TextButton previousSegmentButton{ "<" };
+    juce::TextButton nextSegmentButton{ ">" };
+    juce::TextButton overlaySegmentsButton{ "All" };
+
+    juce::TextButton equivalentTimeButton{ "ET" };
+    juce::TextButton persistenceButton{ "Persist" };
+    juce::TextButton statsButton{ "Stats" };
+    juce::TextButton xyButton{ "XY" };
+    juce::TextButton recordButton{ "Rec" };
+    juce::TextButton deepCaptureButton{ "Deep" };
+    juce::TextButton playbackButton{ "Play" };
+    std::unique_ptr<juce::FileChooser> recordingChooser;
+    juce::TextButton findButton{ "Find" };
+    juce::TextButton previousHitButton{ "<" };
+    juce::TextButton nextHitButton{ ">" };
+    juce::TextButton maskButton{ "Mask" };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscilloscopeAudioProcessorEditor)
 };
\ No newline at end of file
@@ -10,7 +10,7 @@ OscilloscopeAudioProcessor::OscilloscopeAudioProcessor()
                        ),
     params(apvts) 
 {
-
+    openReferenceStore(juce::Uuid().toString());
 }
 
 OscilloscopeAudioProcessor::~OscilloscopeAudioProcessor()
@@ -85,20 +85,47 @@ void OscilloscopeAudioProcessor::prepareToPlay(double sampleRate, int samplesPer
 {
     const int bufferSeconds = 10; // full capacity (10 s)
     const int bufferSize = static_cast<int>(sampleRate * bufferSeconds);
-    circularBuffer.prepare(getTotalNumInputChannels(), bufferSize);
+    const int numInputs = juce::jlimit(1, ChannelSettings::maxInputChannels, getTotalNumInputChannels());
+    const int numCaptureChannels = numInputs + MathChannels::maxChannels;
+    numInputChannels = numInputs;
+
+    // The history restarts, and with it the sample indices of any search hits
+    eventSearch.clear();
+
+    // Math channels are computed into their own planes and captured after the inputs
+    mathChannels.prepare(sampleRate, samplesPerBlock);
+    mathBuffer.setSize(MathChannels::maxChannels, juce::jmax(1, samplesPerBlock), false, true, false);
+
+    circularBuffer.prepare(numCaptureChannels, bufferSize);
+    deepCapture.prepare(sampleRate, deepCaptureSeconds, DeepCaptureBuffer::getDefaultFile());
+    segmentedCapture.prepare(numInputs, SegmentedCapture::defaultSegmentLength,
+                             SegmentedCapture::maxSegmentCount, sampleRate);
+    maskTester.prepare();
+    captureRecorder.prepare(sampleRate, numInputs);
 
+    // A loaded recording only plays at the rate it was captured at
+    if (recordingPlayer.isLoaded() && recordingPlayer.getSampleRate() != sampleRate)
+        recordingPlayer.close();
 
-    frequencyAnalyzer.setUpFrequencyAnalyzer(int(sampleRate), sampleRate);
+    equivalentTimeSampler.prepare(sampleRate);
+    performanceCounters.prepare(sampleRate, samplesPerBlock);
+    blockProfiler.prepare(sampleRate);
 
-    // phase increment to 1 kHz
-    phase = 0.0;
-    phaseIncrement = juce::MathConstants<double>::twoPi * 1000.0 / sampleRate;
+
+    frequencyAnalyzer.setUpFrequencyAnalyzer(int(sampleRate), sampleRate, true, numCaptureChannels);
+
+    signalGenerator.prepare(sampleRate);
+    responseAnalyzer.prepare(sampleRate, signalGenerator);
 
 }
 
 void OscilloscopeAudioProcessor::releaseResources()
 {
     frequencyAnalyzer.stopThread(1000);
+    responseAnalyzer.stopThread(1000);
+    eventSearch.clear();
+    deepCapture.release();
+    recordingAnalyzer.cancel();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -107,61 +134,154 @@ bool OscilloscopeAudioProcessor::isBusesLayoutSupported(const BusesLayout& layou
     const auto& mainIn = layouts.getChannelSet(true, 0); // Input
     const auto& mainOut = layouts.getChannelSet(false, 0); // Output
 
-    return mainIn == juce::AudioChannelSet::stereo()
-        && mainOut == juce::AudioChannelSet::stereo();
+    // Stereo by default; any discrete layout up to ChannelSettings::maxInputChannels is
+    // captured channel by channel. The output mirrors the input (the calibration generator).
+    const int numChannels = mainIn.size();
+
+    return numChannels >= 2 && numChannels <= ChannelSettings::maxInputChannels
+        && mainOut.size() == numChannels;
 }
 #endif
 
 void OscilloscopeAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, 
                               [[maybe_unused]] juce::MidiBuffer& midiMessages)
 {
-    params.update();
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
+    blockProfiler.beginBlock(buffer.getNumSamples());
+
+    {
+        ScopedStage stage(blockProfiler, BlockProfiler::parameters);
+        params.update();
+    }
 
     juce::ScopedNoDenormals noDenormals;
     juce::ignoreUnused(midiMessages);
 
-    static bool lastFrequencyMode = false;
-    bool currentFrequencyMode = apvts.getRawParameterValue(plotModeParamID.getParamID())->load() > 0.5f;
+    // A recording being played back replaces the inputs. Above 1x further blocks of it go
+    // through the capture path per host block, so every view scans it faster than real time:
+    // only as many as fit playbackBudget of the block's duration, judged by the pass before,
+    // and only blocks read-ahead has already faulted in.
+    int passes = 0;
+    const auto budgetTicks = static_cast<juce::int64>(playbackBudget * buffer.getNumSamples() / juce::jmax(1.0, getSampleRate())
+                                                      * (double)juce::Time::getHighResolutionTicksPerSecond());
+    juce::int64 passTicks = 0;
 
-    auto numOutputChannels = getTotalNumOutputChannels();
-    auto numInputChannels = getTotalNumInputChannels();
+    while (passes < recordingPlayer.getSpeed())
+    {
+        const auto passStartTicks = juce::Time::getHighResolutionTicks();
+        if (passes > 0 && passStartTicks - blockStartTicks + passTicks > budgetTicks)
+            break;
 
-    bool isFrequencyMode = apvts.getRawParameterValue(plotModeParamID.getParamID())->load() > 0.5f;
-        
-    if (isFrequencyMode) {
-        frequencyAnalyzer.addAudioData(buffer, 0, numOutputChannels);
-    }
-    else {
-        circularBuffer.pushBlock(buffer);
+        if (!recordingPlayer.render(buffer, numInputChannels.load(), passes > 0))
+            break;
+
+        captureBlock(buffer);
+        passTicks = juce::Time::getHighResolutionTicks() - passStartTicks;
+        ++passes;
     }
 
-    if (sineEnabled)
-    {
-        auto numSamples = buffer.getNumSamples();
-        auto numChannels = buffer.getNumChannels();
+    if (passes == 0)
+        captureBlock(buffer);
+    else
+        playbackPasses = passes;
 
-        float amplitude = (params.modeValue == 1) ? 2*0.412f : 0.4205f; // 800 mVpp DC, 400 mVpp AC balanced
+    {
+        ScopedStage stage(blockProfiler, BlockProfiler::generator);
 
-        for (int channel = 0; channel < numChannels; ++channel)
+        if (sineEnabled)
         {
-            float* channelData = buffer.getWritePointer(channel);
+            float amplitude = params.isDCMode() ? 2*0.412f : 0.4205f; // 800 mVpp DC, 400 mVpp AC balanced
 
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float sample = std::sin(phase) * amplitude;
-                channelData[i] = sample;
-                phase += phaseIncrement;
+            // The input is the stimulus coming back through the probe; capture it before it is overwritten
+            const auto waveform = signalGenerator.getActiveWaveform();
+            if (SignalGenerator::isStimulus(waveform) && buffer.getNumChannels() > 0)
+                responseAnalyzer.pushInput(buffer.getReadPointer(0), buffer.getNumSamples(), waveform,
+                                           signalGenerator.getStimulusPosition(), amplitude);
 
-                if (phase >= juce::MathConstants<double>::twoPi)
-                    phase -= juce::MathConstants<double>::twoPi;
-            }
+            signalGenerator.render(buffer, amplitude);
+        }
+        else
+        {
+            buffer.clear(); 
         }
     }
-    else
+
+    const auto blockTicks = juce::Time::getHighResolutionTicks() - blockStartTicks;
+    performanceCounters.addProcessBlockTime(blockTicks, buffer.getNumSamples());
+    blockProfiler.endBlock(blockTicks);
+}
+
+// Everything the scope does with one block of input, live or played back
+void OscilloscopeAudioProcessor::captureBlock(juce::AudioBuffer<float>& buffer)
+{
+    // Fan-out: every block reaches both pipelines. The history buffer is always fed, so the
+    // time view never shows stale data; the analyser is suspended by its flag while the
+    // spectrum is hidden and restarts from fresh data when it is shown again: empty for one
+    // FFT frame, then the mean of the frames since, at full level from the first one.
+    const int numSamples = buffer.getNumSamples();
+    const int numInputs = juce::jmin(numInputChannels.load(), buffer.getNumChannels());
+    int numCaptureChannels = numInputs;
+
+    for (int c = 0; c < numInputs; ++c)
+        captureChannels[(size_t)c] = buffer.getWritePointer(c);
+
+    // Math channels are appended to the inputs in a view that owns no memory, so the
+    // history, trigger, measurements and FFT see them as ordinary channels. Their channel
+    // numbers are fixed, but a slot that is off is left out of laneMask: nothing computes,
+    // stores or analyses it. A block larger than announced in prepareToPlay only carries
+    // the inputs.
+    juce::uint32 laneMask = (1u << numInputs) - 1;
+
+    if (numInputs > 0 && numSamples <= mathBuffer.getNumSamples())
     {
-        buffer.clear(); 
+        ScopedStage stage(blockProfiler, BlockProfiler::math);
+        laneMask |= mathChannels.process(captureChannels.data(), numInputs, mathBuffer.getArrayOfWritePointers(), numSamples) << numInputs;
+
+        for (int m = 0; m < MathChannels::maxChannels; ++m)
+            captureChannels[(size_t)numCaptureChannels++] = mathBuffer.getWritePointer(m);
     }
 
+    juce::AudioBuffer<float> capture(captureChannels.data(), numCaptureChannels, numSamples);
+    frequencyAnalyzer.setActive(params.isFrequencyMode());
+
+    // Everything that triggers on the audio thread follows the trigger channel the views use;
+    // a math channel that is off carries nothing to trigger on
+    const int triggerChannel = juce::jmin(getTriggerChannel(), numCaptureChannels - 1);
+    const float* triggerData = triggerChannel >= 0 && (laneMask & (1u << triggerChannel)) != 0 && numSamples > 0
+                             ? capture.getReadPointer(triggerChannel) : nullptr;
+    const float triggerLevel = getTriggerLevelInSignalDomain();
+
+    // Trigger rate
+    if (triggerData != nullptr)
+    {
+        ScopedStage stage(blockProfiler, BlockProfiler::triggerCount);
+        edgeCounter.setParameters(triggerLevel, 0.0f, false);
+        performanceCounters.addTriggers(edgeCounter.countTriggers(triggerData, numSamples, lastInputSample));
+        lastInputSample = triggerData[numSamples - 1];
+    }
+
+    {
+        ScopedStage stage(blockProfiler, BlockProfiler::analyser);
+        frequencyAnalyzer.addAudioData(capture, 0, numCaptureChannels, laneMask);
+    }
+
+    {
+        ScopedStage stage(blockProfiler, BlockProfiler::capture);
+        circularBuffer.pushBlock(capture, laneMask);
+
+        segmentedCapture.setTriggerLevel(triggerLevel);
+        segmentedCapture.process(capture, triggerData != nullptr ? triggerChannel : -1, circularBuffer);
+        captureRecorder.push(capture, numInputs);
+
+        equivalentTimeSampler.setLevel(triggerLevel);
+        if (triggerData != nullptr)
+            equivalentTimeSampler.process(triggerData, numSamples);
+    }
+
+    {
+        ScopedStage stage(blockProfiler, BlockProfiler::mask);
+        maskTester.process(capture, circularBuffer);
+    }
 }
 
 //==============================================================================
@@ -185,6 +305,23 @@ void OscilloscopeAudioProcessor::getStateInformation(juce::MemoryBlock& destData
     state.setProperty("calibrationFactorDC", calibrationFactorDC, nullptr);
     state.setProperty("calibrationRangeAC", calibrationRangeAC, nullptr);
     state.setProperty("calibrationRangeDC", calibrationRangeDC, nullptr);
+    state.setProperty("referenceStoreId", referenceStoreId, nullptr);
+    referenceStore.setReferencedBySavedState();
+
+    state.setProperty("triggerChannel", triggerChannel.load(), nullptr);
+    state.setProperty("deepCaptureSeconds", deepCaptureSeconds, nullptr);
+
+    for (int m = 0; m < MathChannels::maxChannels; ++m)
+        state.setProperty("math" + juce::String(m) + "Expression", mathChannels.getExpression(m), nullptr);
+
+    for (int c = 0; c < ChannelSettings::maxCaptureChannels; ++c)
+    {
+        const auto& settings = channelSettings[(size_t)c];
+        const juce::String prefix = "channel" + juce::String(c);
+        state.setProperty(prefix + "Visible", settings.visible.load(), nullptr);
+        state.setProperty(prefix + "Scale", settings.scale.load(), nullptr);
+        state.setProperty(prefix + "Offset", settings.offset.load(), nullptr);
+    }
 
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
@@ -210,13 +347,90 @@ void OscilloscopeAudioProcessor::setStateInformation(const void* data, int sizeI
         if (state.hasProperty("calibrationRangeDC"))
             calibrationRangeDC = static_cast<int>(state["calibrationRangeDC"]);
 
+        if (state.hasProperty("triggerChannel"))
+            setTriggerChannel(static_cast<int>(state["triggerChannel"]));
+
+        if (state.hasProperty("deepCaptureSeconds"))
+            setDeepCaptureSeconds(static_cast<double>(state["deepCaptureSeconds"]));
+
+        for (int m = 0; m < MathChannels::maxChannels; ++m)
+        {
+            const juce::String key = "math" + juce::String(m) + "Expression";
+            if (state.hasProperty(key))
+                mathChannels.setExpression(m, state[key].toString());
+        }
+
+        for (int c = 0; c < ChannelSettings::maxCaptureChannels; ++c)
+        {
+            auto& settings = channelSettings[(size_t)c];
+            const juce::String prefix = "channel" + juce::String(c);
+
+            if (state.hasProperty(prefix + "Visible"))
+                settings.visible = static_cast<bool>(state[prefix + "Visible"]);
+
+            if (state.hasProperty(prefix + "Scale"))
+                settings.scale = static_cast<float>(state[prefix + "Scale"]);
+
+            if (state.hasProperty(prefix + "Offset"))
+                settings.offset = static_cast<float>(state[prefix + "Offset"]);
+        }
+
+        // Reattach to the references this instance stored in a previous session
+        if (state.hasProperty("referenceStoreId") && state["referenceStoreId"].toString() != referenceStoreId)
+            openReferenceStore(state["referenceStoreId"].toString(), true);
+
         apvts.replaceState(state);
     }
 }
 
-void OscilloscopeAudioProcessor::createAnalyserPlot(juce::Path& p, const juce::Rectangle<int> bounds, float dBMin, float dBMax)
+bool OscilloscopeAudioProcessor::setDeepCaptureSeconds(double seconds)
+{
+    deepCaptureSeconds = juce::jmax(0.0, seconds);
+
+    // Before prepareToPlay the depth is only remembered
+    if (getSampleRate() <= 0.0)
+        return true;
+
+    // A search must not scan the deep history while it is rebuilt
+    eventSearch.cancel();
+
+    return deepCapture.prepare(getSampleRate(), deepCaptureSeconds, DeepCaptureBuffer::getDefaultFile())
+        || deepCaptureSeconds == 0.0;
+}
+
+juce::String OscilloscopeAudioProcessor::getChannelName(int channel) const
+{
+    if (isMathChannel(channel))
+        return "Math " + juce::String(channel - getNumInputChannels() + 1);
+
+    return "Channel " + juce::String(channel + 1);
+}
+
+bool OscilloscopeAudioProcessor::isChannelShown(int channel)
+{
+    if (!getChannelSettings(channel).visible.load())
+        return false;
+
+    return !isMathChannel(channel) || mathChannels.isEnabled(channel - getNumInputChannels());
+}
+
+ChannelSettings& OscilloscopeAudioProcessor::getChannelSettings(int channel)
+{
+    // Math settings keep their slots after the largest input layout, so a saved state
+    // does not move them around when the number of inputs changes
+    const int numInputs = getNumInputChannels();
+    const int index = channel < numInputs ? channel : ChannelSettings::maxInputChannels + channel - numInputs;
+    return channelSettings[(size_t)juce::jlimit(0, ChannelSettings::maxCaptureChannels - 1, index)];
+}
+
+void OscilloscopeAudioProcessor::createAnalyserPlot(juce::Path& p, const juce::Rectangle<int> bounds, float dBMin, float dBMax, int channel)
+{
+    frequencyAnalyzer.createPath(p, bounds.toFloat(), 20.0f, dBMin, dBMax, channel);
+}
+
+void OscilloscopeAudioProcessor::createAnalyserPoints(std::vector<float>& x, std::vector<float>& y, const juce::Rectangle<int> bounds, float dBMin, float dBMax, int channel)
 {
-    frequencyAnalyzer.createPath(p, bounds.toFloat(), 20.0f, dBMin, dBMax);
+    frequencyAnalyzer.createPoints(x, y, bounds.toFloat(), 20.0f, dBMin, dBMax, channel);
 }
 
 bool OscilloscopeAudioProcessor::checkForNewAnalyserData()
@@ -226,42 +440,41 @@ bool OscilloscopeAudioProcessor::checkForNewAnalyserData()
 
 void OscilloscopeAudioProcessor::startLevelCalibration()
 {
-    juce::AudioBuffer<float> buffer;
-    circularBuffer.getMostRecentWindow(buffer, 1024);
+    // Scanned in place over the most recent 1024 samples, no window copy
+    const juce::int64 end = circularBuffer.getTotalSamplesWritten();
+    const juce::int64 start = juce::jmax(circularBuffer.getOldestSample(), end - 1024);
 
     float minVal = std::numeric_limits<float>::max();
     float maxVal = std::numeric_limits<float>::lowest();
 
-    for (int c = 0; c < buffer.getNumChannels(); ++c)
+    for (int c = 0; c < juce::jmin(circularBuffer.getNumChannels(), getNumInputChannels()) && end > start; ++c)
     {
-        const float* data = buffer.getReadPointer(c);
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-        {
-            float v = data[i];
-            minVal = std::min(minVal, v);
-            maxVal = std::max(maxVal, v);
-        }
+        const auto range = HistoryScan::findMinAndMax(circularBuffer, c, start, end - start);
+        minVal = std::min(minVal, range.getStart());
+        maxVal = std::max(maxVal, range.getEnd());
     }
 
     float measuredVpp = maxVal - minVal;
-    float expectedVpp = (params.modeValue == 1) ? 1.0f : 1.0f; // first DC, second AC
+    const bool dc = params.isDCMode();
+    float expectedVpp = dc ? 1.0f : 1.0f; // first DC, second AC
     float newFactor = expectedVpp / measuredVpp;
 
-    if (params.modeValue == 1)
+    if (dc)
         calibrationFactorDC = newFactor;
     else
         calibrationFactorAC = newFactor;
 
     // Save the range used in calibration
-    calibrationRange = params.rangeValue;
+    calibrationRange = params.getRangeIndex();
 }
 
 
 float OscilloscopeAudioProcessor::getCalibrationFactor() const
 {
-    float factorActual = rangeCompensationFactors[params.rangeValue];
+    // Live values from the parameter atomics, safe from any thread
+    float factorActual = rangeCompensationFactors[params.getRangeIndex()];
 
-    if (params.modeValue == 0) // AC
+    if (!params.isDCMode()) // AC
     {
         float factorCalibrado = rangeCompensationFactors[calibrationRangeAC];
         float factorRelativo = factorActual / factorCalibrado;
@@ -275,6 +488,13 @@ float OscilloscopeAudioProcessor::getCalibrationFactor() const
     }
 }
 
+float OscilloscopeAudioProcessor::getTriggerLevelInSignalDomain() const
+{
+    // The trigger knob is in divisions; convert to the uncalibrated input domain
+    const float volts = params.getTriggerLevel() * params.getVerticalScaleInVolts();
+    return volts / getCalibrationFactor();
+}
+
 float OscilloscopeAudioProcessor::getCorrectedVoltage(float value) const
 {
     return value * getCalibrationFactor();
@@ -285,6 +505,69 @@ void OscilloscopeAudioProcessor::setSineEnabled(bool enabled)
     sineEnabled = enabled;
 }
 
+void OscilloscopeAudioProcessor::openReferenceStore(const juce::String& id, bool restored)
+{
+    const auto folder = ReferenceTraceStore::getDefaultFolder();
+    const auto file = folder.getChildFile(id + ".refs");
+
+    // A duplicated track or preset names the file of another live instance: carry on from
+    // a copy under a new id instead of mapping the same file twice
+    if (ReferenceTraceStore::isOpenElsewhere(file))
+    {
+        referenceStoreId = juce::Uuid().toString();
+        const auto copy = folder.getChildFile(referenceStoreId + ".refs");
+
+        if (file.existsAsFile())
+            file.copyFileTo(copy);
+
+        referenceStore.open(copy);
+        return;
+    }
+
+    referenceStoreId = id;
+    referenceStore.open(file);
+
+    // The saved state that named the file still needs it
+    if (restored)
+        referenceStore.setReferencedBySavedState();
+}
+
+ScopeStats OscilloscopeAudioProcessor::getStats() const
+{
+    auto stats = performanceCounters.getStats();
+    stats.fftDroppedSamples = frequencyAnalyzer.getDroppedSamples();
+
+    const auto recorder = captureRecorder.getStatus();
+    stats.recording = recorder.recording;
+    stats.recordedSamples = recorder.samplesWritten;
+    stats.recorderDroppedSamples = recorder.droppedSamples;
+    stats.recorderOverruns = recorder.overruns;
+    stats.recorderError = recorder.error;
+
+    const double sampleRate = getSampleRate();
+    if (deepCapture.isActive() && sampleRate > 0.0)
+    {
+        stats.historySeconds = (float)((deepCapture.getTotalSamplesWritten() - deepCapture.getOldestSample()) / sampleRate);
+        stats.historyLostSamples = deepCapture.getLostSamples();
+    }
+
+    stats.playbackLoaded = recordingPlayer.isLoaded();
+    stats.playbackPlaying = recordingPlayer.isPlaying();
+    stats.playbackSeconds = (float)recordingPlayer.getPositionInSeconds();
+    stats.playbackLengthSeconds = (float)recordingPlayer.getLengthInSeconds();
+    stats.playbackSpeed = recordingPlayer.getSpeed();
+    stats.playbackPasses = playbackPasses.load();
+
+    if (blockProfiler.isEnabled())
+    {
+        const auto profile = blockProfiler.getSummary();
+        stats.stageTimings.assign(profile.stages.begin(), profile.stages.end());
+        stats.blockOverruns = profile.overruns;
+    }
+
+    return stats;
+}
+
 std::vector<std::pair<float, float>> OscilloscopeAudioProcessor::getHarmonicLabels() const
 {
     return frequencyAnalyzer.getHarmonicsInDB(6, -80.0f);
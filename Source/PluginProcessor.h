@@ -6,6 +6,21 @@
 #include "Serial/SerialDevice.h"
 #include "DSP/Trigger.h"
 #include "DSP/CircularAudioBuffer.h"
+#include "DSP/SegmentedCapture.h"
+#include "DSP/EquivalentTimeSampler.h"
+#include "DSP/PerformanceCounters.h"
+#include "DSP/BlockProfiler.h"
+#include "DSP/SignalGenerator.h"
+#include "DSP/ResponseAnalyzer.h"
+#include "DSP/ReferenceTraceStore.h"
+#include "DSP/ChannelSettings.h"
+#include "DSP/MathChannels.h"
+#include "DSP/CaptureRecorder.h"
+#include "DSP/DeepCaptureBuffer.h"
+#include "DSP/RecordingPlayer.h"
+#include "DSP/RecordingAnalyzer.h"
+#include "DSP/EventSearch.h"
+#include "DSP/MaskTester.h"
 
 class OscilloscopeAudioProcessor  : public juce::AudioProcessor
 {
@@ -48,12 +63,33 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
     // Frequency Visualizer
-    void createAnalyserPlot(juce::Path& p, const juce::Rectangle<int> bounds, float dBMin, float dBMax);
+    void createAnalyserPlot(juce::Path& p, const juce::Rectangle<int> bounds, float dBMin, float dBMax, int channel = 0);
+    void createAnalyserPoints(std::vector<float>& x, std::vector<float>& y, const juce::Rectangle<int> bounds, float dBMin, float dBMax, int channel = 0);
+    int getNumAnalyserChannels() const noexcept { return frequencyAnalyzer.getNumChannels(); }
     bool checkForNewAnalyserData();
+    bool isAnalyserDataPending() const noexcept { return frequencyAnalyzer.isNewDataPending(); }
 
     // Timer Visualizer
     juce::AudioBuffer<float>& getAudioBuffer() { return audioTimeBuffer; }
-    int getNumInputChannels() const { return audioTimeBuffer.getNumChannels(); }
+    int getNumInputChannels() const { return numInputChannels.load(); }
+
+    // Captured channels: the inputs followed by the math channels. Views index the
+    // history, the analyser and the settings below with the same channel number.
+    int getNumCaptureChannels() const { return circularBuffer.getNumChannels(); }
+    int getMathChannelIndex(int slot) const { return getNumInputChannels() + slot; }
+    bool isMathChannel(int channel) const { return channel >= getNumInputChannels(); }
+    juce::String getChannelName(int channel) const;
+    bool isChannelShown(int channel);
+
+    // Per-channel visibility, scale and offset shared by both views; saved with the state
+    ChannelSettings& getChannelSettings(int channel);
+
+    // Math channels (A+B, integrals, custom expressions), computed into the capture
+    MathChannels& getMathChannels() { return mathChannels; }
+
+    // Channel the time view triggers on and measures; saved with the state
+    int getTriggerChannel() const { return triggerChannel.load(); }
+    void setTriggerChannel(int channel) { triggerChannel = juce::jlimit(0, ChannelSettings::maxCaptureChannels - 1, channel); }
 
     // APVTS
     juce::AudioProcessorValueTreeState apvts{
@@ -67,10 +103,46 @@ public:
     Parameters params;
 
     float getTriggerLevel() const { return params.getTriggerLevel(); }
+    float getTriggerLevelInSignalDomain() const;
 
     //Circular Buffer 
     CircularAudioBuffer& getCircularBuffer() { return circularBuffer; }
 
+    // Deep (memory-mapped) history behind the circular buffer; reads fall through to the
+    // circular buffer while it is off. Depth in seconds, 0 = off; saved with the state.
+    CaptureHistory& getCaptureHistory() { return deepCapture; }
+    DeepCaptureBuffer& getDeepCapture() { return deepCapture; }
+    double getDeepCaptureSeconds() const { return deepCaptureSeconds; }
+    bool setDeepCaptureSeconds(double seconds);
+
+    // Searches of the capture history (edges, glitches, ...) and their hits, which the
+    // time view steps through
+    EventSearch& getEventSearch() { return eventSearch; }
+
+    // Segmented (fast-frame) acquisition
+    SegmentedCapture& getSegmentedCapture() { return segmentedCapture; }
+
+    // Long recordings of the inputs to disk
+    CaptureRecorder& getCaptureRecorder() { return captureRecorder; }
+
+    // Recordings played back through the capture path, or measured offline as a whole
+    RecordingPlayer& getRecordingPlayer() { return recordingPlayer; }
+    RecordingAnalyzer& getRecordingAnalyzer() { return recordingAnalyzer; }
+
+    // Equivalent-time (phase folded) display
+    EquivalentTimeSampler& getEquivalentTimeSampler() { return equivalentTimeSampler; }
+
+    // Instrumentation
+    PerformanceCounters& getPerformanceCounters() { return performanceCounters; }
+    BlockProfiler& getBlockProfiler() { return blockProfiler; }
+    ScopeStats getStats() const;
+
+    // Reference traces (snapshots), owned here so they outlive the editor
+    ReferenceTraceStore& getReferenceStore() { return referenceStore; }
+
+    // Pass/fail mask test of every triggered acquisition, usually against a reference
+    MaskTester& getMaskTester() { return maskTester; }
+
     //CalibrationLevel
     void startLevelCalibration();
     float getCalibrationFactor() const;
@@ -80,22 +152,53 @@ public:
     float getCorrectedVoltage(float vppMedido) const;
 
     void setSineEnabled(bool enabled);
+    SignalGenerator& getSignalGenerator() { return signalGenerator; }
+
+    // Frequency response measured against the sweep / multitone stimulus
+    ResponseAnalyzer& getResponseAnalyzer() { return responseAnalyzer; }
+    bool isResponseMeasurementActive() const { return sineEnabled && SignalGenerator::isStimulus(signalGenerator.getWaveform()); }
 
     // Bypass
-    bool isBypassed() const {
-        return apvts.getRawParameterValue(bypassParamID.getParamID())->load() > 0.5f;
-    };
+    bool isBypassed() const { return params.isBypassed(); }
 
     std::vector<std::pair<float, float>> getHarmonicLabels() const;
 
 private:
     juce::AudioBuffer<float> audioTimeBuffer;
     CircularAudioBuffer circularBuffer;
+    DeepCaptureBuffer deepCapture{ circularBuffer };
+    double deepCaptureSeconds = 0.0;
+    EventSearch eventSearch;
+    std::array<ChannelSettings, ChannelSettings::maxCaptureChannels> channelSettings; // inputs, then math
+    std::atomic<int> numInputChannels{ 1 };
+    std::atomic<int> triggerChannel{ 0 };
+
+    MathChannels mathChannels;
+    juce::AudioBuffer<float> mathBuffer;
+    std::array<float*, ChannelSettings::maxCaptureChannels> captureChannels{};
+    SegmentedCapture segmentedCapture;
+    CaptureRecorder captureRecorder;
+    RecordingPlayer recordingPlayer;
+    std::atomic<int> playbackPasses{ 1 };          // recording blocks captured in the last host block
+    static constexpr double playbackBudget = 0.5;  // of a block's duration, for playback passes
+    RecordingAnalyzer recordingAnalyzer;
+    EquivalentTimeSampler equivalentTimeSampler;
+
+    PerformanceCounters performanceCounters;
+    BlockProfiler blockProfiler;
+
+    ReferenceTraceStore referenceStore;
+    juce::String referenceStoreId;
+    MaskTester maskTester;
+    void openReferenceStore(const juce::String& id, bool restored = false);
+    void captureBlock(juce::AudioBuffer<float>& buffer);
+
+    Trigger edgeCounter;
+    float lastInputSample = 0.0f;
 
     FFT frequencyAnalyzer;
 
     SerialDevice serialDevice;
-    bool lastFrequencyModeState = false;
 
     bool isCalibratingLevel = false;
     float calibrationFactorAC = 1.0f;
@@ -106,9 +209,9 @@ private:
 
     int calibrationRange = 2; // by default range = 1 V  10 V
 
-    // Sine generator for calibration
-    double phase = 0.0;
-    double phaseIncrement = 0.0;
+    // Signal generator for calibration
+    SignalGenerator signalGenerator;
+    ResponseAnalyzer responseAnalyzer;
     bool sineEnabled = false;
 
     //==============================================================================
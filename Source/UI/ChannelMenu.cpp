@@ -0,0 +1,92 @@
+#include "ChannelMenu.h"
+#include "LookAndFeel.h"
+
+void ChannelMenu::show(OscilloscopeAudioProcessor& processor, juce::Component& target, std::function<void()> onChange)
+{
+    const float scales[] = { 0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f };
+    const float offsets[] = { 3.0f, 2.0f, 1.0f, 0.0f, -1.0f, -2.0f, -3.0f };
+    const int numChannels = juce::jmin(processor.getNumCaptureChannels(), ChannelSettings::maxCaptureChannels);
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader("Channels");
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        auto& settings = processor.getChannelSettings(c);
+
+        juce::PopupMenu channelMenu;
+        channelMenu.addItem("Visible", true, settings.visible.load(),
+                            [&settings, onChange] { settings.visible = !settings.visible.load(); onChange(); });
+
+        channelMenu.addSectionHeader("Scale");
+        for (auto scale : scales)
+            channelMenu.addItem("x" + juce::String(scale, scale < 1.0f ? 2 : 0), true, settings.scale.load() == scale,
+                                [&settings, onChange, scale] { settings.scale = scale; onChange(); });
+
+        channelMenu.addSectionHeader("Offset");
+        for (auto offset : offsets)
+            channelMenu.addItem((offset > 0.0f ? "+" : "") + juce::String((int)offset) + " div", true, settings.offset.load() == offset,
+                                [&settings, onChange, offset] { settings.offset = offset; onChange(); });
+
+        if (processor.isMathChannel(c))
+            addMathMenu(processor, channelMenu, c - processor.getNumInputChannels(), onChange);
+
+        juce::PopupMenu::Item item(processor.getChannelName(c));
+        item.subMenu = std::make_unique<juce::PopupMenu>(std::move(channelMenu));
+        item.colour = Colors::PlotSection::getChannelColour(c);
+        item.isTicked = processor.isChannelShown(c);
+        menu.addItem(std::move(item));
+    }
+
+    // The time view triggers on and measures one channel; math channels qualify too
+    juce::PopupMenu triggerMenu;
+    for (int c = 0; c < numChannels; ++c)
+        triggerMenu.addItem(processor.getChannelName(c), true, processor.getTriggerChannel() == c,
+                            [&processor, onChange, c] { processor.setTriggerChannel(c); onChange(); });
+
+    menu.addSeparator();
+    menu.addSubMenu("Trigger source", triggerMenu);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&target));
+}
+
+void ChannelMenu::addMathMenu(OscilloscopeAudioProcessor& processor, juce::PopupMenu& menu, int slot, std::function<void()> onChange)
+{
+    auto& math = processor.getMathChannels();
+    const auto current = math.getExpression(slot);
+
+    auto apply = [&processor, slot, onChange](const juce::String& expression)
+    {
+        const auto result = processor.getMathChannels().setExpression(slot, expression);
+        if (result.failed())
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Math channel",
+                                                   "\"" + expression + "\": " + result.getErrorMessage());
+        onChange();
+    };
+
+    menu.addSectionHeader("Function");
+    menu.addItem("Off", true, current.isEmpty(), [apply] { apply({}); });
+
+    bool isPreset = current.isEmpty();
+    for (const auto& preset : MathChannels::getPresets())
+    {
+        isPreset = isPreset || preset == current;
+        menu.addItem(preset, true, preset == current, [apply, preset] { apply(preset); });
+    }
+
+    menu.addItem(isPreset ? juce::String("Custom...") : "Custom: " + current, true, !isPreset, [apply, current]
+    {
+        auto* window = new juce::AlertWindow("Math channel",
+                                             "Inputs A to H, + - * /, abs(), diff() (V/ms) and integ() (V*ms)",
+                                             juce::MessageBoxIconType::NoIcon);
+        window->addTextEditor("expression", current.isNotEmpty() ? current : "A-B");
+        window->addButton("OK", 1, juce::KeyPress(juce::KeyPress::returnKey));
+        window->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+
+        window->enterModalState(true, juce::ModalCallbackFunction::create([window, apply](int result)
+        {
+            if (result == 1)
+                apply(window->getTextEditorContents("expression"));
+        }), true);
+    });
+}
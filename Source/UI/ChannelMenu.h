@@ -0,0 +1,17 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+
+class ChannelMenu
+{
+public:
+    // Right-click menu shared by the time and frequency views: one submenu per captured
+    // channel with visibility, scale and offset (plus the function of a math channel),
+    // and the trigger source. onChange runs on the message thread after any setting was
+    // changed so the view can rebuild its frame.
+    static void show(OscilloscopeAudioProcessor& processor, juce::Component& target, std::function<void()> onChange);
+
+private:
+    static void addMathMenu(OscilloscopeAudioProcessor& processor, juce::PopupMenu& menu, int slot, std::function<void()> onChange);
+};
@@ -0,0 +1,37 @@
+#include "FrameScheduler.h"
+
+FrameScheduler::FrameScheduler(juce::Component& c, std::function<void()> callback, double maxFramesPerSecond)
+    : component(c),
+      onFrame(std::move(callback)),
+      vBlank(&c, [this] { handleVBlank(); })
+{
+    setMaxFramesPerSecond(maxFramesPerSecond);
+}
+
+void FrameScheduler::setMaxFramesPerSecond(double framesPerSecond)
+{
+    // Small slack so a 60 fps limit does not drop every other vblank on a 60 Hz display
+    minIntervalMs = framesPerSecond > 0.0 ? 1000.0 / framesPerSecond - 1.0 : 0.0;
+}
+
+bool FrameScheduler::isOnScreen() const
+{
+    if (!component.isShowing())
+        return false;
+
+    auto* peer = component.getPeer();
+    return peer != nullptr && !peer->isMinimised();
+}
+
+void FrameScheduler::handleVBlank()
+{
+    if (onFrame == nullptr || !isOnScreen())
+        return;
+
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    if (now - lastFrameMs < minIntervalMs)
+        return;
+
+    lastFrameMs = now;
+    onFrame();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Drives a visualizer from the display's vertical blank instead of a free-running Timer.
+// The callback only runs while the component is actually on screen (showing and its
+// window not minimised) and never more often than maxFramesPerSecond. Whether anything
+// is repainted is left to the callback, which knows if a new frame was produced.
+class FrameScheduler
+{
+public:
+    FrameScheduler(juce::Component& component, std::function<void()> onFrame, double maxFramesPerSecond = 60.0);
+
+    void setMaxFramesPerSecond(double framesPerSecond);
+
+private:
+    void handleVBlank();
+    bool isOnScreen() const;
+
+    juce::Component& component;
+    std::function<void()> onFrame;
+
+    double minIntervalMs = 0.0;
+    double lastFrameMs = 0.0;
+
+    juce::VBlankAttachment vBlank;
+
+    JUCE_DECLARE_NON_COPYABLE(FrameScheduler)
+};
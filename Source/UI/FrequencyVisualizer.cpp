@@ -9,7 +9,6 @@ FrequencyVisualizer::FrequencyVisualizer(OscilloscopeAudioProcessor& p)
     : processor(p)
 {
     setOpaque(true);
-    startTimerHz(60);
 }
 
 FrequencyVisualizer::~FrequencyVisualizer()
@@ -18,11 +17,103 @@ FrequencyVisualizer::~FrequencyVisualizer()
 
 void FrequencyVisualizer::paint (juce::Graphics& g)
 {
-    const bool bypassed = processor.apvts.getRawParameterValue(bypassParamID.getParamID())->load();
+    ScopedPaintTimer paintTimer(processor.getPerformanceCounters());
+    const bool bypassed = processor.isBypassed();
 
     juce::MessageManagerLock mmLock;
     if (!mmLock.lockWasGained()) return;
 
+    drawGridLayer(g);
+    g.reduceClipRegion(clipPath);
+
+    if (!bypassed)
+    {
+        drawTraceLayer(g);
+
+        for (const auto& [freq, dB] : harmonicLabels)
+        {
+            const auto labelBounds = getHarmonicLabelBounds(freq, dB);
+
+            juce::String label;
+            if (freq >= 1000.0f)
+                label = juce::String(freq / 1000.0f, 1) + "k\n" + juce::String(dB, 1) + " dB";
+            else
+                label = juce::String((int)freq) + "\n" + juce::String(dB, 1) + " dB";
+
+            g.setColour(juce::Colours::yellow);
+            g.setFont(11.0f);
+            g.drawFittedText(label, labelBounds, juce::Justification::centred, 2);
+        }
+
+        if (showResponse)
+            drawResponse(g);
+    }
+
+    if (showStats)
+        StatsOverlay::draw(g, processor.getStats(), getLocalBounds().reduced(8));
+}
+
+void FrequencyVisualizer::resized()
+{
+    plotFrame = getLocalBounds();
+    traceRasterizer.setSize(getWidth(), getHeight(), traceRasterizer.getScale());
+    updatePlot();
+    updateResponsePlot();
+    lastDirtyBounds = getLocalBounds();
+
+    clipPath.clear();
+    clipPath.addRoundedRectangle(getLocalBounds().toFloat(), 8.0f);
+    gridLayer = {};
+}
+
+void FrequencyVisualizer::lookAndFeelChanged()
+{
+    gridLayer = {};
+    repaint();
+}
+
+void FrequencyVisualizer::mouseDown(const juce::MouseEvent& event)
+{
+    if (!event.mods.isPopupMenu())
+        return;
+
+    // Scale and offset only apply to the time view; here a channel is shown or hidden
+    juce::Component::SafePointer<FrequencyVisualizer> safeThis(this);
+    ChannelMenu::show(processor, *this, [safeThis]
+    {
+        if (safeThis != nullptr)
+        {
+            safeThis->updatePlot();
+            safeThis->lastDirtyBounds = safeThis->getLocalBounds();
+            safeThis->repaint();
+        }
+    });
+}
+
+void FrequencyVisualizer::drawGridLayer(juce::Graphics& g)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int w = juce::roundToInt(getWidth() * scale);
+    const int h = juce::roundToInt(getHeight() * scale);
+
+    if (w <= 0 || h <= 0)
+        return;
+
+    if (!gridLayer.isValid() || gridLayer.getWidth() != w || gridLayer.getHeight() != h || gridLayerScale != scale)
+    {
+        gridLayer = juce::Image(juce::Image::ARGB, w, h, true);
+        gridLayerScale = scale;
+
+        juce::Graphics lg(gridLayer);
+        lg.addTransform(juce::AffineTransform::scale(scale));
+        renderGrid(lg);
+    }
+
+    g.drawImage(gridLayer, getLocalBounds().toFloat());
+}
+
+void FrequencyVisualizer::renderGrid(juce::Graphics& g)
+{
     const float cornerRadius = 8.0f;
     const float borderThickness = 4.0f;
     auto bounds = getLocalBounds().toFloat();
@@ -30,8 +121,6 @@ void FrequencyVisualizer::paint (juce::Graphics& g)
     g.setColour(Colors::PlotSection::background);
     g.fillRoundedRectangle(bounds, cornerRadius);
 
-    juce::Path clipPath;
-    clipPath.addRoundedRectangle(bounds, cornerRadius);
     g.reduceClipRegion(clipPath);
 
     g.setColour(Colors::PlotSection::outline);
@@ -91,47 +180,168 @@ void FrequencyVisualizer::paint (juce::Graphics& g)
         g.setColour(juce::Colours::silver.withAlpha(0.8f));
         g.drawFittedText(juce::String((int)dBValue) + " dB", plotFrame.getX() + 3, juce::roundToInt(y - 7), 50, 14, juce::Justification::left, 1);
     }
+}
 
-    if (!bypassed)
+void FrequencyVisualizer::frameCallback()
+{
+    const bool bypassed = processor.isBypassed();
+
+    if (bypassed != lastBypass)
     {
-        processor.createAnalyserPlot(analyzerPath, plotFrame, minDB, maxDB);
-        g.setColour(Colors::PlotSection::frequencyResponse);
-        g.strokePath(analyzerPath, juce::PathStrokeType(2.0f));
-       
-        auto harmonics = processor.getHarmonicLabels();
+        lastBypass = bypassed;
+        repaint();
+    }
 
-        for (const auto& [freq, dB] : harmonics)
-        {
-            float normX = getPositionForFrequency(freq);
-            float x = plotFrame.getX() + normX * plotFrame.getWidth();
-            float normY = juce::jmap(dB, minDB, maxDB, 1.0f, 0.0f);
-            float y = plotFrame.getY() + normY * plotFrame.getHeight();
+    // The response overlay changes at most once per stimulus period; repaint it whole
+    const bool responseActive = processor.isResponseMeasurementActive();
+    const bool newResponse = processor.getResponseAnalyzer().checkForNewResponse();
 
-            juce::String label;
-            if (freq >= 1000.0f)
-                label = juce::String(freq / 1000.0f, 1) + "k\n" + juce::String(dB, 1) + " dB";
-            else
-                label = juce::String((int)freq) + "\n" + juce::String(dB, 1) + " dB";
+    if (responseActive != showResponse || (responseActive && newResponse))
+    {
+        showResponse = responseActive;
+        response = showResponse ? processor.getResponseAnalyzer().getResponse() : ResponseAnalyzer::Response();
+        updateResponsePlot();
+        repaint();
+    }
 
-            g.setColour(juce::Colours::yellow);
-            g.setFont(11.0f);
-            g.drawFittedText(label, juce::roundToInt(x) - 20, juce::roundToInt(y) - 25, 40, 25, juce::Justification::centred, 2);
+    if (bypassed || !processor.checkForNewAnalyserData())
+        return;
+
+    updatePlot();
+
+    if (showStats)
+    {
+        lastDirtyBounds = getLocalBounds();
+        repaint();
+        return;
+    }
+
+    const auto dirty = getDirtyBounds();
+    repaint(dirty.getUnion(lastDirtyBounds));
+    lastDirtyBounds = dirty;
+}
+
+void FrequencyVisualizer::updatePlot()
+{
+    const int numChannels = processor.getNumAnalyserChannels();
+    plotY.resize((size_t)numChannels);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        if (processor.isChannelShown(c))
+            processor.createAnalyserPoints(plotX, plotY[(size_t)c], plotFrame, minDB, maxDB, c);
+        else
+            plotY[(size_t)c].clear();
+    }
+
+    harmonicLabels = processor.getHarmonicLabels();
+    traceNeedsRaster = true;
+}
+
+void FrequencyVisualizer::drawTraceLayer(juce::Graphics& g)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (scale != traceRasterizer.getScale() || !traceRasterizer.getImage().isValid())
+    {
+        traceRasterizer.setSize(getWidth(), getHeight(), scale);
+        traceNeedsRaster = true;
+    }
+
+    // All channels share one image, so the blit cost does not grow with the channel count
+    if (traceNeedsRaster)
+    {
+        traceRasterizer.clear();
+
+        for (size_t c = 0; c < plotY.size(); ++c)
+        {
+            if (plotY[c].size() != plotX.size())
+                continue;
+
+            traceRasterizer.setColour(c == 0 ? Colors::PlotSection::frequencyResponse : Colors::PlotSection::getChannelColour((int)c));
+            traceRasterizer.drawPolyline(plotX.data(), plotY[c].data(), (int)plotX.size());
         }
 
+        traceNeedsRaster = false;
     }
+
+    g.drawImage(traceRasterizer.getImage(), getLocalBounds().toFloat());
 }
 
-void FrequencyVisualizer::resized()
+void FrequencyVisualizer::updateResponsePlot()
 {
-    plotFrame = getLocalBounds();
+    responseMagnitude.clear();
+    responsePhase.clear();
+
+    const auto frame = plotFrame.toFloat();
+    const float dBZoomPadding = 0.05f;
+
+    for (size_t i = 0; i < response.frequency.size(); ++i)
+    {
+        const float x = frame.getX() + getPositionForFrequency(response.frequency[i]) * frame.getWidth();
+        const float dB = juce::jlimit(minDB, maxDB, response.magnitudeDb[i]);
+        const float magnitudeY = frame.getY() + (dBZoomPadding + (1.0f - 2.0f * dBZoomPadding) * (maxDB - dB) / (maxDB - minDB)) * frame.getHeight();
+        const float phaseY = frame.getY() + juce::jmap(response.phaseDegrees[i], 180.0f, -180.0f, dBZoomPadding, 1.0f - dBZoomPadding) * frame.getHeight();
+
+        if (i == 0)
+        {
+            responseMagnitude.startNewSubPath(x, magnitudeY);
+            responsePhase.startNewSubPath(x, phaseY);
+        }
+        else
+        {
+            responseMagnitude.lineTo(x, magnitudeY);
+            responsePhase.lineTo(x, phaseY);
+        }
+    }
 }
 
-void FrequencyVisualizer::timerCallback()
+void FrequencyVisualizer::drawResponse(juce::Graphics& g)
 {
-    if (processor.checkForNewAnalyserData())
+    g.setColour(juce::Colours::cyan.withAlpha(0.5f));
+    g.strokePath(responsePhase, juce::PathStrokeType(1.0f));
+
+    g.setColour(juce::Colours::orange);
+    g.strokePath(responseMagnitude, juce::PathStrokeType(2.0f));
+
+    const juce::String legend = response.frequency.empty()
+        ? juce::String("Response: waiting for a full stimulus period")
+        : "Response |H| (orange), phase +-180 deg (cyan), latency " + juce::String(response.latencySamples) + " samples";
+
+    g.setFont(12.0f);
+    g.setColour(juce::Colours::silver.withAlpha(0.9f));
+    g.drawText(legend, plotFrame.reduced(60, 8).removeFromTop(16), juce::Justification::centredLeft);
+}
+
+juce::Rectangle<int> FrequencyVisualizer::getHarmonicLabelBounds(float freq, float dB)
+{
+    float normX = getPositionForFrequency(freq);
+    float x = plotFrame.getX() + normX * plotFrame.getWidth();
+    float normY = juce::jmap(dB, minDB, maxDB, 1.0f, 0.0f);
+    float y = plotFrame.getY() + normY * plotFrame.getHeight();
+
+    return { juce::roundToInt(x) - 20, juce::roundToInt(y) - 25, 40, 25 };
+}
+
+juce::Rectangle<int> FrequencyVisualizer::getDirtyBounds()
+{
+    // Bounds of every shown curve padded for the 2 px stroke, plus every harmonic label
+    juce::Rectangle<int> dirty;
+
+    for (const auto& y : plotY)
     {
-        repaint(plotFrame);
+        if (plotX.empty() || y.size() != plotX.size())
+            continue;
+
+        const auto yRange = juce::FloatVectorOperations::findMinAndMax(y.data(), (int)y.size());
+        dirty = dirty.getUnion(juce::Rectangle<float>::leftTopRightBottom(plotX.front(), yRange.getStart(), plotX.back(), yRange.getEnd())
+                                   .expanded(3.0f).getSmallestIntegerContainer());
     }
+
+    for (const auto& [freq, dB] : harmonicLabels)
+        dirty = dirty.getUnion(getHarmonicLabelBounds(freq, dB));
+
+    return dirty.getIntersection(getLocalBounds());
 }
 
 float FrequencyVisualizer::getFrequencyForPosition(float pos)
@@ -2,9 +2,12 @@
 
 #include <JuceHeader.h>
 #include "../PluginProcessor.h"
+#include "StatsOverlay.h"
+#include "FrameScheduler.h"
+#include "TraceRasterizer.h"
+#include "ChannelMenu.h"
 
-class FrequencyVisualizer  : public juce::Component,
-                             public juce::Timer
+class FrequencyVisualizer  : public juce::Component
 {
 public:
     FrequencyVisualizer(OscilloscopeAudioProcessor& processor);
@@ -12,19 +15,58 @@ public:
 
     void resized() override;
     void paint (juce::Graphics&) override;
+    void lookAndFeelChanged() override;
+    void mouseDown(const juce::MouseEvent& event) override;
 
-    void timerCallback() override;
+    void setShowStats(bool enabled) { showStats = enabled; repaint(); }
+
+    // Called on vblank while visible: rebuilds the analyser curve only when the FFT has
+    // produced new data and repaints the area covered by the old and new curve and
+    // labels. Offline renderers call it directly before taking a snapshot.
+    void frameCallback();
 
 private:
     float getFrequencyForPosition(float pos);
     float getPositionForFrequency(float freq);
 
+    // Background, outline and the log-frequency/dB grid with labels, cached at
+    // physical resolution and rebuilt only on resize, display scale or theme change.
+    void drawGridLayer(juce::Graphics& g);
+    void renderGrid(juce::Graphics& g);
+
+    void updatePlot();
+    juce::Rectangle<int> getDirtyBounds();
+    juce::Rectangle<int> getHarmonicLabelBounds(float freq, float dB);
+    void drawTraceLayer(juce::Graphics& g);
+
+    // Measured magnitude (on the dB grid) and phase (+-180 deg over the plot height)
+    void updateResponsePlot();
+    void drawResponse(juce::Graphics& g);
+
     OscilloscopeAudioProcessor& processor;
 
     juce::Rectangle<int> plotFrame;
+    juce::Path clipPath;
+
+    juce::Image gridLayer;
+    float gridLayerScale = 0.0f;
 
     juce::Path frequencyResponse;
-    juce::Path analyzerPath;
+    std::vector<float> plotX;
+    std::vector<std::vector<float>> plotY;  // one curve per channel, empty while hidden
+    TraceRasterizer traceRasterizer;
+    bool traceNeedsRaster = true;
+    std::vector<std::pair<float, float>> harmonicLabels;
+    juce::Rectangle<int> lastDirtyBounds;
+    bool lastBypass = false;
+
+    ResponseAnalyzer::Response response;
+    juce::Path responseMagnitude, responsePhase;
+    bool showResponse = false;
+
+    bool showStats = false;
+
+    FrameScheduler frameScheduler { *this, [this] { frameCallback(); } };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrequencyVisualizer)
 };
@@ -43,6 +43,18 @@ namespace Colors
 		const juce::Colour outline{ 220, 216, 211 };
 		const juce::Colour triggerMarker{ 255, 255, 255 }; 
 		const juce::Colour dcResponse{ 124, 207, 0 };
+
+		// One trace colour per input channel; channel 1 keeps the original green
+		const juce::Colour channels[] = {
+			{ 124, 207, 0 }, { 255, 196, 0 }, { 0, 190, 255 }, { 255, 90, 160 },
+			{ 180, 130, 255 }, { 255, 130, 60 }, { 90, 230, 190 }, { 230, 230, 230 },
+			{ 255, 60, 60 }, { 60, 120, 255 } // math channels
+		};
+
+		inline juce::Colour getChannelColour(int index)
+		{
+			return channels[juce::jlimit(0, (int)std::size(channels) - 1, index)];
+		}
 	}
 }
 
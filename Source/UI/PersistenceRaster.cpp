@@ -0,0 +1,223 @@
+#include "PersistenceRaster.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <emmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+PersistenceRaster::PersistenceRaster()
+{
+    // Intensity grading: dim blue for rare hits, through green and yellow to white
+    const juce::ColourGradient gradient = [] {
+        juce::ColourGradient grad(juce::Colour(20, 40, 160), 0.0f, 0.0f, juce::Colours::white, 1.0f, 0.0f, false);
+        grad.addColour(0.35, juce::Colour(124, 207, 0));
+        grad.addColour(0.7, juce::Colours::yellow);
+        grad.addColour(0.9, juce::Colours::orangered);
+        return grad;
+    }();
+
+    for (int i = 0; i < (int)palette.size(); ++i)
+    {
+        const float intensity = std::sqrt(i / 255.0f); // compress the range so single hits stay visible
+        const float alpha = i == 0 ? 0.0f : juce::jmin(1.0f, 0.35f + intensity);
+        palette[(size_t)i] = gradient.getColourAtPosition(intensity).withAlpha(alpha).getPixelARGB();
+    }
+}
+
+void PersistenceRaster::setSize(int newWidth, int newHeight)
+{
+    if (newWidth == width && newHeight == height)
+        return;
+
+    width = juce::jmax(0, newWidth);
+    height = juce::jmax(0, newHeight);
+    hits.assign((size_t)width * (size_t)height, 0);
+    columnMin.resize((size_t)width);
+    columnMax.resize((size_t)width);
+}
+
+void PersistenceRaster::clear()
+{
+    std::fill(hits.begin(), hits.end(), (juce::uint16)0);
+    lastDecayMs = 0.0;
+}
+
+void PersistenceRaster::fillSpan(int x, int yTop, int yBottom) noexcept
+{
+    yTop = juce::jlimit(0, height - 1, yTop);
+    yBottom = juce::jlimit(0, height - 1, yBottom);
+
+    // Saturating increment over a contiguous run, simple enough for the compiler to vectorise
+    juce::uint16* cell = hits.data() + (size_t)x * (size_t)height;
+    for (int y = yTop; y <= yBottom; ++y)
+        cell[y] = cell[y] > 65535 - hitIncrement ? (juce::uint16)65535 : (juce::uint16)(cell[y] + hitIncrement);
+}
+
+void PersistenceRaster::addPoint(int x, int y) noexcept
+{
+    if (x >= 0 && x < width && y >= 0 && y < height)
+    {
+        auto& cell = hits[(size_t)x * (size_t)height + (size_t)y];
+        cell = cell > 65535 - hitIncrement ? (juce::uint16)65535 : (juce::uint16)(cell + hitIncrement);
+    }
+}
+
+void PersistenceRaster::addTrace(const float* samples, int numSamples, float yScale, float yOffset)
+{
+    if (width < 2 || height < 1 || numSamples < 2)
+        return;
+
+    const float samplesPerColumn = (numSamples - 1) / (float)(width - 1);
+
+    if (samplesPerColumn > 1.0f)
+    {
+        // Dense: min/max of the samples falling into each column
+        for (int x = 0; x < width; ++x)
+        {
+            const int begin = static_cast<int>(x * samplesPerColumn);
+            const int end = juce::jmin(numSamples, static_cast<int>((x + 1) * samplesPerColumn) + 1);
+            const auto range = juce::FloatVectorOperations::findMinAndMax(samples + begin, juce::jmax(1, end - begin));
+            columnMin[(size_t)x] = range.getStart();
+            columnMax[(size_t)x] = range.getEnd();
+        }
+    }
+    else
+    {
+        // Sparse: linear interpolation at each column
+        for (int x = 0; x < width; ++x)
+        {
+            const float position = x * samplesPerColumn;
+            const int index = juce::jmin(numSamples - 2, static_cast<int>(position));
+            const float fraction = position - index;
+            columnMin[(size_t)x] = columnMax[(size_t)x] = samples[index] + fraction * (samples[index + 1] - samples[index]);
+        }
+    }
+
+    // Column spans, each extended to the previous column so steep edges stay connected
+    float previousMin = columnMin[0];
+    float previousMax = columnMax[0];
+
+    for (int x = 0; x < width; ++x)
+    {
+        const float lo = juce::jmin(columnMin[(size_t)x], previousMax);
+        const float hi = juce::jmax(columnMax[(size_t)x], previousMin);
+        previousMin = columnMin[(size_t)x];
+        previousMax = columnMax[(size_t)x];
+
+        const int yTop = static_cast<int>(yOffset - hi * yScale);
+        const int yBottom = static_cast<int>(yOffset - lo * yScale);
+        if (yBottom < 0 || yTop >= height)
+            continue;
+
+        fillSpan(x, yTop, yBottom);
+    }
+}
+
+void PersistenceRaster::addLine(int x0, int y0, int x1, int y1)
+{
+    const int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    const int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+
+    for (;;)
+    {
+        addPoint(x0, y0);
+        if (x0 == x1 && y0 == y1)
+            break;
+
+        const int e2 = 2 * error;
+        if (e2 >= dy) { error += dy; x0 += sx; }
+        if (e2 <= dx) { error += dx; y0 += sy; }
+    }
+}
+
+void PersistenceRaster::addPolyline(const float* x, const float* y, int numPoints) noexcept
+{
+    if (width == 0 || height == 0)
+        return;
+
+    // Far outside the raster the int conversion would overflow; those points are only
+    // ever connected by clipped lines anyway
+    const float limit = 4.0f * (float)juce::jmax(width, height);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const int px = static_cast<int>(juce::jlimit(-limit, limit, x[i]));
+        const int py = static_cast<int>(juce::jlimit(-limit, limit, y[i]));
+
+        if (hasLastPoint && (std::abs(px - lastX) > 1 || std::abs(py - lastY) > 1))
+        {
+            addLine(lastX, lastY, px, py);
+        }
+        else if (px >= 0 && px < width && py >= 0 && py < height)
+        {
+            auto& cell = hits[(size_t)px * (size_t)height + (size_t)py];
+            cell = cell > 65535 - hitIncrement ? (juce::uint16)65535 : (juce::uint16)(cell + hitIncrement);
+        }
+
+        lastX = px;
+        lastY = py;
+        hasLastPoint = true;
+    }
+}
+
+void PersistenceRaster::decayForElapsedTime()
+{
+    // The first frame after a clear counts as one tuned frame
+    const double now = juce::Time::getMillisecondCounterHiRes();
+    const double elapsedSeconds = lastDecayMs > 0.0 ? (now - lastDecayMs) * 0.001 : 1.0 / tunedFramesPerSecond;
+    lastDecayMs = now;
+
+    decay(std::pow(decayPerTunedFrame, (float)(elapsedSeconds * tunedFramesPerSecond)));
+}
+
+void PersistenceRaster::decay(float factor)
+{
+    const auto multiplier = (juce::uint16)juce::jlimit(0, 65535, static_cast<int>(factor * 65536.0f));
+    juce::uint16* data = hits.data();
+    const size_t size = hits.size();
+    size_t i = 0;
+
+    // cell = (cell * multiplier) >> 16, eight cells at a time
+   #if JUCE_USE_SSE_INTRINSICS
+    const __m128i m = _mm_set1_epi16((short)multiplier);
+    for (; i + 8 <= size; i += 8)
+    {
+        auto* p = reinterpret_cast<__m128i*>(data + i);
+        _mm_storeu_si128(p, _mm_mulhi_epu16(_mm_loadu_si128(p), m));
+    }
+   #elif JUCE_USE_ARM_NEON
+    const uint16x4_t m = vdup_n_u16(multiplier);
+    for (; i + 8 <= size; i += 8)
+    {
+        const uint16x8_t v = vld1q_u16(data + i);
+        const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(v), m), 16);
+        const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(v), m), 16);
+        vst1q_u16(data + i, vcombine_u16(lo, hi));
+    }
+   #endif
+
+    for (; i < size; ++i)
+        data[i] = (juce::uint16)(((juce::uint32)data[i] * multiplier) >> 16);
+}
+
+void PersistenceRaster::render(juce::Image& image) const
+{
+    if (width == 0 || height == 0)
+        return;
+
+    if (!image.isValid() || image.getWidth() != width || image.getHeight() != height)
+        image = juce::Image(juce::Image::ARGB, width, height, true);
+
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::writeOnly);
+
+    for (int y = 0; y < height; ++y)
+    {
+        auto* line = reinterpret_cast<juce::PixelARGB*>(bitmap.getLinePointer(y));
+        const juce::uint16* cell = hits.data() + y;
+
+        for (int x = 0; x < width; ++x)
+            line[x] = palette[(size_t)(cell[(size_t)x * (size_t)height] >> 8)];
+    }
+}
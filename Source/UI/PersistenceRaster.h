@@ -0,0 +1,63 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Digital phosphor accumulator: waveforms are rasterised into a uint16 hit-count buffer
+// that decays every frame and is drawn as a colour-graded image. The buffer is stored
+// column-major so that filling a vertical span touches contiguous memory.
+class PersistenceRaster
+{
+public:
+    PersistenceRaster();
+
+    void setSize(int newWidth, int newHeight);
+    void clear();
+
+    // Adds one acquisition spanning the full width. Pixel y = yOffset - sample * yScale.
+    void addTrace(const float* samples, int numSamples, float yScale, float yOffset);
+
+    // Integer Bresenham line in pixel coordinates, for XY style plots
+    void addLine(int x0, int y0, int x1, int y1);
+    void addPoint(int x, int y) noexcept;
+
+    // Connected polyline straight into the hit buffer, for dense XY plots: steps of at
+    // most one pixel (the common case at audio rates) are a single cell increment, only
+    // longer jumps fall back to addLine. Coordinates are pixels; the last point is kept
+    // so consecutive calls join up until resetPolyline().
+    void addPolyline(const float* x, const float* y, int numPoints) noexcept;
+    void resetPolyline() noexcept { hasLastPoint = false; }
+
+    // Multiplies every cell by factor (0..1)
+    void decay(float factor);
+
+    // Decays for the time since the previous call (or clear()), so the glow lasts as long
+    // whatever frame rate the display achieves
+    void decayForElapsedTime();
+
+    // Phosphor time constant: 0.88 per frame at the 30 Hz the views were tuned with
+    static constexpr float decayPerTunedFrame = 0.88f;
+    static constexpr double tunedFramesPerSecond = 30.0;
+
+    // Writes the colour-graded result into image (resized to match if needed)
+    void render(juce::Image& image) const;
+
+    int getWidth() const noexcept { return width; }
+    int getHeight() const noexcept { return height; }
+
+    static constexpr juce::uint16 hitIncrement = 512;
+
+private:
+    void fillSpan(int x, int yTop, int yBottom) noexcept;
+
+    int width = 0;
+    int height = 0;
+    std::vector<juce::uint16> hits; // column-major: hits[x * height + y]
+    std::vector<float> columnMin, columnMax;
+    std::array<juce::PixelARGB, 256> palette;
+
+    bool hasLastPoint = false;
+    int lastX = 0, lastY = 0;
+    double lastDecayMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PersistenceRaster)
+};
@@ -0,0 +1,53 @@
+#include "StatsOverlay.h"
+
+void StatsOverlay::draw(juce::Graphics& g, const ScopeStats& stats, juce::Rectangle<int> area)
+{
+    juce::StringArray lines;
+    lines.add("Triggers: " + juce::String((juce::int64)stats.triggersDetected) + "  (" + juce::String(stats.triggersPerSecond, 0) + " /s)");
+    lines.add("Waveforms: " + juce::String((juce::int64)stats.waveformsDrawn) + "  (" + juce::String(stats.waveformsPerSecond, 0) + " /s)");
+    lines.add("Dead time: " + juce::String(stats.deadTimeFraction * 100.0f, 1) + " %");
+    lines.add("FFT dropped: " + juce::String((juce::int64)stats.fftDroppedSamples) + " samples");
+    lines.add("Paint p50/p95/p99/max: " + juce::String(stats.paintMsP50, 2) + " / " + juce::String(stats.paintMsP95, 2)
+              + " / " + juce::String(stats.paintMsP99, 2) + " / " + juce::String(stats.paintMsMax, 2) + " ms");
+    lines.add("processBlock avg/max: " + juce::String(stats.processBlockUsAverage, 1) + " / "
+              + juce::String(stats.processBlockUsMax, 1) + " us  (" + juce::String(stats.processBlockLoad * 100.0f, 1) + " %)");
+
+    for (const auto& stage : stats.stageTimings)
+        lines.add("  " + juce::String(stage.name) + " p50/p99/max: " + juce::String(stage.p50Us, 1) + " / "
+                  + juce::String(stage.p99Us, 1) + " / " + juce::String(stage.maxUs, 1) + " us  ("
+                  + juce::String(stage.deadlineFraction * 100.0f, 2) + " %)");
+
+    if (!stats.stageTimings.empty())
+        lines.add("  Overruns: " + juce::String(stats.blockOverruns) + " blocks");
+
+    if (stats.recording || stats.recordedSamples > 0)
+        lines.add(juce::String(stats.recording ? "Recording: " : "Recorded: ") + juce::String((juce::int64)stats.recordedSamples)
+                  + " samples, overruns: " + juce::String(stats.recorderOverruns) + " ("
+                  + juce::String((juce::int64)stats.recorderDroppedSamples) + " samples dropped)");
+
+    if (!stats.recording && stats.recorderError.isNotEmpty())
+        lines.add("Recording stopped: " + stats.recorderError);
+
+    if (stats.historySeconds > 0.0f)
+        lines.add("Deep history: " + juce::String(stats.historySeconds / 60.0f, 1) + " min, lost: "
+                  + juce::String((juce::int64)stats.historyLostSamples) + " samples");
+
+    if (stats.playbackLoaded)
+        lines.add(juce::String(stats.playbackPlaying ? "Playback: " : "Playback (paused): ") + juce::String(stats.playbackSeconds, 1)
+                  + " / " + juce::String(stats.playbackLengthSeconds, 1) + " s at " + juce::String(stats.playbackSpeed) + "x"
+                  + (stats.playbackPlaying && stats.playbackPasses < stats.playbackSpeed
+                         ? " (reaching " + juce::String(stats.playbackPasses) + "x)" : juce::String()));
+
+    const int lineHeight = 14;
+    auto box = area.removeFromTop(lines.size() * lineHeight + 8).removeFromRight(340).reduced(4);
+
+    g.setColour(juce::Colours::black.withAlpha(0.6f));
+    g.fillRoundedRectangle(box.toFloat(), 4.0f);
+
+    g.setFont(11.0f);
+    g.setColour(juce::Colours::white.withAlpha(0.9f));
+
+    auto text = box.reduced(6, 2);
+    for (const auto& line : lines)
+        g.drawText(line, text.removeFromTop(lineHeight), juce::Justification::left);
+}
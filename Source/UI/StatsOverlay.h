@@ -0,0 +1,11 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../DSP/PerformanceCounters.h"
+
+class StatsOverlay
+{
+public:
+    // Draws the instrumentation counters in a translucent box at the top right of area
+    static void draw(juce::Graphics& g, const ScopeStats& stats, juce::Rectangle<int> area);
+};
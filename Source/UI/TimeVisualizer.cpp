@@ -3,10 +3,10 @@
 #include "../DSP/SignalAnalysis.h"
 
 TimeVisualizer::TimeVisualizer(OscilloscopeAudioProcessor& p)
-    : processor(p)
+    : processor(p), parameters(p.params.getSnapshot())
 {
     setOpaque(true);
-    startTimerHz(30);
+    traceRasterizer.setColour(Colors::PlotSection::timeResponse);
 }
 
 TimeVisualizer::~TimeVisualizer() {}
@@ -16,6 +16,7 @@ void TimeVisualizer::setModeDC(bool enabled)
     if (modeDC != enabled)
     {
         modeDC = enabled;
+        frameDirty = true;
         repaint();
     }
 }
@@ -24,22 +25,166 @@ void TimeVisualizer::setVerticalOffsetInDivisions(float offsetDivs)
 {
     const float pixelsPerDivision = getHeight() / 8.0f;
     verticalOffset = offsetDivs * pixelsPerDivision;
+    frameDirty = true;
     repaint();
 }
 
-void TimeVisualizer::timerCallback()
+void TimeVisualizer::frameCallback()
 {
+    // A parameter change (scale, trigger, filter) redraws even when no new audio arrived
+    const auto generation = processor.params.getGeneration();
+    if (generation != parameters.generation)
+    {
+        parameters = processor.params.getSnapshot();
+        frameDirty = true;
+    }
+
+    // The mask is held in divisions: a new scale, time base, offset or trigger level moves
+    // the signal under it, so the tester rebuilds its limits (or stops if it cannot)
+    if (processor.getMaskTester().isActive())
+        processor.getMaskTester().setGeometry(getMaskGeometry());
+
+    const bool bypass = processor.isBypassed();
+
+    if (bypass != lastBypass)
+    {
+        lastBypass = bypass;
+        frameDirty = true;
+        repaint();
+    }
+
+    if (bypass)
+        return;
+
+    const juce::int64 written = processor.getCircularBuffer().getTotalSamplesWritten();
+    if (written == lastFrameSample && !frameDirty)
+        return;
+
+    const bool newAcquisition = written != lastFrameSample;
+    lastFrameSample = written;
+    frameDirty = false;
+
     float triggerLevel = processor.getTriggerLevel();
-    bool useFilter = processor.params.movingAverageParam->get();
+    bool useFilter = parameters.movingAverage != 0;
     updateTriggerParameters(triggerLevel, 0.0f, useFilter);
 
-    if (isVisible())
+    updateFrame();
+    traceNeedsRaster = true;
+
+    if (persistence)
+        updatePersistence();
+    else if (newAcquisition && currentFrame.valid && !currentFrame.isDC && !equivalentTime && segmentIndex < 0 && !segmentOverlay)
+        processor.getPerformanceCounters().addWaveforms(1, currentFrame.displaySamples);
+
+    // Modes that draw over the whole plot, or frames without a usable trace, fall back
+    // to a full repaint; otherwise only the band swept by the old and new trace changes
+    const bool fullRepaint = persistence || equivalentTime || showStats
+                          || segmentIndex >= 0 || segmentOverlay || hitIndex >= 0 || processor.getMaskTester().isActive()
+                          || !currentFrame.valid;
+
+    if (fullRepaint)
+    {
+        lastDirtyBounds = getLocalBounds();
         repaint();
+        return;
+    }
+
+    const auto dirty = getDirtyBounds(currentFrame);
+    repaint(dirty.getUnion(lastDirtyBounds));
+    lastDirtyBounds = dirty;
+}
+
+juce::Rectangle<int> TimeVisualizer::getDirtyBounds(const TraceFrame& frame) const
+{
+    const int width = getWidth();
+    const int height = getHeight();
+    const float pixelsPerVolt = (height / 8.0f / parameters.getVerticalScaleInVolts()) * processor.getCalibrationFactor();
+    const float centerY = height / 2.0f;
+
+    // Band of every visible trace, padded for the stroke width
+    const float top = frame.minY;
+    const float bottom = frame.maxY;
+    juce::Rectangle<int> dirty(0, (int)std::floor(top) - 3, width, (int)std::ceil(bottom - top) + 6);
+
+    // Reference and trigger markers at the sides, offset marker along the top
+    const int markerStrip = 20;
+    const float refY = centerY - verticalOffset;
+    const float trigY = centerY - (currentTriggerLevel * pixelsPerVolt) - verticalOffset;
+    dirty = dirty.getUnion({ 0, (int)refY - markerStrip / 2, markerStrip, markerStrip });
+    dirty = dirty.getUnion({ width - markerStrip, (int)trigY - markerStrip / 2, markerStrip, markerStrip });
+    dirty = dirty.getUnion({ 0, 0, width, markerStrip });
+
+    // Measurement labels along the bottom
+    dirty = dirty.getUnion({ 0, height - 28, width, 28 });
+
+    return dirty.getIntersection(getLocalBounds());
+}
+
+void TimeVisualizer::resized()
+{
+    persistenceRaster.setSize(getWidth(), getHeight());
+    traceRasterizer.setSize(getWidth(), getHeight(), traceRasterizer.getScale());
+    traceNeedsRaster = true;
+    gridLayer = {};
+    referenceLayer = {};
+    frameDirty = true;
+}
+
+void TimeVisualizer::lookAndFeelChanged()
+{
+    gridLayer = {};
+    repaint();
+}
+
+void TimeVisualizer::mouseDown(const juce::MouseEvent& event)
+{
+    if (!event.mods.isPopupMenu())
+        return;
+
+    juce::Component::SafePointer<TimeVisualizer> safeThis(this);
+    ChannelMenu::show(processor, *this, [safeThis]
+    {
+        if (safeThis != nullptr)
+        {
+            safeThis->frameDirty = true;
+            safeThis->lastDirtyBounds = safeThis->getLocalBounds();
+            safeThis->repaint();
+        }
+    });
+}
+
+void TimeVisualizer::drawBackgroundLayer(juce::Graphics& g)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int w = juce::roundToInt(getWidth() * scale);
+    const int h = juce::roundToInt(getHeight() * scale);
+
+    if (w <= 0 || h <= 0)
+        return;
+
+    if (!gridLayer.isValid() || gridLayer.getWidth() != w || gridLayer.getHeight() != h || gridLayerScale != scale)
+    {
+        gridLayer = juce::Image(juce::Image::ARGB, w, h, true);
+        gridLayerScale = scale;
+
+        juce::Graphics lg(gridLayer);
+        lg.addTransform(juce::AffineTransform::scale(scale));
+
+        auto bounds = getLocalBounds().toFloat();
+        lg.setColour(Colors::PlotSection::background);
+        lg.fillRoundedRectangle(bounds, 8.0f);
+
+        drawGrid(lg, bounds);
+        lg.setColour(Colors::PlotSection::outline);
+        lg.drawRoundedRectangle(bounds, 8.0f, 4.0f);
+    }
+
+    g.drawImage(gridLayer, getLocalBounds().toFloat());
 }
 
 void TimeVisualizer::updateTriggerParameters(float level, float offset, bool filterEnabled)
 {
-    const float voltsPerDiv = processor.params.getVerticalScaleInVolts();
+    const float voltsPerDiv = parameters.getVerticalScaleInVolts();
     const float volts = level * voltsPerDiv; 
     const float uncalibrated = volts / processor.getCalibrationFactor(); 
 
@@ -146,134 +291,285 @@ void TimeVisualizer::drawGrid(juce::Graphics& g, juce::Rectangle<float> bounds)
     }
 }
 
-void TimeVisualizer::paint(juce::Graphics& g)
+void TimeVisualizer::updateFrame()
 {
-    const float calibrationFactor = processor.getCalibrationFactor();
+    TraceFrame& frame = currentFrame;
+    frame.valid = false;
 
     const float sampleRate = (float)processor.getSampleRate();
-    const float secondsPerDiv = processor.params.getHorizontalScaleInSeconds();
+    const float secondsPerDiv = parameters.getHorizontalScaleInSeconds();
     const float totalTime = secondsPerDiv * 10.0f;
     int displaySamples = static_cast<int>(totalTime * sampleRate);
 
-    juce::AudioBuffer<float> tempBuffer;
-    processor.getCircularBuffer().getMostRecentWindow(tempBuffer, displaySamples + 2048);
-    if (tempBuffer.getNumSamples() < 16) return;
+    // A search hit is shown from the history (deep or RAM) with the hit a tenth of the way
+    // in, or further right when it is among the newest samples; otherwise the most recent
+    // window, aligned on the trigger
+    const auto* hit = getShownHit();
+
+    if (hit != nullptr)
+    {
+        const auto& history = processor.getCaptureHistory();
+        const int windowSamples = displaySamples + 2048;
+        hitWindowStart = juce::jmax(history.getOldestSample(),
+                                    juce::jmin(hit->sample - displaySamples / 10, history.getTotalSamplesWritten() - windowSamples));
+        frameBuffer.setSize(history.getNumChannels(), windowSamples, false, false, true);
+        hitHeld = true;
+
+        for (int c = 0; c < frameBuffer.getNumChannels(); ++c)
+        {
+            if (!HistoryScan::copy(history, c, hitWindowStart, windowSamples, frameBuffer.getWritePointer(c)))
+            {
+                frameBuffer.clear(c, 0, windowSamples);
+                hitHeld = false;
+            }
+        }
+    }
+    else
+    {
+        processor.getCircularBuffer().getMostRecentWindow(frameBuffer, displaySamples + 2048);
+    }
 
-    juce::AudioBuffer<float> buffer = std::move(tempBuffer);
+    if (frameBuffer.getNumSamples() < 16 || frameBuffer.getNumChannels() == 0 || getWidth() <= 0)
+        return;
+
+    const juce::AudioBuffer<float>& buffer = frameBuffer;
     displaySamples = std::min(displaySamples, buffer.getNumSamples());
 
-    const float voltsPerDiv = processor.params.getVerticalScaleInVolts();
+    const float voltsPerDiv = parameters.getVerticalScaleInVolts();
     const float pixelsPerDiv = getHeight() / 8.0f;
-    const float pixelsPerVolt = (pixelsPerDiv / voltsPerDiv) * calibrationFactor;
+    const float pixelsPerVolt = (pixelsPerDiv / voltsPerDiv) * processor.getCalibrationFactor();
     const float centerY = getHeight() / 2.0f;
 
     const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), ChannelSettings::maxCaptureChannels);
+    const int triggerChannel = juce::jmin(processor.getTriggerChannel(), numChannels - 1);
 
-    auto bounds = getLocalBounds().toFloat();
-    g.setColour(Colors::PlotSection::background);
-    g.fillRoundedRectangle(bounds, 8.0f);
+    frame.isDC = modeDC;
+    frame.displaySamples = displaySamples;
+    frame.x.clear();
+    frame.channels.resize((size_t)numChannels);
 
-    drawGrid(g, bounds);
-    g.setColour(Colors::PlotSection::outline);
-    g.drawRoundedRectangle(bounds, 8.0f, 4.0f);
+    if (modeDC)
+    {
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const auto& settings = processor.getChannelSettings(c);
+            const float gain = pixelsPerVolt * settings.scale.load();
+            const float yOffset = centerY - verticalOffset - settings.offset.load() * pixelsPerDiv;
+            const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(c), numSamples);
+
+            auto& trace = frame.channels[(size_t)c];
+            trace.visible = processor.isChannelShown(c);
+            trace.dcY = yOffset - (range.getEnd() - range.getStart()) * gain;
+            trace.minY = yOffset - range.getEnd() * gain;
+            trace.maxY = yOffset - range.getStart() * gain;
+        }
+    }
+    else
+    {
+        // Single trigger search per frame on the trigger channel. The column boundaries are
+        // the same for every channel, so they are worked out once; each channel is then reduced
+        // to one min/max pair per pixel column with vectorised scans over contiguous runs
+        // of its own plane of the history.
+        const int triggerSample = hit != nullptr ? 0 : trigger.findTriggerPoint(buffer, triggerChannel);
+        const int offsetSamples = static_cast<int>(-horizontalOffset * secondsPerDiv * sampleRate);
+        const float pixelsPerSample = getWidth() / (totalTime * sampleRate);
+        const int start = ((triggerSample + offsetSamples) % numSamples + numSamples) % numSamples;
+        const bool onePointPerSample = displaySamples <= getWidth();
+
+        columnStarts.clear();
+
+        if (onePointPerSample)
+        {
+            for (int i = 0; i < displaySamples; ++i)
+                frame.x.push_back(i * pixelsPerSample);
+        }
+        else
+        {
+            const int numColumns = static_cast<int>((displaySamples - 1) * pixelsPerSample) + 1;
+            for (int column = 0; column < numColumns; ++column)
+            {
+                const int first = juce::jmin(displaySamples - 1, static_cast<int>(std::ceil(column / pixelsPerSample)));
+                if (!columnStarts.empty() && first <= columnStarts.back())
+                    continue;
 
-    float minY = std::numeric_limits<float>::max();
-    float maxY = std::numeric_limits<float>::lowest();
+                columnStarts.push_back(first);
+                frame.x.push_back(first * pixelsPerSample);
+            }
+            columnStarts.push_back(displaySamples);
+        }
 
-    float minVal = std::numeric_limits<float>::max();
-    float maxVal = std::numeric_limits<float>::lowest();
+        const int numPoints = (int)frame.x.size();
 
-    // ========== DRAW PREVIOUS SHOTS ========== //
+        for (int c = 0; c < numChannels; ++c)
+        {
+            const auto& settings = processor.getChannelSettings(c);
+            const float gain = pixelsPerVolt * settings.scale.load();
+            const float yOffset = centerY - verticalOffset - settings.offset.load() * pixelsPerDiv;
+            const float* data = buffer.getReadPointer(c);
 
-    for (size_t i = 0; i < snapshots.size(); ++i)
-    {
-        const auto& snap = snapshots[i];
+            auto& trace = frame.channels[(size_t)c];
+            trace.visible = processor.isChannelShown(c);
+            trace.yTop.resize((size_t)numPoints);
+            trace.yBottom.resize((size_t)numPoints);
 
-        // Draw the curve
-        g.setColour(snap.colour);
-        g.strokePath(snap.path, juce::PathStrokeType(1.5f));
+            if (onePointPerSample)
+            {
+                // y = yOffset - v * gain over the (at most two) contiguous runs
+                const int firstPart = juce::jmin(displaySamples, numSamples - start);
+                float* y = trace.yTop.data();
 
-        // Build the text with the measured values
-        juce::String label = "M" + juce::String(i + 1) + ": ";
+                juce::FloatVectorOperations::copyWithMultiply(y, data + start, -gain, firstPart);
+                if (firstPart < displaySamples)
+                    juce::FloatVectorOperations::copyWithMultiply(y + firstPart, data, -gain, displaySamples - firstPart);
 
-        if (snap.isDC)
-        {
-            label += "V = " + juce::String(snap.vpp, 2) + " V (DC)";
-        }
-        else
-        {
-            label += "Vpp = " + juce::String(snap.vpp, 2) + " V, ";
-            label += "Vrms = " + juce::String(snap.vrms, 2) + " V, ";
-            if (snap.frequency >= 1000.0f)
-                label += "Freq: " + juce::String(snap.frequency / 1000.0f, 2) + " kHz, ";
+                juce::FloatVectorOperations::add(y, yOffset, displaySamples);
+                std::copy(trace.yTop.begin(), trace.yTop.end(), trace.yBottom.begin());
+            }
             else
-                label += "Freq: " + juce::String(snap.frequency, 1) + " Hz, ";
-            label += "THD = " + juce::String(snap.thd, 2) + " %";
+            {
+                for (int k = 0; k < numPoints; ++k)
+                {
+                    const int first = (start + columnStarts[(size_t)k]) % numSamples;
+                    const int length = columnStarts[(size_t)k + 1] - columnStarts[(size_t)k];
+                    const int firstPart = juce::jmin(length, numSamples - first);
+
+                    auto range = juce::FloatVectorOperations::findMinAndMax(data + first, firstPart);
+                    if (firstPart < length)
+                        range = range.getUnionWith(juce::FloatVectorOperations::findMinAndMax(data, length - firstPart));
+
+                    trace.yTop[(size_t)k] = yOffset - range.getEnd() * gain;
+                    trace.yBottom[(size_t)k] = yOffset - range.getStart() * gain;
+                }
+            }
+
+            trace.minY = numPoints > 0 ? juce::FloatVectorOperations::findMinimum(trace.yTop.data(), numPoints) : yOffset;
+            trace.maxY = numPoints > 0 ? juce::FloatVectorOperations::findMaximum(trace.yBottom.data(), numPoints) : yOffset;
         }
+    }
 
-        // Draw the text at the top left
-        int labelX = 10;
-        int labelY = 10 + static_cast<int>(i) * 18;
+    // Band covered by the visible channels, for the dirty region
+    frame.minY = std::numeric_limits<float>::max();
+    frame.maxY = std::numeric_limits<float>::lowest();
 
-        g.setFont(12.0f);
-        g.drawText(label, labelX, labelY, getWidth() - 20, 16, juce::Justification::left);
+    for (const auto& trace : frame.channels)
+    {
+        if (!trace.visible)
+            continue;
+
+        frame.minY = std::min(frame.minY, frame.isDC ? trace.dcY : trace.minY);
+        frame.maxY = std::max(frame.maxY, frame.isDC ? trace.dcY : trace.maxY);
     }
 
-    // ========== WAVE DRAWING ========== //
-    const bool bypass = processor.apvts.getRawParameterValue(bypassParamID.getParamID())->load() > 0.5f;
+    if (frame.maxY < frame.minY)
+        frame.minY = frame.maxY = centerY;
+
+    // Measurements follow the trigger channel and are computed once per frame, shared by
+    // paint and snapshots. The view wraps that plane of the frame buffer without copying.
+    const auto& measured = frame.channels[(size_t)triggerChannel];
+    const juce::AudioBuffer<float> measuredChannel(frameBuffer.getArrayOfWritePointers() + triggerChannel, 1, numSamples);
+    const float rms = SignalAnalysis::computeRMS(measuredChannel, 1.0f);
+    frame.vpp = SignalAnalysis::computeVpp(measured.minY, measured.maxY, pixelsPerDiv * processor.getChannelSettings(triggerChannel).scale.load(), voltsPerDiv);
+    frame.vrms = processor.getCorrectedVoltage(rms);
+    frame.frequency = SignalAnalysis::computeFrequency(measuredChannel, sampleRate);
+    frame.thd = SignalAnalysis::computeTHD(measuredChannel, sampleRate, 11);
+    frame.valid = true;
+
+    lastVpp = frame.vpp;
+}
 
-    if (!bypass)
+void TimeVisualizer::drawTraceLayer(juce::Graphics& g, const TraceFrame& frame)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    if (scale != traceRasterizer.getScale() || !traceRasterizer.getImage().isValid())
+    {
+        traceRasterizer.setSize(getWidth(), getHeight(), scale);
+        traceNeedsRaster = true;
+    }
+
+    // Every visible channel goes into the one image: a single clear and a single blit
+    // per repaint however many channels are shown
+    if (traceNeedsRaster)
     {
-        if (modeDC)
+        traceRasterizer.clear();
+
+        for (size_t c = 0; c < frame.channels.size(); ++c)
         {
-            for (int c = 0; c < numChannels; ++c)
-            {
-                const float* data = buffer.getReadPointer(c);
-                for (int i = 0; i < numSamples; ++i)
-                {
-                    minVal = std::min(minVal, data[i]);
-                    maxVal = std::max(maxVal, data[i]);
-                }
-            }
+            const auto& trace = frame.channels[c];
+            if (!trace.visible)
+                continue;
 
-            float y = centerY - (maxVal - minVal) * pixelsPerVolt - verticalOffset;
-            minY = centerY - maxVal * pixelsPerVolt - verticalOffset;
-            maxY = centerY - minVal * pixelsPerVolt - verticalOffset;
-            g.setColour(Colors::PlotSection::dcResponse);
-            g.drawLine(0.0f, y, (float)getWidth(), y, 2.0f);
+            traceRasterizer.setColour(Colors::PlotSection::getChannelColour((int)c));
+            traceRasterizer.drawMinMax(frame.x.data(), trace.yTop.data(), trace.yBottom.data(), (int)frame.x.size());
         }
-        else
-        {
-            int triggerSample = trigger.findTriggerPoint(buffer, 0);
-            juce::Path path;
-            float timePerSample = 1.0f / sampleRate;
-            float pixelsPerSecond = getWidth() / totalTime;
-            int offsetSamples = static_cast<int>(-horizontalOffset * secondsPerDiv * sampleRate);
 
-            for (int i = 0; i < displaySamples; ++i)
-            {
-                int sampleIndex = triggerSample + offsetSamples + i;
-                while (sampleIndex >= numSamples) sampleIndex -= numSamples;
-                while (sampleIndex < 0) sampleIndex += numSamples;
+        traceNeedsRaster = false;
+    }
+
+    g.drawImage(traceRasterizer.getImage(), getLocalBounds().toFloat());
+}
+
+void TimeVisualizer::paint(juce::Graphics& g)
+{
+    ScopedPaintTimer paintTimer(processor.getPerformanceCounters());
+
+    const float voltsPerDiv = parameters.getVerticalScaleInVolts();
+    const float pixelsPerDiv = getHeight() / 8.0f;
+    const float pixelsPerVolt = (pixelsPerDiv / voltsPerDiv) * processor.getCalibrationFactor();
+    const float centerY = getHeight() / 2.0f;
 
-                float sum = 0.0f;
-                for (int c = 0; c < numChannels; ++c)
-                    sum += buffer.getSample(c, sampleIndex);
+    auto bounds = getLocalBounds().toFloat();
+    drawBackgroundLayer(g);
 
-                float t = i * timePerSample;
-                float x = t * pixelsPerSecond;
-                float y = centerY - (sum / numChannels) * pixelsPerVolt - verticalOffset;
+    // ========== DRAW PREVIOUS SHOTS ========== //
+    drawReferences(g);
 
-                if (i == 0) path.startNewSubPath(x, y);
-                else        path.lineTo(x, y);
+    const bool bypass = processor.isBypassed();
 
-                minY = std::min(minY, y);
-                maxY = std::max(maxY, y);
-            }
+    if (!bypass && !modeDC)
+        drawMask(g);
 
-            g.setColour(Colors::PlotSection::timeResponse);
-            g.strokePath(path, juce::PathStrokeType(2.0f));
+    // ========== WAVE DRAWING ========== //
+    const bool browsingSegments = segmentIndex >= 0 || segmentOverlay;
+    const TraceFrame& frame = currentFrame;
+
+    if (!bypass && browsingSegments)
+        drawSegments(g, pixelsPerVolt, centerY);
+
+    if (!bypass && !browsingSegments && equivalentTime && !modeDC)
+    {
+        drawEquivalentTime(g, pixelsPerVolt, centerY);
+
+        if (showStats)
+            StatsOverlay::draw(g, processor.getStats(), getLocalBounds().reduced(8));
+        return;
+    }
+
+    if (!bypass && !browsingSegments && frame.valid)
+    {
+        if (frame.isDC)
+        {
+            for (size_t c = 0; c < frame.channels.size(); ++c)
+            {
+                const auto& trace = frame.channels[c];
+                if (!trace.visible)
+                    continue;
+
+                g.setColour(c == 0 ? Colors::PlotSection::dcResponse : Colors::PlotSection::getChannelColour((int)c));
+                g.drawLine(0.0f, trace.dcY, (float)getWidth(), trace.dcY, 2.0f);
+            }
+        }
+        else
+        {
+            if (persistence)
+            {
+                g.drawImageAt(persistenceImage, 0, 0);
+            }
+            else
+            {
+                drawTraceLayer(g, frame);
+            }
 
             // ========== ARROWS (visual markers) ========== //
             const float markerSize = 8.0f;
@@ -309,17 +605,15 @@ void TimeVisualizer::paint(juce::Graphics& g)
     }
 
     // ========== MEASUREMENTS ========== //
-    if (!bypass)
+    if (!bypass && !browsingSegments && frame.valid)
     {
-        float calibratedVpp = SignalAnalysis::computeVpp(minY, maxY, pixelsPerDiv, voltsPerDiv);
-        float rms = SignalAnalysis::computeRMS(buffer, 1.0f);
-        float calibratedRMS = processor.getCorrectedVoltage(rms);
-        float frequencyHz = SignalAnalysis::computeFrequency(buffer, sampleRate);
-        float thdRatio = SignalAnalysis::computeTHD(buffer, sampleRate, 11);
-        lastVpp = calibratedVpp;
+        const float calibratedVpp = frame.vpp;
+        const float calibratedRMS = frame.vrms;
+        const float frequencyHz = frame.frequency;
+        const float thdRatio = frame.thd;
 
-        const int currentRange = processor.params.rangeValue;
-        const int currentIndex = processor.params.verticalScaleIndex;
+        const int currentRange = parameters.rangeValue;
+        const int currentIndex = parameters.verticalScaleIndex;
 
         juce::String labelLeft;
         if (currentRange >= 0 && currentRange < verticalScaleByRange.size()
@@ -335,7 +629,7 @@ void TimeVisualizer::paint(juce::Graphics& g)
         g.drawText(labelLeft, 8, getHeight() - 24, 100, 20, juce::Justification::left);
 
         // Label time s/div to bottom center
-        float sPerDiv = processor.params.getHorizontalScaleInSeconds();
+        float sPerDiv = parameters.getHorizontalScaleInSeconds();
         juce::String labelTime;
         if (sPerDiv >= 1.0f)
             labelTime = juce::String(sPerDiv, 1) + " s/div";
@@ -348,7 +642,7 @@ void TimeVisualizer::paint(juce::Graphics& g)
 
         // Merged tags at bottom right
         juce::String labelCombined;
-        if (modeDC)
+        if (frame.isDC)
         {
             if (calibratedVpp < 1.0f)
                 labelCombined = "DC: " + juce::String(calibratedVpp * 1000.0f, 2) + " mV";
@@ -369,144 +663,638 @@ void TimeVisualizer::paint(juce::Graphics& g)
 
         g.drawText(labelCombined, getWidth() - 580, getHeight() - 24, 570, 20, juce::Justification::right);
     }
+
+    if (!bypass && !browsingSegments)
+        drawSearchHitLabel(g);
+
+    if (showStats)
+        StatsOverlay::draw(g, processor.getStats(), getLocalBounds().reduced(8));
+}
+
+// Fills NaN columns by linear interpolation between the nearest known neighbours
+static void fillMissingColumns(float* values, int numValues)
+{
+    int previous = -1;
+
+    for (int i = 0; i <= numValues; ++i)
+    {
+        if (i < numValues && std::isnan(values[i]))
+            continue;
+
+        const int first = previous + 1;
+        for (int k = first; k < i; ++k)
+        {
+            if (previous < 0 && i < numValues)  values[k] = values[i];
+            else if (i >= numValues)            values[k] = previous >= 0 ? values[previous] : 0.0f;
+            else                                values[k] = values[previous] + (values[i] - values[previous]) * (k - previous) / (float)(i - previous);
+        }
+
+        previous = i;
+    }
 }
 
 void TimeVisualizer::captureCurrentPath()
 {
-    const float sampleRate = (float)processor.getSampleRate();
-    const float secondsPerDiv = processor.params.getHorizontalScaleInSeconds();
-    const float totalTime = secondsPerDiv * 10.0f;
-    int displaySamples = static_cast<int>(totalTime * sampleRate);
+    // Reuse the frame the live view already built: an O(width) reduction into a fixed
+    // size min/max record instead of re-running the trigger search and measurements.
+    // References hold one trace, channel 1, like the measurements.
+    if (!currentFrame.valid || currentFrame.channels.empty() || getWidth() <= 0)
+        return;
 
-    juce::AudioBuffer<float> tempBuffer;
-    processor.getCircularBuffer().getMostRecentWindow(tempBuffer, displaySamples + 2048);
-    if (tempBuffer.getNumSamples() < 16) return;
+    const auto& trace = currentFrame.channels.front();
+
+    constexpr int numColumns = ReferenceTraceStore::numColumns;
+    auto record = std::make_unique<ReferenceTraceStore::Record>(); // 8 kB, keep it off the stack
 
-    const float voltsPerDiv = processor.params.getVerticalScaleInVolts();
-    const float pixelsPerDiv = getHeight() / 8.0f;
-    const float pixelsPerVolt = (pixelsPerDiv / voltsPerDiv) * processor.getCalibrationFactor();
     const float centerY = getHeight() / 2.0f;
+    const float pixelsPerDiv = getHeight() / 8.0f;
+    auto toDivisions = [&](float y) { return (centerY - y) / pixelsPerDiv; };
 
-    const int numSamples = tempBuffer.getNumSamples();
-    const int numChannels = tempBuffer.getNumChannels();
-    const float timePerSample = 1.0f / sampleRate;
-    const float pixelsPerSecond = getWidth() / totalTime;
-    int offsetSamples = static_cast<int>(-horizontalOffset * secondsPerDiv * sampleRate);
+    if (currentFrame.isDC)
+    {
+        std::fill(record->top, record->top + numColumns, toDivisions(trace.dcY));
+        std::fill(record->bottom, record->bottom + numColumns, toDivisions(trace.dcY));
+    }
+    else
+    {
+        std::fill(record->top, record->top + numColumns, std::numeric_limits<float>::quiet_NaN());
+        std::fill(record->bottom, record->bottom + numColumns, std::numeric_limits<float>::quiet_NaN());
 
-    float minY = std::numeric_limits<float>::max();
-    float maxY = std::numeric_limits<float>::lowest();
+        const float columnsPerPixel = numColumns / (float)getWidth();
 
-    juce::Path newPath;
-    for (int i = 0; i < displaySamples; ++i)
-    {
-        int sampleIndex = trigger.findTriggerPoint(tempBuffer, 0) + offsetSamples + i;
-        while (sampleIndex >= numSamples) sampleIndex -= numSamples;
-        while (sampleIndex < 0) sampleIndex += numSamples;
+        for (size_t k = 0; k < currentFrame.x.size(); ++k)
+        {
+            const int column = juce::jlimit(0, numColumns - 1, static_cast<int>(currentFrame.x[k] * columnsPerPixel));
+            const float top = toDivisions(trace.yTop[k]);
+            const float bottom = toDivisions(trace.yBottom[k]);
 
-        float sum = 0.0f;
-        for (int c = 0; c < numChannels; ++c)
-            sum += tempBuffer.getSample(c, sampleIndex);
+            record->top[column] = std::isnan(record->top[column]) ? top : std::max(record->top[column], top);
+            record->bottom[column] = std::isnan(record->bottom[column]) ? bottom : std::min(record->bottom[column], bottom);
+        }
 
-        float value = sum / numChannels;
-        float t = i * timePerSample;
-        float x = t * pixelsPerSecond;
-        float y = centerY - value * pixelsPerVolt - verticalOffset;
+        fillMissingColumns(record->top, numColumns);
+        fillMissingColumns(record->bottom, numColumns);
+    }
 
-        minY = std::min(minY, y);
-        maxY = std::max(maxY, y);
+    record->colour = juce::Colour::fromHSV(juce::Random::getSystemRandom().nextFloat(), 0.9f, 0.9f, 1.0f).getARGB();
+    record->isDC = currentFrame.isDC ? 1 : 0;
+    record->vpp = currentFrame.vpp;
 
-        if (i == 0) newPath.startNewSubPath(x, y);
-        else        newPath.lineTo(x, y);
+    if (!currentFrame.isDC)
+    {
+        record->vrms = currentFrame.vrms;
+        record->frequency = currentFrame.frequency;
+        record->thd = currentFrame.thd * 100.0f;
     }
 
-    Snapshot snap;
-    snap.colour = juce::Colour::fromHSV(juce::Random::getSystemRandom().nextFloat(), 0.9f, 0.9f, 1.0f);
-    snap.isDC = modeDC;
+    processor.getReferenceStore().add(*record);
+    repaint();
+}
 
-    if (modeDC)
+void TimeVisualizer::clearSnapshots()
+{
+    processor.getReferenceStore().clear();
+    repaint();
+}
+
+void TimeVisualizer::drawReferences(juce::Graphics& g)
+{
+    // References are in divisions, so their image only changes with the store, the size
+    // or the display scale; it is rendered once at physical resolution, like the grid
+    const auto& store = processor.getReferenceStore();
+    if (store.size() == 0 || getWidth() <= 0 || getHeight() <= 0)
+        return;
+
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int w = juce::roundToInt(getWidth() * scale);
+    const int h = juce::roundToInt(getHeight() * scale);
+
+    if (!referenceLayer.isValid() || referenceLayer.getWidth() != w || referenceLayer.getHeight() != h
+        || referenceLayerScale != scale || referenceLayerChange != store.getChangeCount())
     {
-        Snapshot snap;
-        snap.colour = juce::Colour::fromHSV(juce::Random::getSystemRandom().nextFloat(), 0.9f, 0.9f, 1.0f);
-        snap.isDC = true;
-        snap.vpp = lastVpp;
+        referenceLayer = juce::Image(juce::Image::ARGB, w, h, true);
+        referenceLayerScale = scale;
+        referenceLayerChange = store.getChangeCount();
 
-        float minVal = std::numeric_limits<float>::max();
-        float maxVal = std::numeric_limits<float>::lowest();
+        juce::Graphics lg(referenceLayer);
+        lg.addTransform(juce::AffineTransform::scale(scale));
+        renderReferences(lg);
+    }
 
-        for (int c = 0; c < numChannels; ++c)
+    g.drawImage(referenceLayer, getLocalBounds().toFloat());
+}
+
+void TimeVisualizer::renderReferences(juce::Graphics& g)
+{
+    const auto& store = processor.getReferenceStore();
+    const int count = store.size();
+    const int width = getWidth();
+    if (count == 0 || width <= 0)
+        return;
+
+    constexpr int numColumns = ReferenceTraceStore::numColumns;
+    const float centerY = getHeight() / 2.0f;
+    const float pixelsPerDiv = getHeight() / 8.0f;
+    const float columnsPerPixel = numColumns / (float)width;
+
+    // Only the most recent references that fit get a text label
+    const int maxLabels = juce::jmax(0, (getHeight() - 60) / 18);
+    const int firstLabelled = juce::jmax(0, count - maxLabels);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const auto& snap = store.get(i);
+
+        // Draw the curve, one min/max pair per pixel column
+        referencePath.clear();
+        for (int x = 0; x < width; ++x)
         {
-            const float* data = tempBuffer.getReadPointer(c);
-            for (int i = 0; i < tempBuffer.getNumSamples(); ++i)
+            const int begin = juce::jmin(numColumns - 1, static_cast<int>(x * columnsPerPixel));
+            const int end = juce::jlimit(begin + 1, numColumns, static_cast<int>((x + 1) * columnsPerPixel));
+
+            float top = snap.top[begin];
+            float bottom = snap.bottom[begin];
+            for (int c = begin + 1; c < end; ++c)
             {
-                minVal = std::min(minVal, data[i]);
-                maxVal = std::max(maxVal, data[i]);
+                top = std::max(top, snap.top[c]);
+                bottom = std::min(bottom, snap.bottom[c]);
             }
+
+            const float yTop = centerY - top * pixelsPerDiv;
+            const float yBottom = centerY - bottom * pixelsPerDiv;
+            if (x == 0) referencePath.startNewSubPath((float)x, yTop);
+            else        referencePath.lineTo((float)x, yTop);
+
+            if (yBottom != yTop)
+                referencePath.lineTo((float)x, yBottom);
         }
 
-        const float pixelsPerVolt = (pixelsPerDiv / voltsPerDiv) * processor.getCalibrationFactor();
-        const float centerY = getHeight() / 2.0f;
+        g.setColour(juce::Colour(snap.colour));
+        g.strokePath(referencePath, juce::PathStrokeType(1.5f));
 
-        float y = centerY - (maxVal - minVal) * pixelsPerVolt - verticalOffset;
+        if (i < firstLabelled)
+            continue;
+
+        // Build the text with the measured values
+        juce::String label = "M" + juce::String(i + 1) + ": ";
 
-        juce::Path dcPath;
-        dcPath.startNewSubPath(0.0f, y);
-        dcPath.lineTo((float)getWidth(), y);
-        snap.path = dcPath;
+        if (snap.isDC != 0)
+        {
+            label += "V = " + juce::String(snap.vpp, 2) + " V (DC)";
+        }
+        else
+        {
+            label += "Vpp = " + juce::String(snap.vpp, 2) + " V, ";
+            label += "Vrms = " + juce::String(snap.vrms, 2) + " V, ";
+            if (snap.frequency >= 1000.0f)
+                label += "Freq: " + juce::String(snap.frequency / 1000.0f, 2) + " kHz, ";
+            else
+                label += "Freq: " + juce::String(snap.frequency, 1) + " Hz, ";
+            label += "THD = " + juce::String(snap.thd, 2) + " %";
+        }
 
-        snapshots.push_back(snap);
-        while (snapshots.size() > maxSnapshots)
-            snapshots.erase(snapshots.begin());
+        // Draw the text at the top left
+        int labelX = 10;
+        int labelY = 10 + (i - firstLabelled) * 18;
 
-        repaint();
-        return;
+        g.setFont(12.0f);
+        g.drawText(label, labelX, labelY, getWidth() - 20, 16, juce::Justification::left);
     }
+}
+
+void TimeVisualizer::showSegment(int index)
+{
+    segmentIndex = index;
+    repaint();
+}
+
+void TimeVisualizer::stepSegment(int delta)
+{
+    const int numCaptured = processor.getSegmentedCapture().getNumCaptured();
+
+    // Stepping past either end goes back to the live trace
+    if (segmentIndex < 0)
+        segmentIndex = delta > 0 ? 0 : numCaptured - 1;
+    else
+        segmentIndex += delta;
+
+    if (segmentIndex >= numCaptured)
+        segmentIndex = -1;
+
+    repaint();
+}
+
+void TimeVisualizer::showSearchHit(int index)
+{
+    hitIndex = index;
+    frameDirty = true;
+    repaint();
+}
 
+void TimeVisualizer::stepSearchHit(int delta)
+{
+    const auto& search = processor.getEventSearch();
+    const int numHits = search.isRunning() ? 0 : (int)search.getHits().size();
+
+    // Stepping past either end goes back to the live trace
+    if (hitIndex < 0)
+        hitIndex = delta > 0 ? 0 : numHits - 1;
     else
+        hitIndex += delta;
+
+    if (hitIndex >= numHits)
+        hitIndex = -1;
+
+    frameDirty = true;
+    repaint();
+}
+
+const EventSearch::Hit* TimeVisualizer::getShownHit() const
+{
+    // The hits are only stable once the search has finished
+    const auto& search = processor.getEventSearch();
+    if (hitIndex < 0 || search.isRunning() || hitIndex >= (int)search.getHits().size())
+        return nullptr;
+
+    return &search.getHits()[(size_t)hitIndex];
+}
+
+void TimeVisualizer::drawSearchHitLabel(juce::Graphics& g)
+{
+    const auto* hit = getShownHit();
+    if (hit == nullptr)
+        return;
+
+    const auto& search = processor.getEventSearch();
+    const double sampleRate = processor.getSampleRate();
+    const double age = sampleRate > 0.0 ? (processor.getCaptureHistory().getTotalSamplesWritten() - hit->sample) / sampleRate : 0.0;
+
+    juce::String label = "HIT " + juce::String(hitIndex + 1) + " / " + juce::String((int)search.getHits().size())
+                       + "   " + EventSearch::describe(search.getQuery())
+                       + "   t = -" + juce::String(age, 3) + " s";
+
+    if (hit->length > 0 && sampleRate > 0.0)
+        label << "   length " << juce::String(hit->length / sampleRate * 1.0e6, 1) << " us";
+
+    if (!hitHeld)
+        label << "   (no longer held)";
+
+    g.setColour(juce::Colours::orange);
+
+    // Tick above the hit's first sample
+    if (hitHeld && sampleRate > 0.0)
+    {
+        const double secondsPerDiv = parameters.getHorizontalScaleInSeconds();
+        const double offsetSamples = -horizontalOffset * secondsPerDiv * sampleRate;
+        const float x = (float)((hit->sample - hitWindowStart - offsetSamples) * getWidth() / (secondsPerDiv * 10.0 * sampleRate));
+
+        if (x >= 0.0f && x <= (float)getWidth())
+            g.drawLine(x, 38.0f, x, 52.0f, 2.0f);
+    }
+
+    g.setFont(12.0f);
+    g.drawText(label, 10, 20, getWidth() - 20, 16, juce::Justification::left);
+}
+
+MaskTester::Geometry TimeVisualizer::getMaskGeometry() const
+{
+    // References hold channel 1, so that is the channel the mask tests; the inverse of the
+    // y = yOffset - v * gain mapping in updateFrame(), in divisions
+    const float sampleRate = (float)processor.getSampleRate();
+    const float secondsPerDiv = parameters.getHorizontalScaleInSeconds();
+    const float pixelsPerDiv = getHeight() / 8.0f;
+    const auto& settings = processor.getChannelSettings(0);
+
+    MaskTester::Geometry geometry;
+    geometry.channel = 0;
+    geometry.triggerChannel = processor.getTriggerChannel();
+    geometry.triggerLevel = processor.getTriggerLevelInSignalDomain();
+    geometry.windowSamples = static_cast<int>(secondsPerDiv * MaskTester::numHorizontalDivisions * sampleRate);
+    geometry.offsetSamples = static_cast<int>(-horizontalOffset * secondsPerDiv * sampleRate);
+    geometry.valuePerDivision = parameters.getVerticalScaleInVolts() / (processor.getCalibrationFactor() * settings.scale.load());
+    geometry.offsetDivisions = (pixelsPerDiv > 0.0f ? verticalOffset / pixelsPerDiv : 0.0f) + settings.offset.load();
+    return geometry;
+}
+
+void TimeVisualizer::drawMask(juce::Graphics& g)
+{
+    const auto& tester = processor.getMaskTester();
+    if (!tester.isActive())
+        return;
+
+    constexpr int numColumns = MaskTester::numColumns;
+    const float pixelsPerDiv = getHeight() / 8.0f;
+    const float pixelsPerColumn = getWidth() / (float)numColumns;
+
+    // The polygon as it was drawn when the test started, divisions to pixels
+    const auto toScreen = juce::AffineTransform::scale(getWidth() / MaskTester::numHorizontalDivisions, -pixelsPerDiv)
+                              .translated(0.0f, getHeight() / 2.0f);
+
+    juce::Path outline(tester.getPolygon());
+    outline.applyTransform(toScreen);
+
+    g.setColour(juce::Colours::limegreen.withAlpha(0.12f));
+    g.fillPath(outline);
+    g.setColour(juce::Colours::limegreen.withAlpha(0.6f));
+    g.strokePath(outline, juce::PathStrokeType(1.0f));
+
+    // Columns where acquisitions left the mask, brighter the more often
+    juce::uint32 worst = 0;
+    for (int column = 0; column < numColumns; ++column)
+        worst = juce::jmax(worst, tester.getColumnFailures(column));
+
+    if (worst > 0)
     {
-        // AC Mode 
-        float minY = std::numeric_limits<float>::max();
-        float maxY = std::numeric_limits<float>::lowest();
-        juce::Path newPath;
+        for (int column = 0; column < numColumns; ++column)
+        {
+            const auto failures = tester.getColumnFailures(column);
+            if (failures == 0)
+                continue;
+
+            g.setColour(juce::Colours::red.withAlpha(0.3f + 0.7f * failures / (float)worst));
+            g.fillRect(column * pixelsPerColumn, (float)getHeight() - 50.0f, juce::jmax(1.0f, pixelsPerColumn), 4.0f);
+        }
+    }
+
+    const auto counts = tester.getCounts();
+    juce::String label = "MASK  tested " + juce::String((juce::int64)counts.tested)
+                       + "   pass " + juce::String((juce::int64)counts.passed)
+                       + "   fail " + juce::String((juce::int64)counts.failed);
+
+    if (counts.tested > 0)
+        label << " (" << juce::String(100.0 * (double)counts.failed / (double)counts.tested, 3) << " %)";
+
+    label << "   violations " << juce::String((juce::int64)counts.violations);
+
+    if (counts.skipped > 0)
+        label << "   skipped " << juce::String((juce::int64)counts.skipped);
+
+    g.setColour(counts.failed > 0 ? juce::Colours::red : juce::Colours::limegreen);
+    g.setFont(12.0f);
+    g.drawText(label, 10, getHeight() - 44, getWidth() - 20, 16, juce::Justification::left);
+}
+
+void TimeVisualizer::setSegmentOverlay(bool enabled)
+{
+    segmentOverlay = enabled;
+    repaint();
+}
+
+void TimeVisualizer::drawSegments(juce::Graphics& g, float pixelsPerVolt, float centerY)
+{
+    const auto& capture = processor.getSegmentedCapture();
+    const juce::uint32 generation = capture.beginRead();
+    const int numCaptured = capture.getNumCaptured();
+    const int length = capture.getSegmentLength();
+    const float width = (float)getWidth();
 
-        for (int i = 0; i < displaySamples; ++i)
+    juce::String label = "SEG ";
+
+    // Segments are only read once the capture is complete; the audio thread owns them
+    // while it is armed
+    if (capture.isComplete() && length > 1)
+    {
+        const int first = segmentOverlay ? 0 : juce::jlimit(0, numCaptured - 1, segmentIndex);
+        const int last = segmentOverlay ? numCaptured - 1 : first;
+        const float samplesPerPixel = length / width;
+
+        // One path for every visible segment; long segments are reduced to a min/max
+        // envelope per pixel column so the cost stays proportional to the width
+        juce::Path path;
+        for (int s = first; s <= last; ++s)
         {
-            int sampleIndex = trigger.findTriggerPoint(tempBuffer, 0) + offsetSamples + i;
-            while (sampleIndex >= numSamples) sampleIndex -= numSamples;
-            while (sampleIndex < 0) sampleIndex += numSamples;
+            const float* data = capture.getSegmentData(s, 0);
 
-            float sum = 0.0f;
-            for (int c = 0; c < numChannels; ++c)
-                sum += tempBuffer.getSample(c, sampleIndex);
+            if (samplesPerPixel <= 1.0f)
+            {
+                for (int i = 0; i < length; ++i)
+                {
+                    float x = i * width / (length - 1);
+                    float y = centerY - data[i] * pixelsPerVolt - verticalOffset;
+                    if (i == 0) path.startNewSubPath(x, y);
+                    else        path.lineTo(x, y);
+                }
+            }
+            else
+            {
+                for (int column = 0; column < getWidth(); ++column)
+                {
+                    const int begin = static_cast<int>(column * samplesPerPixel);
+                    const int end = juce::jmin(length, static_cast<int>((column + 1) * samplesPerPixel) + 1);
+                    const auto range = juce::FloatVectorOperations::findMinAndMax(data + begin, end - begin);
+
+                    float yMax = centerY - range.getEnd() * pixelsPerVolt - verticalOffset;
+                    float yMin = centerY - range.getStart() * pixelsPerVolt - verticalOffset;
+                    if (column == 0) path.startNewSubPath((float)column, yMax);
+                    else             path.lineTo((float)column, yMax);
+                    path.lineTo((float)column, yMin);
+                }
+            }
+        }
 
-            float value = sum / numChannels;
-            float t = i * timePerSample;
-            float x = t * pixelsPerSecond;
-            float y = centerY - value * pixelsPerVolt - verticalOffset;
+        const float alpha = segmentOverlay ? juce::jlimit(0.05f, 1.0f, 8.0f / numCaptured) : 1.0f;
+        const float trigX = width * capture.getPreTriggerSamples() / (float)length;
 
-            minY = std::min(minY, y);
-            maxY = std::max(maxY, y);
+        if (segmentOverlay)
+        {
+            label += "overlay " + juce::String(numCaptured) + " / " + juce::String(capture.getNumRequested());
+        }
+        else
+        {
+            const auto segment = capture.getSegment(first);
+            label += juce::String(first + 1) + " / " + juce::String(numCaptured);
+            label += "   t = " + juce::String(segment.timestamp, 4) + " s";
+            if (first > 0)
+                label += "   dt = " + juce::String((segment.timestamp - capture.getSegment(first - 1).timestamp) * 1000.0, 3) + " ms";
+        }
 
-            if (i == 0) newPath.startNewSubPath(x, y);
-            else        newPath.lineTo(x, y);
+        // Re-armed while reading: what was read may be half overwritten, draw the next frame
+        if (capture.endRead() != generation)
+        {
+            repaint();
+            return;
         }
 
-        snap.path = newPath;
-        snap.vpp = SignalAnalysis::computeVpp(minY, maxY, pixelsPerDiv, voltsPerDiv);
-        snap.vrms = SignalAnalysis::computeRMS(tempBuffer, processor.getCalibrationFactor());
-        snap.frequency = SignalAnalysis::computeFrequency(tempBuffer, sampleRate);
-        snap.thd = SignalAnalysis::computeTHD(tempBuffer, sampleRate) * 100.0f;
+        g.setColour(Colors::PlotSection::timeResponse.withAlpha(alpha));
+        g.strokePath(path, juce::PathStrokeType(segmentOverlay ? 1.0f : 2.0f));
+
+        // Trigger position inside the segment
+        g.setColour(juce::Colours::gold.withAlpha(0.6f));
+        g.drawVerticalLine(juce::roundToInt(trigX), 0.0f, (float)getHeight());
+    }
+    else if (capture.isArmed())
+    {
+        label += numCaptured > 0 ? juce::String(numCaptured) + " / " + juce::String(capture.getNumRequested()) + " captured"
+                                 : juce::String("armed, waiting for trigger");
+    }
+    else
+    {
+        label += "empty";
     }
 
+    if (capture.isArmed())
+        label += "   (armed)";
 
-    snapshots.push_back(snap);
-    while (snapshots.size() > maxSnapshots)
-        snapshots.erase(snapshots.begin());
+    g.setFont(14.0f);
+    g.setColour(juce::Colours::orange);
+    g.drawText(label, 8, getHeight() - 24, getWidth() - 16, 20, juce::Justification::left);
+}
 
+void TimeVisualizer::setEquivalentTime(bool enabled)
+{
+    equivalentTime = enabled;
+    processor.getEquivalentTimeSampler().setEnabled(enabled);
     repaint();
 }
 
-void TimeVisualizer::clearSnapshots()
+void TimeVisualizer::drawEquivalentTime(juce::Graphics& g, float pixelsPerVolt, float centerY)
+{
+    const double periodSamples = processor.getEquivalentTimeSampler().getFoldedPeriod(foldedPeriod);
+    const int numBins = static_cast<int>(foldedPeriod.size());
+
+    g.setFont(14.0f);
+    g.setColour(juce::Colours::orange);
+
+    if (periodSamples <= 0.0 || numBins == 0)
+    {
+        g.drawText("ET: waiting for a periodic signal", 8, getHeight() - 24, getWidth() - 16, 20, juce::Justification::left);
+        return;
+    }
+
+    const double sampleRate = processor.getSampleRate();
+    const double secondsPerDiv = parameters.getHorizontalScaleInSeconds();
+    const double totalSamples = secondsPerDiv * 10.0 * sampleRate;
+    const double samplesPerPixel = totalSamples / getWidth();
+    const double offsetSamples = -horizontalOffset * secondsPerDiv * sampleRate;
+
+    // Each pixel column maps back to a phase of the folded period; bins not reached
+    // yet (NaN) leave a gap instead of a wrong value
+    juce::Path path;
+    bool penDown = false;
+
+    for (int column = 0; column < getWidth(); ++column)
+    {
+        double phase = std::fmod(offsetSamples + column * samplesPerPixel, periodSamples) / periodSamples;
+        if (phase < 0.0)
+            phase += 1.0;
+
+        const float value = foldedPeriod[(size_t)juce::jlimit(0, numBins - 1, static_cast<int>(phase * numBins))];
+        if (std::isnan(value))
+        {
+            penDown = false;
+            continue;
+        }
+
+        const float y = centerY - value * pixelsPerVolt - verticalOffset;
+        if (penDown) path.lineTo((float)column, y);
+        else         path.startNewSubPath((float)column, y);
+        penDown = true;
+    }
+
+    g.setColour(Colors::PlotSection::timeResponse);
+    g.strokePath(path, juce::PathStrokeType(2.0f));
+
+    const double frequency = sampleRate / periodSamples;
+    const double effectiveRate = numBins * frequency;
+
+    juce::String label = "ET   Freq: ";
+    label += frequency >= 1000.0 ? juce::String(frequency / 1000.0, 4) + " kHz" : juce::String(frequency, 3) + " Hz";
+    label += "   Eq. rate: " + juce::String(effectiveRate / 1.0e6, 2) + " MS/s";
+
+    g.setColour(juce::Colours::orange);
+    g.drawText(label, 8, getHeight() - 24, getWidth() - 16, 20, juce::Justification::left);
+}
+
+void TimeVisualizer::setPersistence(bool enabled)
 {
-    snapshots.clear();
+    persistence = enabled;
+    persistenceRaster.clear();
+    lastPersistenceSample = -1;
     repaint();
 }
+
+void TimeVisualizer::updatePersistence()
+{
+    auto& history = processor.getCircularBuffer();
+    const float sampleRate = (float)processor.getSampleRate();
+    const float secondsPerDiv = parameters.getHorizontalScaleInSeconds();
+    const int displaySamples = static_cast<int>(secondsPerDiv * 10.0f * sampleRate);
+    const juce::int64 written = history.getTotalSamplesWritten();
+
+    persistenceRaster.decayForElapsedTime();
+
+    if (lastPersistenceSample < 0 || lastPersistenceSample > written)
+        lastPersistenceSample = written;
+
+    // Every acquisition that started since the previous frame, limited by what the
+    // history still holds
+    const int newSamples = static_cast<int>(juce::jmin<juce::int64>(written - lastPersistenceSample,
+                                                                    history.getCapacity() - displaySamples));
+
+    // Only the trigger channel is read, in place through the history spans, and clear of the
+    // oldest end the audio thread may be overwriting
+    const int available = static_cast<int>(juce::jmin<juce::int64>(newSamples + displaySamples,
+                                                                   written - history.getOldestIntactSample()));
+    const int channel = juce::jmin(processor.getTriggerChannel(), history.getNumChannels() - 1);
+    HistorySpans spans;
+
+    if (newSamples > 0 && displaySamples > 1 && available > displaySamples
+        && history.getSpans(channel, written - available, available, spans))
+    {
+        const int lastStart = available - displaySamples + 1; // last complete acquisition + 1
+
+        // The ring wraps at most once in the window: sample i is in the first run below split
+        const float* first = spans.parts[0].data;
+        const int split = spans.parts[0].size;
+        const float* second = spans.count > 1 ? spans.parts[1].data : nullptr;
+        const auto sampleAt = [&](int i) { return i < split ? first[i] : second[i - split]; };
+
+        // Persistence accumulates the trigger channel, with its scale and offset
+        const auto& settings = processor.getChannelSettings(channel);
+        const float voltsPerDiv = parameters.getVerticalScaleInVolts();
+        const float pixelsPerDiv = getHeight() / 8.0f;
+        const float pixelsPerVolt = (pixelsPerDiv / voltsPerDiv) * processor.getCalibrationFactor() * settings.scale.load();
+        const float yOffset = getHeight() / 2.0f - verticalOffset - settings.offset.load() * pixelsPerDiv;
+
+        // Rearm once an acquisition is complete, like a scope's trigger holdoff, so the
+        // work per frame stays proportional to the number of new samples
+        int searchFrom = juce::jmax(1, available - newSamples);
+        int acquisitions = 0;
+        while (searchFrom < lastStart)
+        {
+            int hit = -1;
+            if (searchFrom < split)
+                hit = trigger.findNextTrigger(first, searchFrom, juce::jmin(lastStart, split), sampleAt(searchFrom - 1));
+
+            if (hit < 0 && lastStart > split)
+            {
+                const int from = juce::jmax(searchFrom, split);
+                const int found = trigger.findNextTrigger(second, from - split, lastStart - split, sampleAt(from - 1));
+                hit = found < 0 ? -1 : found + split;
+            }
+
+            if (hit < 0)
+                break;
+
+            // Only an acquisition across the wrap is copied, to make it contiguous
+            const float* trace = hit < split ? first + hit : second + (hit - split);
+            if (hit < split && hit + displaySamples > split)
+            {
+                persistenceSeam.resize((size_t)displaySamples);
+                std::copy(first + hit, first + split, persistenceSeam.begin());
+                std::copy(second, second + (hit + displaySamples - split), persistenceSeam.begin() + (split - hit));
+                trace = persistenceSeam.data();
+            }
+
+            persistenceRaster.addTrace(trace, displaySamples, pixelsPerVolt, yOffset);
+            searchFrom = hit + displaySamples;
+            ++acquisitions;
+        }
+
+        processor.getPerformanceCounters().addWaveforms(acquisitions, displaySamples);
+
+        lastPersistenceSample = written - (available - juce::jmax(searchFrom, lastStart));
+    }
+
+    persistenceRaster.render(persistenceImage);
+}
@@ -4,21 +4,27 @@
 #include "../PluginProcessor.h"
 #include "../DSP/Trigger.h"
 #include "LookAndFeel.h"
+#include "PersistenceRaster.h"
+#include "StatsOverlay.h"
+#include "FrameScheduler.h"
+#include "TraceRasterizer.h"
+#include "ChannelMenu.h"
 
-class TimeVisualizer : public juce::Component,
-    public juce::Timer
+class TimeVisualizer : public juce::Component
 {
 public:
     TimeVisualizer(OscilloscopeAudioProcessor& processor);
     ~TimeVisualizer() override;
 
     void paint(juce::Graphics&) override;
-    void timerCallback() override;
+    void resized() override;
+    void lookAndFeelChanged() override;
+    void mouseDown(const juce::MouseEvent& event) override;
 
-    void setVerticalGain(float gain) { verticalGain = gain; }
-    void setVerticalOffset(float offset) { verticalOffset = offset; }
-    void setHorizontalScale(float scale) { horizontalScale = scale; }
-    void setHorizontalOffset(float offset) { horizontalOffset = offset; }
+    void setVerticalGain(float gain) { verticalGain = gain; frameDirty = true; }
+    void setVerticalOffset(float offset) { verticalOffset = offset; frameDirty = true; }
+    void setHorizontalScale(float scale) { horizontalScale = scale; frameDirty = true; }
+    void setHorizontalOffset(float offset) { horizontalOffset = offset; frameDirty = true; }
     void setVerticalOffsetInDivisions(float divisions);
 
     void updateTriggerParameters(float level, float offset, bool filterEnabled);
@@ -35,23 +41,79 @@ public:
 
     void captureCurrentPath();
     void clearSnapshots();
-    
-    struct Snapshot
+
+    // Segment browser: index -1 shows the live trace
+    void showSegment(int index);
+    void stepSegment(int delta);
+    void setSegmentOverlay(bool enabled);
+
+    // Event search hits: index -1 shows the live trace, otherwise the history around
+    // that hit of the processor's last search
+    void showSearchHit(int index);
+    void stepSearchHit(int delta);
+    int getSearchHitIndex() const { return hitIndex; }
+
+    // Where a mask drawn in divisions falls on the samples with the current time base,
+    // trigger and channel 1 scale, for MaskTester::start()
+    MaskTester::Geometry getMaskGeometry() const;
+
+    // Equivalent-time mode for repetitive signals
+    void setEquivalentTime(bool enabled);
+
+    // Digital phosphor: every triggered acquisition accumulates into a decaying image
+    void setPersistence(bool enabled);
+
+    void setShowStats(bool enabled) { showStats = enabled; repaint(); }
+
+    // Called on vblank while visible: rebuilds the frame only when new audio arrived
+    // (or the view settings changed) and repaints just the regions it touched. Offline
+    // renderers call it directly before taking a snapshot.
+    void frameCallback();
+
+
+private:
+    // One input channel of a frame, with its own scale and offset already applied
+    struct ChannelTrace
+    {
+        bool visible = true;
+        std::vector<float> yTop, yBottom;
+        float minY = 0.0f, maxY = 0.0f;
+        float dcY = 0.0f;
+    };
+
+    // Everything the live view derives from one acquisition: every channel reduced to at
+    // most one min/max pair per pixel column (sharing the column positions) plus the
+    // measurements of channel 1. Built once per new frame and reused by paint() and
+    // captureCurrentPath().
+    struct TraceFrame
     {
-        juce::Path path;
-        juce::Colour colour;
+        bool valid = false;
+        bool isDC = false;
+        int displaySamples = 0;
+
+        std::vector<float> x;
+        std::vector<ChannelTrace> channels;
+        float minY = 0.0f, maxY = 0.0f;   // union over the visible channels
+
         float vpp = 0.0f;
         float vrms = 0.0f;
         float frequency = 0.0f;
-        float thd = 0.0f;
-        bool isDC = false; 
+        float thd = 0.0f; // ratio
     };
 
-    std::vector<Snapshot> snapshots;
-    static constexpr int maxSnapshots = 10;
+    void updateFrame();
+    juce::Rectangle<int> getDirtyBounds(const TraceFrame& frame) const;
+    void drawTraceLayer(juce::Graphics& g, const TraceFrame& frame);
 
+    void drawReferences(juce::Graphics& g);
+    void renderReferences(juce::Graphics& g);
+    void drawSegments(juce::Graphics& g, float pixelsPerVolt, float centerY);
+    void drawEquivalentTime(juce::Graphics& g, float pixelsPerVolt, float centerY);
+    void updatePersistence();
+    const EventSearch::Hit* getShownHit() const;
+    void drawSearchHitLabel(juce::Graphics& g);
+    void drawMask(juce::Graphics& g);
 
-private:
     OscilloscopeAudioProcessor& processor;
     Trigger trigger;
 
@@ -63,5 +125,48 @@ private:
 
     bool modeDC = false;
 
+    TraceFrame currentFrame;
+    std::vector<int> columnStarts;  // first display sample of each column, plus the end
+    TraceRasterizer traceRasterizer;
+    bool traceNeedsRaster = true;
+    juce::int64 lastFrameSample = -1;
+    juce::Rectangle<int> lastDirtyBounds;
+    bool frameDirty = true;
+    bool lastBypass = false;
+    ParameterSnapshot parameters;   // refreshed when the processor publishes a new generation
+    juce::AudioBuffer<float> frameBuffer;
+    juce::Path referencePath;
+
+    int segmentIndex = -1;
+    bool segmentOverlay = false;
+
+    int hitIndex = -1;
+    bool hitHeld = false;       // the history still held the samples around the hit
+    juce::int64 hitWindowStart = 0;
+
+    bool equivalentTime = false;
+    std::vector<float> foldedPeriod;
+
+    bool showStats = false;
+
+    // Background, graticule and outline rendered once at physical resolution; only
+    // rebuilt when the size, display scale or look-and-feel changes.
+    void drawBackgroundLayer(juce::Graphics& g);
+    juce::Image gridLayer;
+    float gridLayerScale = 0.0f;
+
+    // References, re-rendered only when the store changes (or the size or display scale)
+    juce::Image referenceLayer;
+    float referenceLayerScale = 0.0f;
+    juce::uint32 referenceLayerChange = 0;
+
+    bool persistence = false;
+    PersistenceRaster persistenceRaster;
+    juce::Image persistenceImage;
+    std::vector<float> persistenceSeam;     // the one acquisition per frame that straddles the ring's wrap
+    juce::int64 lastPersistenceSample = -1;
+
+    FrameScheduler frameScheduler { *this, [this] { frameCallback(); } };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeVisualizer)
 };
\ No newline at end of file
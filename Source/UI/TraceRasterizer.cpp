@@ -0,0 +1,197 @@
+#include "TraceRasterizer.h"
+
+TraceRasterizer::TraceRasterizer()
+{
+    setColour(colour);
+}
+
+void TraceRasterizer::setSize(int newWidth, int newHeight, float newScale)
+{
+    const int w = juce::jmax(0, juce::roundToInt(newWidth * newScale));
+    const int h = juce::jmax(0, juce::roundToInt(newHeight * newScale));
+
+    scale = newScale;
+
+    if (w == width && h == height && image.isValid())
+        return;
+
+    width = w;
+    height = h;
+    image = (width > 0 && height > 0) ? juce::Image(juce::Image::ARGB, width, height, true) : juce::Image();
+
+    columnMin.assign((size_t)width, std::numeric_limits<float>::max());
+    columnMax.assign((size_t)width, std::numeric_limits<float>::lowest());
+    pendingFirst = std::numeric_limits<int>::max();
+    pendingLast = -1;
+    drawnLeft = drawnTop = std::numeric_limits<int>::max();
+    drawnRight = drawnBottom = -1;
+}
+
+void TraceRasterizer::setColour(juce::Colour newColour)
+{
+    colour = newColour;
+
+    // Premultiplied colour for every coverage level, so span ends are a table lookup
+    for (int i = 0; i < 256; ++i)
+        coverageColours[(size_t)i] = colour.withMultipliedAlpha(i / 255.0f).getPixelARGB();
+}
+
+void TraceRasterizer::clear()
+{
+    if (drawnRight < drawnLeft || !image.isValid())
+        return;
+
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::writeOnly);
+    const size_t bytes = (size_t)(drawnRight - drawnLeft + 1) * sizeof(juce::PixelARGB);
+
+    for (int y = drawnTop; y <= drawnBottom; ++y)
+        std::memset(bitmap.getPixelPointer(drawnLeft, y), 0, bytes);
+
+    drawnLeft = drawnTop = std::numeric_limits<int>::max();
+    drawnRight = drawnBottom = -1;
+}
+
+juce::Rectangle<int> TraceRasterizer::getDrawnBounds() const noexcept
+{
+    if (drawnRight < drawnLeft)
+        return {};
+
+    return juce::Rectangle<float>((float)drawnLeft, (float)drawnTop,
+                                  (float)(drawnRight - drawnLeft + 1), (float)(drawnBottom - drawnTop + 1))
+        .transformedBy(juce::AffineTransform::scale(1.0f / scale))
+        .getSmallestIntegerContainer();
+}
+
+void TraceRasterizer::drawPolyline(const float* x, const float* y, int numPoints)
+{
+    if (width == 0 || numPoints <= 0)
+        return;
+
+    if (numPoints == 1)
+        addSegment(x[0], y[0], x[0], y[0]);
+
+    for (int i = 1; i < numPoints; ++i)
+        addSegment(x[i - 1], y[i - 1], x[i], y[i]);
+
+    flushColumns();
+}
+
+void TraceRasterizer::drawMinMax(const float* x, const float* yTop, const float* yBottom, int numPoints)
+{
+    if (width == 0 || numPoints <= 0)
+        return;
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        if (i > 0)
+            addSegment(x[i - 1], yBottom[i - 1], x[i], yTop[i]);
+
+        addSegment(x[i], yTop[i], x[i], yBottom[i]);
+    }
+
+    flushColumns();
+}
+
+void TraceRasterizer::addToColumn(int column, float y0, float y1) noexcept
+{
+    if (column < 0 || column >= width)
+        return;
+
+    columnMin[(size_t)column] = std::min(columnMin[(size_t)column], std::min(y0, y1));
+    columnMax[(size_t)column] = std::max(columnMax[(size_t)column], std::max(y0, y1));
+    pendingFirst = std::min(pendingFirst, column);
+    pendingLast = std::max(pendingLast, column);
+}
+
+void TraceRasterizer::addSegment(float x0, float y0, float x1, float y1) noexcept
+{
+    x0 *= scale; y0 *= scale;
+    x1 *= scale; y1 *= scale;
+
+    if (x1 < x0)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    const int first = (int)std::floor(x0);
+    const int last = (int)std::floor(x1);
+
+    if (last < 0 || first >= width)
+        return;
+
+    if (first == last)
+    {
+        addToColumn(first, y0, y1);
+        return;
+    }
+
+    // y range of the segment inside each column it crosses
+    const float slope = (y1 - y0) / (x1 - x0);
+    const int from = std::max(first, 0);
+    const int to = std::min(last, width - 1);
+
+    for (int c = from; c <= to; ++c)
+    {
+        const float left = std::max(x0, (float)c);
+        const float right = std::min(x1, (float)(c + 1));
+        addToColumn(c, y0 + (left - x0) * slope, y0 + (right - x0) * slope);
+    }
+}
+
+void TraceRasterizer::flushColumns()
+{
+    if (pendingLast < pendingFirst || !image.isValid())
+        return;
+
+    juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::readWrite);
+    const float halfThickness = 0.5f * thickness * scale;
+    const juce::PixelARGB solid = coverageColours[255];
+
+    for (int c = pendingFirst; c <= pendingLast; ++c)
+    {
+        float& lo = columnMin[(size_t)c];
+        float& hi = columnMax[(size_t)c];
+
+        if (hi < lo)
+            continue;
+
+        const float top = std::max(lo - halfThickness, 0.0f);
+        const float bottom = std::min(hi + halfThickness, (float)height);
+        lo = std::numeric_limits<float>::max();
+        hi = std::numeric_limits<float>::lowest();
+
+        if (bottom <= top)
+            continue;
+
+        const int firstRow = (int)top;
+        const int lastRow = std::min((int)std::ceil(bottom), height) - 1;
+
+        for (int r = firstRow; r <= lastRow; ++r)
+        {
+            const float coverage = std::min((float)(r + 1), bottom) - std::max((float)r, top);
+            auto* pixel = reinterpret_cast<juce::PixelARGB*>(bitmap.getPixelPointer(c, r));
+
+            // Interior pixels are written outright; only the two fractional ends combine
+            // with what an earlier call may have left there
+            if (coverage >= 1.0f)
+            {
+                *pixel = solid;
+            }
+            else
+            {
+                const auto& edge = coverageColours[(size_t)juce::jlimit(0, 255, (int)(coverage * 255.0f + 0.5f))];
+                if (edge.getAlpha() > pixel->getAlpha())
+                    *pixel = edge;
+            }
+        }
+
+        drawnLeft = std::min(drawnLeft, c);
+        drawnRight = std::max(drawnRight, c);
+        drawnTop = std::min(drawnTop, firstRow);
+        drawnBottom = std::max(drawnBottom, lastRow);
+    }
+
+    pendingFirst = std::numeric_limits<int>::max();
+    pendingLast = -1;
+}
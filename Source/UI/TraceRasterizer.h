@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// CPU rasteriser for single-valued traces (time-domain waveforms, spectra). Each segment
+// only widens a per-column [min, max] interval; the intervals are then written into a
+// persistent ARGB image as vertical spans with fractional coverage at both ends. That
+// is one pass over the touched columns with no path flattening, edge tables or
+// per-pixel blending, so it is much cheaper than Graphics::strokePath and needs no GPU.
+class TraceRasterizer
+{
+public:
+    TraceRasterizer();
+
+    // Image size in logical pixels and the physical scale to rasterise at. Input
+    // coordinates stay in logical pixels.
+    void setSize(int newWidth, int newHeight, float newScale = 1.0f);
+
+    void setColour(juce::Colour newColour);
+    void setThickness(float logicalPixels) noexcept { thickness = logicalPixels; }
+
+    // Erases what the previous draw calls touched, leaving the rest of the image alone
+    void clear();
+
+    // Polyline with non-decreasing x
+    void drawPolyline(const float* x, const float* y, int numPoints);
+
+    // Per-column min/max pairs as produced by the time view's frame reduction: the trace
+    // runs from each column's bottom to the next column's top, then down its own span
+    void drawMinMax(const float* x, const float* yTop, const float* yBottom, int numPoints);
+
+    const juce::Image& getImage() const noexcept { return image; }
+
+    // Logical-pixel area covered since the last clear()
+    juce::Rectangle<int> getDrawnBounds() const noexcept;
+
+    float getScale() const noexcept { return scale; }
+
+private:
+    void addSegment(float x0, float y0, float x1, float y1) noexcept;
+    void addToColumn(int column, float y0, float y1) noexcept;
+    void flushColumns();
+
+    juce::Image image;
+    int width = 0;   // physical pixels
+    int height = 0;
+    float scale = 1.0f;
+    float thickness = 2.0f;
+
+    std::vector<float> columnMin, columnMax;
+    int pendingFirst = std::numeric_limits<int>::max(), pendingLast = -1;
+
+    // Area already written into the image, in physical pixels
+    int drawnLeft = std::numeric_limits<int>::max(), drawnRight = -1;
+    int drawnTop = std::numeric_limits<int>::max(), drawnBottom = -1;
+
+    juce::Colour colour { juce::Colours::white };
+    std::array<juce::PixelARGB, 256> coverageColours;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceRasterizer)
+};
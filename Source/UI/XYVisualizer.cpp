@@ -0,0 +1,256 @@
+#include <JuceHeader.h>
+#include "XYVisualizer.h"
+
+XYVisualizer::XYVisualizer(OscilloscopeAudioProcessor& p)
+    : processor(p), parameters(p.params.getSnapshot())
+{
+    setOpaque(true);
+}
+
+XYVisualizer::~XYVisualizer() {}
+
+void XYVisualizer::resized()
+{
+    raster.setSize(getWidth(), getHeight());
+    gridLayer = {};
+    lastSample = -1;
+}
+
+void XYVisualizer::lookAndFeelChanged()
+{
+    gridLayer = {};
+    repaint();
+}
+
+void XYVisualizer::setPersistence(bool enabled)
+{
+    persistence = enabled;
+    raster.clear();
+    lastSample = -1;
+    repaint();
+}
+
+void XYVisualizer::frameCallback()
+{
+    bool changed = false;
+
+    const auto generation = processor.params.getGeneration();
+    if (generation != parameters.generation)
+    {
+        parameters = processor.params.getSnapshot();
+        changed = true;
+    }
+
+    const bool bypass = processor.isBypassed();
+    if (bypass != lastBypass)
+    {
+        lastBypass = bypass;
+        repaint();
+    }
+
+    if (bypass)
+        return;
+
+    // With persistence the image decays on every frame, by the time elapsed, even while no
+    // audio arrives (a stopped transport)
+    const juce::int64 written = processor.getCircularBuffer().getTotalSamplesWritten();
+    if (written == lastSample && !changed && !persistence)
+        return;
+
+    updateRaster();
+    repaint();
+}
+
+void XYVisualizer::updateRaster()
+{
+    auto& history = processor.getCircularBuffer();
+    const juce::int64 written = history.getTotalSamplesWritten();
+    const int limit = juce::jmin(history.getCapacity(), maxSamplesPerFrame);
+    const int windowSamples = juce::jlimit(2, juce::jmax(2, limit),
+                                           static_cast<int>(parameters.getHorizontalScaleInSeconds() * 10.0f * processor.getSampleRate()));
+
+    // Without persistence the frame is the current time-base window; with it, only what
+    // arrived since the previous frame is added to the decaying image
+    int numSamples = windowSamples;
+
+    if (persistence)
+    {
+        raster.decayForElapsedTime();
+        if (lastSample >= 0 && lastSample <= written)
+            numSamples = static_cast<int>(juce::jmin<juce::int64>(written - lastSample, limit));
+    }
+    else
+    {
+        raster.clear();
+    }
+
+    lastSample = written;
+
+    // Nothing new: the image only decays, and the last phase reading stands
+    if (persistence && numSamples == 0)
+    {
+        raster.render(rasterImage);
+        return;
+    }
+
+    hasPhase = false;
+
+    if (processor.getNumInputChannels() < 2 || numSamples <= 0 || getWidth() <= 0 || getHeight() <= 0)
+    {
+        raster.render(rasterImage);
+        return;
+    }
+
+    // Only the two plotted channels are read, in place through the history spans; both
+    // planes share the ring position, so their spans line up part for part
+    numSamples = static_cast<int>(juce::jmin<juce::int64>(numSamples, written - history.getOldestSample()));
+
+    HistorySpans xSpans, ySpans;
+    if (numSamples <= 0 || !history.getSpans(0, written - numSamples, numSamples, xSpans)
+        || !history.getSpans(1, written - numSamples, numSamples, ySpans) || xSpans.count != ySpans.count)
+    {
+        raster.render(rasterImage);
+        return;
+    }
+
+    const auto& xSettings = processor.getChannelSettings(0);
+    const auto& ySettings = processor.getChannelSettings(1);
+    const float voltsPerDiv = parameters.getVerticalScaleInVolts();
+    const float calibration = processor.getCalibrationFactor();
+    const float pixelsPerDivX = getWidth() / 10.0f;
+    const float pixelsPerDivY = getHeight() / 8.0f;
+
+    const float gainX = pixelsPerDivX / voltsPerDiv * calibration * xSettings.scale.load();
+    const float gainY = -pixelsPerDivY / voltsPerDiv * calibration * ySettings.scale.load();
+    const float offsetX = getWidth() / 2.0f + xSettings.offset.load() * pixelsPerDivX;
+    const float offsetY = getHeight() / 2.0f - (parameters.verticalPosition + ySettings.offset.load()) * pixelsPerDivY;
+
+    // Volts to pixels a chunk at a time with vector ops, then straight into the hit buffer
+    constexpr int chunkSize = 4096;
+    pixelX.resize(chunkSize);
+    pixelY.resize(chunkSize);
+    raster.resetPolyline();
+
+    double sumX = 0.0, sumY = 0.0, sumXY = 0.0, sumXX = 0.0, sumYY = 0.0;
+
+    for (int part = 0; part < xSpans.count; ++part)
+    {
+        const float* xData = xSpans.parts[(size_t)part].data;
+        const float* yData = ySpans.parts[(size_t)part].data;
+        const int partSize = xSpans.parts[(size_t)part].size;
+
+        for (int start = 0; start < partSize; start += chunkSize)
+        {
+            const int n = juce::jmin(chunkSize, partSize - start);
+
+            juce::FloatVectorOperations::copyWithMultiply(pixelX.data(), xData + start, gainX, n);
+            juce::FloatVectorOperations::add(pixelX.data(), offsetX, n);
+            juce::FloatVectorOperations::copyWithMultiply(pixelY.data(), yData + start, gainY, n);
+            juce::FloatVectorOperations::add(pixelY.data(), offsetY, n);
+
+            raster.addPolyline(pixelX.data(), pixelY.data(), n);
+        }
+
+        for (int i = 0; i < partSize; ++i)
+        {
+            sumX += xData[i];
+            sumY += yData[i];
+            sumXY += (double)xData[i] * yData[i];
+            sumXX += (double)xData[i] * xData[i];
+            sumYY += (double)yData[i] * yData[i];
+        }
+    }
+
+    processor.getPerformanceCounters().addWaveforms(1, numSamples);
+
+    // Correlation of the channels with their means removed, so a DC offset does not skew it
+    const double covXY = sumXY - sumX * sumY / numSamples;
+    const double varX = sumXX - sumX * sumX / numSamples;
+    const double varY = sumYY - sumY * sumY / numSamples;
+
+    if (varX > 1.0e-12 && varY > 1.0e-12)
+    {
+        const double correlation = juce::jlimit(-1.0, 1.0, covXY / std::sqrt(varX * varY));
+        phaseDegrees = (float)juce::radiansToDegrees(std::acos(correlation));
+        hasPhase = true;
+    }
+
+    raster.render(rasterImage);
+}
+
+void XYVisualizer::drawGridLayer(juce::Graphics& g)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int w = juce::roundToInt(getWidth() * scale);
+    const int h = juce::roundToInt(getHeight() * scale);
+
+    if (w <= 0 || h <= 0)
+        return;
+
+    if (!gridLayer.isValid() || gridLayer.getWidth() != w || gridLayer.getHeight() != h || gridLayerScale != scale)
+    {
+        gridLayer = juce::Image(juce::Image::ARGB, w, h, true);
+        gridLayerScale = scale;
+
+        juce::Graphics lg(gridLayer);
+        lg.addTransform(juce::AffineTransform::scale(scale));
+
+        const auto bounds = getLocalBounds().toFloat();
+        lg.setColour(Colors::PlotSection::background);
+        lg.fillRoundedRectangle(bounds, 8.0f);
+
+        // Same 10 x 8 division graticule as the time view, with both axes emphasised
+        lg.setColour(juce::Colours::white.withAlpha(0.2f));
+        for (int i = 1; i < 10; ++i)
+            lg.drawVerticalLine(juce::roundToInt(bounds.getWidth() * i / 10.0f), bounds.getY(), bounds.getBottom());
+        for (int i = 1; i < 8; ++i)
+            lg.drawHorizontalLine(juce::roundToInt(bounds.getHeight() * i / 8.0f), bounds.getX(), bounds.getRight());
+
+        lg.setColour(juce::Colours::white.withAlpha(0.5f));
+        lg.drawVerticalLine(juce::roundToInt(bounds.getCentreX()), bounds.getY(), bounds.getBottom());
+        lg.drawHorizontalLine(juce::roundToInt(bounds.getCentreY()), bounds.getX(), bounds.getRight());
+
+        lg.setColour(Colors::PlotSection::outline);
+        lg.drawRoundedRectangle(bounds, 8.0f, 4.0f);
+    }
+
+    g.drawImage(gridLayer, getLocalBounds().toFloat());
+}
+
+void XYVisualizer::paint(juce::Graphics& g)
+{
+    ScopedPaintTimer paintTimer(processor.getPerformanceCounters());
+
+    drawGridLayer(g);
+
+    if (!processor.isBypassed())
+    {
+        if (rasterImage.isValid())
+            g.drawImageAt(rasterImage, 0, 0);
+
+        juce::String label;
+        if (processor.getNumInputChannels() < 2)
+        {
+            label = "XY needs two input channels";
+        }
+        else
+        {
+            const int range = parameters.rangeValue;
+            const int index = parameters.verticalScaleIndex;
+
+            label = "XY   X: CH1   Y: CH2";
+            if (range >= 0 && range < (int)verticalScaleByRange.size() && index >= 0 && index < (int)verticalScaleByRange[(size_t)range].size())
+                label += "   " + verticalScaleByRange[(size_t)range][(size_t)index].first;
+
+            if (hasPhase)
+                label += "   Phase: " + juce::String(phaseDegrees, 1) + juce::String::fromUTF8(" \xc2\xb0");
+        }
+
+        g.setFont(14.0f);
+        g.setColour(juce::Colours::orange);
+        g.drawText(label, 8, getHeight() - 24, getWidth() - 16, 20, juce::Justification::left);
+    }
+
+    if (showStats)
+        StatsOverlay::draw(g, processor.getStats(), getLocalBounds().reduced(8));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+#include "LookAndFeel.h"
+#include "PersistenceRaster.h"
+#include "StatsOverlay.h"
+#include "FrameScheduler.h"
+
+// Lissajous display: channel 1 on the horizontal axis against channel 2 on the vertical
+// axis, both in the common V/div with their own channel scale and offset. Samples come
+// straight from the capture history and are accumulated into a PersistenceRaster, so
+// the cost per frame is one pass over the new samples whatever their number. Without
+// persistence each frame shows the current time-base window; with it, every new sample
+// is added to a decaying image.
+class XYVisualizer : public juce::Component
+{
+public:
+    XYVisualizer(OscilloscopeAudioProcessor& processor);
+    ~XYVisualizer() override;
+
+    void paint(juce::Graphics&) override;
+    void resized() override;
+    void lookAndFeelChanged() override;
+
+    void setPersistence(bool enabled);
+    void setShowStats(bool enabled) { showStats = enabled; repaint(); }
+
+    // Called on vblank while visible; offline renderers call it directly
+    void frameCallback();
+
+private:
+    void updateRaster();
+    void drawGridLayer(juce::Graphics& g);
+
+    OscilloscopeAudioProcessor& processor;
+    ParameterSnapshot parameters;
+
+    PersistenceRaster raster;
+    juce::Image rasterImage;
+    std::vector<float> pixelX, pixelY;
+    juce::int64 lastSample = -1;
+    bool persistence = false;
+    bool lastBypass = false;
+
+    // Phase between the two channels from the correlation of their AC parts (sinusoids only)
+    float phaseDegrees = 0.0f;
+    bool hasPhase = false;
+
+    juce::Image gridLayer;
+    float gridLayerScale = 0.0f;
+
+    bool showStats = false;
+
+    static constexpr int maxSamplesPerFrame = 1 << 20;
+
+    FrameScheduler frameScheduler { *this, [this] { frameCallback(); } };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(XYVisualizer)
+};
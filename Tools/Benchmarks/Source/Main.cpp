@@ -0,0 +1,292 @@
+// Microbenchmarks for the DSP hot paths. Every case is run across a grid of block sizes
+// and sample rates on a deterministic 1 kHz sine (plus a little noise so the moving
+// average and trigger paths see realistic data) and reported as JSON, one record per
+// case/block/rate, so ns/sample can be tracked from run to run.
+//
+//   Benchmarks [--out results.json] [--filter name] [--quick]
+
+#include <JuceHeader.h>
+#include "../../../Source/DSP/CircularAudioBuffer.h"
+#include "../../../Source/DSP/Trigger.h"
+#include "../../../Source/DSP/SignalAnalysis.h"
+#include "../../../Source/DSP/FFT.h"
+#include "../../../Source/DSP/SignalGenerator.h"
+#include "../../Common/TestSignals.h"
+
+namespace
+{
+    const int blockSizes[] = { 64, 256, 1024, 4096 };
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+
+    struct Settings
+    {
+        double secondsPerBatch = 0.05;
+        int batches = 7;
+        juce::String filter;
+    };
+
+    struct Result
+    {
+        juce::String name;
+        int blockSize = 0;
+        double sampleRate = 0.0;
+        int samplesPerCall = 0;   // 0 when the cost does not scale with the block
+        double nsPerCall = 0.0;   // median over batches
+        double nsPerCallMin = 0.0;
+        juce::int64 calls = 0;
+    };
+
+    // Keeps results alive so the optimiser cannot drop the work being measured
+    volatile float sink = 0.0f;
+
+    template <typename Function>
+    Result measure(const Settings& settings, const juce::String& name, int blockSize, double sampleRate,
+                   int samplesPerCall, Function&& function)
+    {
+        // Warm-up, then size the batch so it lasts roughly secondsPerBatch
+        juce::int64 callsPerBatch = 1;
+        for (;;)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (juce::int64 i = 0; i < callsPerBatch; ++i)
+                function();
+            const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            if (elapsed >= settings.secondsPerBatch * 0.5 || callsPerBatch >= (juce::int64)1 << 30)
+            {
+                callsPerBatch = juce::jmax((juce::int64)1, (juce::int64)(callsPerBatch * settings.secondsPerBatch / juce::jmax(elapsed, 1.0e-9)));
+                break;
+            }
+
+            callsPerBatch *= 2;
+        }
+
+        std::vector<double> nsPerCall;
+
+        for (int b = 0; b < settings.batches; ++b)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (juce::int64 i = 0; i < callsPerBatch; ++i)
+                function();
+            const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            nsPerCall.push_back(elapsed * 1.0e9 / (double)callsPerBatch);
+        }
+
+        std::sort(nsPerCall.begin(), nsPerCall.end());
+
+        Result r;
+        r.name = name;
+        r.blockSize = blockSize;
+        r.sampleRate = sampleRate;
+        r.samplesPerCall = samplesPerCall;
+        r.nsPerCall = nsPerCall[nsPerCall.size() / 2];
+        r.nsPerCallMin = nsPerCall.front();
+        r.calls = callsPerBatch * settings.batches;
+        return r;
+    }
+
+    juce::AudioBuffer<float> makeSignal(int numChannels, int numSamples, double sampleRate)
+    {
+        TestSignals::Spec spec;
+        spec.frequency = 1000.0f;
+        spec.amplitude = 0.5f;
+
+        juce::AudioBuffer<float> buffer(numChannels, numSamples);
+        TestSignals::Generator(spec, sampleRate).render(buffer);
+
+        juce::Random random(42);
+        for (int c = 0; c < numChannels; ++c)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.addSample(c, i, (random.nextFloat() - 0.5f) * 0.01f);
+
+        return buffer;
+    }
+
+    void runAll(const Settings& settings, std::vector<Result>& results)
+    {
+        auto wanted = [&](const juce::String& name)
+        {
+            return settings.filter.isEmpty() || name.containsIgnoreCase(settings.filter);
+        };
+
+        auto add = [&](Result r)
+        {
+            std::cerr << r.name << " block " << r.blockSize << " @ " << r.sampleRate << ": "
+                      << juce::String(r.nsPerCall, 1) << " ns/call" << std::endl;
+            results.push_back(std::move(r));
+        };
+
+        for (const double sampleRate : sampleRates)
+        {
+            for (const int blockSize : blockSizes)
+            {
+                const auto signal = makeSignal(2, blockSize, sampleRate);
+
+                if (wanted("CircularAudioBuffer::pushBlock"))
+                {
+                    CircularAudioBuffer history;
+                    history.prepare(2, (int)(sampleRate * 10.0));
+                    add(measure(settings, "CircularAudioBuffer::pushBlock", blockSize, sampleRate, blockSize,
+                                [&] { history.pushBlock(signal); }));
+                }
+
+                if (wanted("CircularAudioBuffer::getMostRecentWindow"))
+                {
+                    CircularAudioBuffer history;
+                    history.prepare(2, (int)(sampleRate * 10.0));
+                    for (int filled = 0; filled < (int)sampleRate; filled += blockSize)
+                        history.pushBlock(signal);
+
+                    juce::AudioBuffer<float> window;
+                    add(measure(settings, "CircularAudioBuffer::getMostRecentWindow", blockSize, sampleRate, blockSize,
+                                [&] { history.getMostRecentWindow(window, blockSize); sink = sink + window.getSample(0, 0); }));
+                }
+
+                for (const bool filtered : { false, true })
+                {
+                    const juce::String name = filtered ? "Trigger::findTriggerPoint (moving average)" : "Trigger::findTriggerPoint";
+                    if (!wanted(name))
+                        continue;
+
+                    Trigger trigger;
+                    trigger.setParameters(0.1f, 0.0f, filtered);
+                    add(measure(settings, name, blockSize, sampleRate, blockSize,
+                                [&] { sink = sink + (float)trigger.findTriggerPoint(signal, 0); }));
+                }
+
+                if (wanted("SignalAnalysis::computeRMS"))
+                    add(measure(settings, "SignalAnalysis::computeRMS", blockSize, sampleRate, blockSize,
+                                [&] { sink = sink + SignalAnalysis::computeRMS(signal, 1.0f); }));
+
+                if (wanted("SignalAnalysis::computeFrequency"))
+                    add(measure(settings, "SignalAnalysis::computeFrequency", blockSize, sampleRate, blockSize,
+                                [&] { sink = sink + SignalAnalysis::computeFrequency(signal, (float)sampleRate); }));
+
+                if (wanted("SignalAnalysis::computeTHD"))
+                    add(measure(settings, "SignalAnalysis::computeTHD", blockSize, sampleRate, blockSize,
+                                [&] { sink = sink + SignalAnalysis::computeTHD(signal, (float)sampleRate, 11); }));
+
+                for (const auto waveform : { SignalGenerator::Waveform::sine, SignalGenerator::Waveform::square,
+                                             SignalGenerator::Waveform::multitone })
+                {
+                    const juce::String name = "SignalGenerator::render (" + SignalGenerator::getName(waveform).toLowerCase() + ")";
+                    if (!wanted(name))
+                        continue;
+
+                    SignalGenerator generator;
+                    generator.prepare(sampleRate);
+                    generator.setWaveform(waveform);
+                    juce::AudioBuffer<float> output(2, blockSize);
+                    add(measure(settings, name, blockSize, sampleRate, blockSize,
+                                [&] { generator.render(output, 0.5f); sink = sink + output.getSample(1, 0); }));
+                }
+
+                // Streaming cost of the analyser: feeding one block plus every frame it completes
+                if (wanted("FFT::run"))
+                {
+                    FFT analyser;
+                    analyser.setUpFrequencyAnalyzer((int)sampleRate, (float)sampleRate, false);
+                    add(measure(settings, "FFT::run (per block)", blockSize, sampleRate, blockSize, [&]
+                    {
+                        analyser.addAudioData(signal, 0, signal.getNumChannels());
+                        while (analyser.processNextFrame()) {}
+                    }));
+                }
+            }
+
+            // Block-independent costs, once per sample rate
+            const int fftSize = 1 << 12;
+
+            if (wanted("FFT::run"))
+            {
+                FFT analyser;
+                analyser.setUpFrequencyAnalyzer((int)sampleRate, (float)sampleRate, false);
+                const auto frame = makeSignal(1, fftSize, sampleRate);
+
+                // Each frame consumes half the FIFO contents (50 % overlap), so feed half a frame per call
+                analyser.addAudioData(frame, 0, 1);
+                juce::AudioBuffer<float> half(1, fftSize / 2);
+                half.copyFrom(0, 0, frame, 0, 0, fftSize / 2);
+
+                add(measure(settings, "FFT::run (per frame)", fftSize, sampleRate, fftSize / 2, [&]
+                {
+                    analyser.addAudioData(half, 0, 1);
+                    analyser.processNextFrame();
+                }));
+            }
+
+            if (wanted("FFT::createPath"))
+            {
+                FFT analyser;
+                analyser.setUpFrequencyAnalyzer((int)sampleRate, (float)sampleRate, false);
+                const auto frame = makeSignal(1, fftSize, sampleRate);
+                analyser.addAudioData(frame, 0, 1);
+                analyser.processNextFrame();
+
+                juce::Path path;
+                const juce::Rectangle<float> bounds(0.0f, 0.0f, 1000.0f, 500.0f);
+                add(measure(settings, "FFT::createPath", fftSize, sampleRate, 0,
+                            [&] { analyser.createPath(path, bounds, 20.0f, -80.0f, 24.0f); }));
+            }
+        }
+    }
+
+    juce::var toJson(const std::vector<Result>& results)
+    {
+        juce::Array<juce::var> records;
+
+        for (const auto& r : results)
+        {
+            auto* record = new juce::DynamicObject();
+            record->setProperty("name", r.name);
+            record->setProperty("block_size", r.blockSize);
+            record->setProperty("sample_rate", r.sampleRate);
+            record->setProperty("ns_per_call", r.nsPerCall);
+            record->setProperty("ns_per_call_min", r.nsPerCallMin);
+            record->setProperty("ns_per_sample", r.samplesPerCall > 0 ? juce::var(r.nsPerCall / r.samplesPerCall) : juce::var());
+            record->setProperty("calls", r.calls);
+            records.add(juce::var(record));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+        root->setProperty("system", juce::SystemStats::getOperatingSystemName() + ", " + juce::SystemStats::getCpuModel());
+        root->setProperty("results", records);
+        return juce::var(root);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    Settings settings;
+    if (args.containsOption("--quick"))
+    {
+        settings.secondsPerBatch = 0.01;
+        settings.batches = 3;
+    }
+    if (args.containsOption("--filter"))
+        settings.filter = args.getValueForOption("--filter");
+
+    std::vector<Result> results;
+    runAll(settings, results);
+
+    const auto json = juce::JSON::toString(toJson(results));
+
+    if (args.containsOption("--out"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out"));
+        if (!file.replaceWithText(json))
+        {
+            std::cerr << "Cannot write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Deterministic stimulus shared by the offline tools (renderer, benchmarks, measurement
+// harness). Every generator keeps its phase across render() calls, so a signal can be
+// produced block by block exactly as a host would deliver it, and reports the values an
+// ideal instrument should measure on it.
+namespace TestSignals
+{
+    enum class Type
+    {
+        sine,       // fundamental plus optional harmonics 2..5 at harmonicLevel each
+        square,     // naive +/- amplitude square (aliases, like a real comparator output)
+        multitone,  // three equal, non-harmonically related tones
+        noise,      // uniform white noise in [-amplitude, amplitude]
+        dc          // constant dcOffset only
+    };
+
+    struct Spec
+    {
+        Type type = Type::sine;
+        float frequency = 1000.0f;
+        float amplitude = 0.5f;      // peak, before dcOffset
+        float dcOffset = 0.0f;
+        float harmonicLevel = 0.0f;  // relative to the fundamental, sine only
+        juce::int64 seed = 1;
+    };
+
+    inline Type parseType(const juce::String& name)
+    {
+        if (name == "square")    return Type::square;
+        if (name == "multitone") return Type::multitone;
+        if (name == "noise")     return Type::noise;
+        if (name == "dc")        return Type::dc;
+        return Type::sine;
+    }
+
+    inline juce::String getName(Type type)
+    {
+        switch (type)
+        {
+            case Type::square:    return "square";
+            case Type::multitone: return "multitone";
+            case Type::noise:     return "noise";
+            case Type::dc:        return "dc";
+            case Type::sine:
+            default:              return "sine";
+        }
+    }
+
+    class Generator
+    {
+    public:
+        Generator(const Spec& s, double rate)
+            : spec(s), sampleRate(rate), random(s.seed) {}
+
+        // Fills every channel of buffer with the same signal, continuing from the last call
+        void render(juce::AudioBuffer<float>& buffer)
+        {
+            const int numSamples = buffer.getNumSamples();
+            if (buffer.getNumChannels() == 0 || numSamples == 0)
+                return;
+
+            float* out = buffer.getWritePointer(0);
+            const double twoPi = juce::MathConstants<double>::twoPi;
+            const double increment = twoPi * spec.frequency / sampleRate;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                double value = 0.0;
+
+                switch (spec.type)
+                {
+                    case Type::sine:
+                        value = std::sin(phase);
+                        if (spec.harmonicLevel > 0.0f)
+                            for (int k = 2; k <= 5; ++k)
+                                value += spec.harmonicLevel * std::sin(k * phase);
+                        break;
+
+                    case Type::square:
+                        value = phase < juce::MathConstants<double>::pi ? 1.0 : -1.0;
+                        break;
+
+                    case Type::multitone:
+                        value = (std::sin(phase) + std::sin(partialPhase[0]) + std::sin(partialPhase[1])) / 3.0;
+                        partialPhase[0] = std::fmod(partialPhase[0] + 2.37 * increment, twoPi);
+                        partialPhase[1] = std::fmod(partialPhase[1] + 3.91 * increment, twoPi);
+                        break;
+
+                    case Type::noise:
+                        value = random.nextFloat() * 2.0f - 1.0f;
+                        break;
+
+                    case Type::dc:
+                        break;
+                }
+
+                out[i] = (float)(value * spec.amplitude) + spec.dcOffset;
+
+                phase += increment;
+                if (phase >= twoPi)
+                    phase -= twoPi;
+            }
+
+            for (int c = 1; c < buffer.getNumChannels(); ++c)
+                buffer.copyFrom(c, 0, buffer, 0, 0, numSamples);
+        }
+
+        // Ground truth. NaN where the quantity is not defined for this signal.
+        float getExpectedFrequency() const
+        {
+            if (spec.type == Type::noise || spec.type == Type::dc)
+                return std::numeric_limits<float>::quiet_NaN();
+            return spec.frequency;
+        }
+
+        float getExpectedRms() const
+        {
+            const float a = spec.amplitude;
+            float acRms = 0.0f;
+
+            switch (spec.type)
+            {
+                case Type::sine:      acRms = a * std::sqrt(0.5f * (1.0f + 4.0f * spec.harmonicLevel * spec.harmonicLevel)); break;
+                case Type::square:    acRms = a; break;
+                case Type::multitone: acRms = a * std::sqrt(3.0f * 0.5f) / 3.0f; break;
+                case Type::noise:     acRms = a / std::sqrt(3.0f); break;
+                case Type::dc:        acRms = 0.0f; break;
+            }
+
+            return std::sqrt(acRms * acRms + spec.dcOffset * spec.dcOffset);
+        }
+
+        float getExpectedVpp() const
+        {
+            switch (spec.type)
+            {
+                case Type::sine:      return spec.harmonicLevel > 0.0f ? std::numeric_limits<float>::quiet_NaN() : 2.0f * spec.amplitude;
+                case Type::square:    return 2.0f * spec.amplitude;
+                case Type::noise:     return 2.0f * spec.amplitude;
+                case Type::dc:        return 0.0f;
+                case Type::multitone:
+                default:              return std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+
+        // THD as a ratio of harmonic to fundamental RMS
+        float getExpectedThd() const
+        {
+            switch (spec.type)
+            {
+                case Type::sine:   return 2.0f * spec.harmonicLevel; // sqrt(4 * h^2)
+                case Type::square: return std::sqrt(juce::MathConstants<float>::pi * juce::MathConstants<float>::pi / 8.0f - 1.0f);
+                default:           return std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+
+        const Spec& getSpec() const noexcept { return spec; }
+
+    private:
+        Spec spec;
+        double sampleRate;
+        double phase = 0.0;
+        double partialPhase[2] = { 0.0, 0.0 };
+        juce::Random random;
+    };
+}
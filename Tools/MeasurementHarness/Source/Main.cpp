@@ -0,0 +1,274 @@
+// Measurement accuracy vs. cost. Deterministic test signals with known amplitude,
+// frequency and THD are pushed through OscilloscopeAudioProcessor::processBlock exactly
+// as a host would, then every measurement algorithm the UI relies on is run on what the
+// processor captured and compared against the ground truth while being timed. The
+// output is one table per algorithm: expected, measured, error and cost for each
+// signal, so a faster algorithm can be checked for accuracy regressions side by side.
+//
+//   MeasurementHarness [--rate 48000] [--block 512] [--window 8192] [--csv results.csv]
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/DSP/SignalAnalysis.h"
+#include "../../Common/TestSignals.h"
+
+namespace
+{
+    struct Case
+    {
+        juce::String label;
+        TestSignals::Spec spec;
+    };
+
+    struct Row
+    {
+        juce::String algorithm;
+        juce::String signal;
+        float expected = 0.0f;
+        float measured = 0.0f;
+        double usPerCall = 0.0;
+        double samplesPerCall = 0.0;
+    };
+
+    std::vector<Case> makeCases()
+    {
+        auto make = [](const char* label, TestSignals::Type type, float frequency, float amplitude,
+                       float dc = 0.0f, float harmonics = 0.0f)
+        {
+            Case c;
+            c.label = label;
+            c.spec.type = type;
+            c.spec.frequency = frequency;
+            c.spec.amplitude = amplitude;
+            c.spec.dcOffset = dc;
+            c.spec.harmonicLevel = harmonics;
+            return c;
+        };
+
+        using T = TestSignals::Type;
+        return {
+            make("sine 50 Hz",           T::sine,      50.0f,   0.5f),
+            make("sine 1 kHz",           T::sine,      1000.0f, 0.5f),
+            make("sine 7.3 kHz",         T::sine,      7300.0f, 0.5f),
+            make("sine 1 kHz -40 dBFS",  T::sine,      1000.0f, 0.01f),
+            make("sine 1 kHz THD 2 %",   T::sine,      1000.0f, 0.5f, 0.0f, 0.01f),
+            make("sine 1 kHz THD 20 %",  T::sine,      1000.0f, 0.5f, 0.0f, 0.1f),
+            make("sine 1 kHz + 0.2 DC",  T::sine,      1000.0f, 0.3f, 0.2f),
+            make("square 1 kHz",         T::square,    1000.0f, 0.5f),
+            make("multitone 500 Hz",     T::multitone, 500.0f,  0.5f),
+            make("noise",                T::noise,     0.0f,    0.5f),
+            make("dc 0.3",               T::dc,        0.0f,    0.0f, 0.3f),
+        };
+    }
+
+    // Runs function until about 20 ms have passed and returns the mean cost per call
+    template <typename Function>
+    double timeCall(Function&& function)
+    {
+        int calls = 0;
+        const auto start = juce::Time::getHighResolutionTicks();
+        double elapsed = 0.0;
+
+        do
+        {
+            function();
+            ++calls;
+            elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        }
+        while (elapsed < 0.02 && calls < 100000);
+
+        return elapsed * 1.0e6 / calls;
+    }
+
+    void setParameter(OscilloscopeAudioProcessor& processor, const juce::ParameterID& id, float normalisedValue)
+    {
+        if (auto* parameter = processor.apvts.getParameter(id.getParamID()))
+            parameter->setValueNotifyingHost(normalisedValue);
+    }
+
+    // Feeds seconds of signal through processBlock in host-sized blocks
+    void feed(OscilloscopeAudioProcessor& processor, TestSignals::Generator& generator, double sampleRate,
+              int blockSize, double seconds)
+    {
+        juce::AudioBuffer<float> block(juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels()), blockSize);
+        juce::MidiBuffer midi;
+
+        for (juce::int64 done = 0; done < (juce::int64)(seconds * sampleRate); done += blockSize)
+        {
+            generator.render(block);
+            processor.processBlock(block, midi);
+        }
+    }
+
+    void measureTimeDomain(const Case& c, double sampleRate, int blockSize, int windowSize, std::vector<Row>& rows)
+    {
+        OscilloscopeAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        setParameter(processor, bypassParamID, 0.0f);
+        setParameter(processor, plotModeParamID, 0.0f);
+
+        TestSignals::Generator generator(c.spec, sampleRate);
+        feed(processor, generator, sampleRate, blockSize, 0.5);
+
+        juce::AudioBuffer<float> window;
+        processor.getCircularBuffer().getMostRecentWindow(window, windowSize);
+
+        auto add = [&](const char* algorithm, float expected, float measured, double us)
+        {
+            rows.push_back({ algorithm, c.label, expected, measured, us, (double)window.getNumSamples() });
+        };
+
+        float rms = 0.0f;
+        double us = timeCall([&] { rms = SignalAnalysis::computeRMS(window, 1.0f); });
+        add("SignalAnalysis::computeRMS", generator.getExpectedRms(), rms, us);
+
+        float vpp = 0.0f;
+        us = timeCall([&]
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(window.getReadPointer(0), window.getNumSamples());
+            vpp = SignalAnalysis::computeVpp(-range.getEnd(), -range.getStart(), 1.0f, 1.0f);
+        });
+        add("Vpp (min/max + computeVpp)", generator.getExpectedVpp(), vpp, us);
+
+        float frequency = 0.0f;
+        us = timeCall([&] { frequency = SignalAnalysis::computeFrequency(window, (float)sampleRate); });
+        add("SignalAnalysis::computeFrequency", generator.getExpectedFrequency(), frequency, us);
+
+        // Same FFT order the time view uses
+        float thd = 0.0f;
+        us = timeCall([&] { thd = SignalAnalysis::computeTHD(window, (float)sampleRate, 11); });
+        add("SignalAnalysis::computeTHD", generator.getExpectedThd(), thd, us);
+
+        processor.releaseResources();
+    }
+
+    void measureSpectrum(const Case& c, double sampleRate, int blockSize, std::vector<Row>& rows)
+    {
+        OscilloscopeAudioProcessor processor;
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+        setParameter(processor, bypassParamID, 0.0f);
+        setParameter(processor, plotModeParamID, 1.0f);
+
+        // Feed in short bursts so the analyser thread keeps up and the averager settles
+        TestSignals::Generator generator(c.spec, sampleRate);
+        for (int i = 0; i < 20; ++i)
+        {
+            feed(processor, generator, sampleRate, blockSize, 0.05);
+            juce::Thread::sleep(5);
+        }
+
+        std::vector<std::pair<float, float>> harmonics;
+        const double us = timeCall([&] { harmonics = processor.getHarmonicLabels(); });
+        processor.releaseResources();
+
+        const float fundamental = harmonics.empty() ? std::numeric_limits<float>::quiet_NaN() : harmonics.front().first;
+        rows.push_back({ "FFT::getHarmonicsInDB (fundamental Hz)", c.label, generator.getExpectedFrequency(), fundamental, us, 0.0 });
+
+        // Level of the 2nd..5th harmonic relative to the fundamental, where it is known
+        const auto& spec = generator.getSpec();
+        for (size_t k = 1; k < harmonics.size() && k < 5; ++k)
+        {
+            const int order = (int)k + 1;
+            float expected = std::numeric_limits<float>::quiet_NaN();
+
+            if (spec.type == TestSignals::Type::sine && spec.harmonicLevel > 0.0f)
+                expected = juce::Decibels::gainToDecibels(spec.harmonicLevel);
+            else if (spec.type == TestSignals::Type::square && order % 2 == 1)
+                expected = juce::Decibels::gainToDecibels(1.0f / order);
+
+            if (std::isnan(expected))
+                continue;
+
+            rows.push_back({ "FFT::getHarmonicsInDB (H" + juce::String(order) + " dBc)", c.label, expected,
+                             harmonics[k].second - harmonics.front().second, us, 0.0 });
+        }
+    }
+
+    juce::String formatValue(float v, int decimals = 4)
+    {
+        return std::isnan(v) ? juce::String("-") : juce::String(v, decimals);
+    }
+
+    void printTables(const std::vector<Row>& rows)
+    {
+        juce::StringArray algorithms;
+        for (const auto& r : rows)
+            algorithms.addIfNotAlreadyThere(r.algorithm);
+
+        for (const auto& algorithm : algorithms)
+        {
+            std::cout << "\n" << algorithm << "\n";
+            std::cout << juce::String("signal").paddedRight(' ', 22) << juce::String("expected").paddedLeft(' ', 12)
+                      << juce::String("measured").paddedLeft(' ', 12) << juce::String("error").paddedLeft(' ', 12)
+                      << juce::String("error %").paddedLeft(' ', 10) << juce::String("us/call").paddedLeft(' ', 10)
+                      << juce::String("Msamples/s").paddedLeft(' ', 12) << "\n";
+
+            for (const auto& r : rows)
+            {
+                if (r.algorithm != algorithm)
+                    continue;
+
+                const float error = r.measured - r.expected;
+                const float relative = r.expected != 0.0f ? 100.0f * error / std::abs(r.expected) : std::numeric_limits<float>::quiet_NaN();
+                const juce::String throughput = r.samplesPerCall > 0.0 ? juce::String(r.samplesPerCall / r.usPerCall, 1) : juce::String("-");
+
+                std::cout << r.signal.paddedRight(' ', 22) << formatValue(r.expected).paddedLeft(' ', 12)
+                          << formatValue(r.measured).paddedLeft(' ', 12) << formatValue(error).paddedLeft(' ', 12)
+                          << formatValue(relative, 2).paddedLeft(' ', 10) << juce::String(r.usPerCall, 2).paddedLeft(' ', 10)
+                          << throughput.paddedLeft(' ', 12) << "\n";
+            }
+        }
+
+        std::cout << std::flush;
+    }
+
+    bool writeCsv(const juce::File& file, const std::vector<Row>& rows)
+    {
+        juce::String csv("algorithm,signal,expected,measured,us_per_call,samples_per_call\n");
+
+        for (const auto& r : rows)
+            csv << "\"" << r.algorithm << "\",\"" << r.signal << "\"," << formatValue(r.expected, 6) << ","
+                << formatValue(r.measured, 6) << "," << r.usPerCall << "," << r.samplesPerCall << "\n";
+
+        return file.replaceWithText(csv);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto value = [&](const char* name, const juce::String& fallback)
+    {
+        return args.containsOption(name) ? args.getValueForOption(name) : fallback;
+    };
+
+    const double sampleRate = value("--rate", "48000").getDoubleValue();
+    const int blockSize = juce::jmax(1, value("--block", "512").getIntValue());
+    const int windowSize = juce::jmax(2048, value("--window", "8192").getIntValue());
+
+    std::vector<Row> rows;
+
+    for (const auto& c : makeCases())
+    {
+        measureTimeDomain(c, sampleRate, blockSize, windowSize, rows);
+        measureSpectrum(c, sampleRate, blockSize, rows);
+    }
+
+    printTables(rows);
+
+    if (args.containsOption("--csv"))
+    {
+        const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--csv"));
+        if (!writeCsv(file, rows))
+        {
+            std::cerr << "Cannot write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,338 @@
+// Headless renderer: feeds a recording (WAV or raw .f32 capture, memory-mapped) or a
+// generated signal through the plugin's processor block by block and paints the time or
+// frequency view into images at a fixed frame rate, without a display, GPU or audio
+// device. Frames are written as PNGs and every frame's update/paint/encode cost goes to
+// timings.csv, so runs can be diffed for visual regressions and compared for rendering
+// throughput. With --analyse the whole recording is measured offline instead, segment by
+// segment, and the per-segment report written as CSV.
+//
+//   OfflineRenderer [--input file.wav|file.f32 | --signal sine|square|multitone|noise|dc]
+//                   [--frequency 1000] [--amplitude 0.5] [--dc 0] [--harmonics 0]
+//                   [--view time|frequency|xy] [--frames 120] [--fps 60]
+//                   [--rate 48000] [--block 512] [--width 1000] [--height 500]
+//                   [--scale 1] [--out frames] [--no-png]
+//   OfflineRenderer --input file --analyse [--channel 1] [--segment 1] [--level 0] [--out report.csv]
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/DSP/RecordingFile.h"
+#include "../../../Source/DSP/RecordingAnalyzer.h"
+#include "../../../Source/UI/TimeVisualizer.h"
+#include "../../../Source/UI/FrequencyVisualizer.h"
+#include "../../../Source/UI/XYVisualizer.h"
+#include "../../Common/TestSignals.h"
+
+namespace
+{
+    struct Options
+    {
+        juce::File input;
+        TestSignals::Spec signal;
+        bool frequencyView = false;
+        bool xyView = false;
+        int frames = 120;
+        double fps = 60.0;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int width = 1000;
+        int height = 500;
+        float scale = 1.0f;
+        juce::File outputFolder;
+        bool writePngs = true;
+
+        bool analyse = false;
+        RecordingAnalyzer::Settings analysis;
+        juce::File analysisReport;
+    };
+
+    struct FrameTiming
+    {
+        double updateMs = 0.0;
+        double paintMs = 0.0;
+        double encodeMs = 0.0;
+    };
+
+    double ticksToMs(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+    }
+
+    double percentile(std::vector<double> values, double p)
+    {
+        if (values.empty())
+            return 0.0;
+
+        std::sort(values.begin(), values.end());
+        const auto index = (size_t)juce::jlimit(0.0, (double)values.size() - 1.0, std::ceil(p * values.size()) - 1.0);
+        return values[index];
+    }
+
+    Options parseOptions(const juce::ArgumentList& args)
+    {
+        Options o;
+
+        auto value = [&](const char* name, const juce::String& fallback)
+        {
+            return args.containsOption(name) ? args.getValueForOption(name) : fallback;
+        };
+
+        if (args.containsOption("--input"))
+            o.input = args.getExistingFileForOption("--input");
+
+        o.signal.type = TestSignals::parseType(value("--signal", "sine"));
+        o.signal.frequency = value("--frequency", "1000").getFloatValue();
+        o.signal.amplitude = value("--amplitude", "0.5").getFloatValue();
+        o.signal.dcOffset = value("--dc", "0").getFloatValue();
+        o.signal.harmonicLevel = value("--harmonics", "0").getFloatValue();
+
+        o.frequencyView = value("--view", "time") == "frequency";
+        o.xyView = value("--view", "time") == "xy";
+        o.frames = juce::jmax(1, value("--frames", "120").getIntValue());
+        o.fps = juce::jmax(1.0, value("--fps", "60").getDoubleValue());
+        o.sampleRate = value("--rate", "48000").getDoubleValue();
+        o.blockSize = juce::jmax(1, value("--block", "512").getIntValue());
+        o.width = juce::jmax(16, value("--width", "1000").getIntValue());
+        o.height = juce::jmax(16, value("--height", "500").getIntValue());
+        o.scale = juce::jmax(0.25f, value("--scale", "1").getFloatValue());
+        o.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile(value("--out", "frames"));
+        o.writePngs = !args.containsOption("--no-png");
+
+        o.analyse = args.containsOption("--analyse");
+        o.analysis.channel = juce::jmax(1, value("--channel", "1").getIntValue()) - 1;
+        o.analysis.segmentSeconds = juce::jmax(0.001, value("--segment", "1").getDoubleValue());
+        o.analysis.triggerLevel = value("--level", "0").getFloatValue();
+        o.analysisReport = args.containsOption("--out") ? juce::File::getCurrentWorkingDirectory().getChildFile(value("--out", ""))
+                                                        : RecordingAnalyzer::getDefaultReportFile(o.input);
+
+        return o;
+    }
+
+    void setParameter(OscilloscopeAudioProcessor& processor, const juce::ParameterID& id, float normalisedValue)
+    {
+        if (auto* parameter = processor.apvts.getParameter(id.getParamID()))
+            parameter->setValueNotifyingHost(normalisedValue);
+    }
+
+    // The spectrum is produced on the FFT thread; give it a bounded amount of time so a
+    // frame never shows stale data just because the thread was not scheduled yet
+    void waitForAnalyser(OscilloscopeAudioProcessor& processor)
+    {
+        const auto deadline = juce::Time::getMillisecondCounterHiRes() + 250.0;
+
+        while (!processor.isAnalyserDataPending() && juce::Time::getMillisecondCounterHiRes() < deadline)
+            juce::Thread::sleep(1);
+    }
+
+    void printSummary(const std::vector<FrameTiming>& timings, double wallSeconds)
+    {
+        std::vector<double> update, paint, encode;
+        for (const auto& t : timings)
+        {
+            update.push_back(t.updateMs);
+            paint.push_back(t.paintMs);
+            encode.push_back(t.encodeMs);
+        }
+
+        auto line = [](const char* name, const std::vector<double>& v)
+        {
+            std::cout << juce::String(name).paddedRight(' ', 8)
+                      << " p50 " << juce::String(percentile(v, 0.50), 3)
+                      << "  p95 " << juce::String(percentile(v, 0.95), 3)
+                      << "  p99 " << juce::String(percentile(v, 0.99), 3)
+                      << "  max " << juce::String(percentile(v, 1.0), 3) << " ms" << std::endl;
+        };
+
+        std::cout << timings.size() << " frames in " << juce::String(wallSeconds, 2) << " s" << std::endl;
+        line("update", update);
+        line("paint", paint);
+        line("encode", encode);
+    }
+
+    // Measures the whole recording without rendering; the processor is not involved
+    int analyseRecording(const Options& options)
+    {
+        RecordingAnalyzer analyzer;
+
+        const auto result = analyzer.start(options.input, options.analysis, nullptr);
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        while (analyzer.isRunning())
+            juce::Thread::sleep(10);
+
+        const auto summary = analyzer.getSummary();
+        const auto& report = options.analysisReport;
+
+        if (!analyzer.writeCsv(report))
+        {
+            std::cerr << "Cannot write " << report.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        std::cout << summary.numSegments << " segments, " << juce::String(summary.durationSeconds, 1) << " s of audio in "
+                  << juce::String(summary.wallSeconds, 3) << " s ("
+                  << juce::String(summary.durationSeconds / juce::jmax(1.0e-6, summary.wallSeconds), 0) << "x real time)" << std::endl
+                  << "min " << summary.min << "  max " << summary.max << "  rms " << summary.rms
+                  << "  triggers " << summary.triggers << std::endl
+                  << "report: " << report.getFullPathName() << std::endl;
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "Usage: OfflineRenderer [--input file.wav | --signal sine|square|multitone|noise|dc]\n"
+                     "       [--frequency Hz] [--amplitude peak] [--dc offset] [--harmonics level]\n"
+                     "       [--view time|frequency|xy] [--frames n] [--fps n] [--rate Hz] [--block n]\n"
+                     "       [--width px] [--height px] [--scale s] [--out folder] [--no-png]\n"
+                     "       OfflineRenderer --input file --analyse [--channel n] [--segment s] [--level l] [--out report.csv]" << std::endl;
+        return 0;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    const Options options = parseOptions(args);
+
+    if (options.analyse)
+        return analyseRecording(options);
+
+    RecordingFile recording;
+    double sampleRate = options.sampleRate;
+
+    if (options.input != juce::File())
+    {
+        const auto result = recording.open(options.input);
+
+        if (result.failed())
+        {
+            std::cerr << result.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        sampleRate = recording.getSampleRate();
+    }
+
+    OscilloscopeAudioProcessor processor;
+    processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+    processor.prepareToPlay(sampleRate, options.blockSize);
+
+    // The plugin starts bypassed; nothing would be drawn
+    setParameter(processor, bypassParamID, 0.0f);
+    setParameter(processor, plotModeParamID, options.frequencyView ? 1.0f : 0.0f);
+
+    std::unique_ptr<juce::Component> view;
+    TimeVisualizer* timeView = nullptr;
+    FrequencyVisualizer* frequencyView = nullptr;
+    XYVisualizer* xyView = nullptr;
+
+    if (options.frequencyView)
+        view.reset(frequencyView = new FrequencyVisualizer(processor));
+    else if (options.xyView)
+        view.reset(xyView = new XYVisualizer(processor));
+    else
+        view.reset(timeView = new TimeVisualizer(processor));
+
+    view->setBounds(0, 0, options.width, options.height);
+
+    if (!options.outputFolder.createDirectory())
+    {
+        std::cerr << "Cannot create " << options.outputFolder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    TestSignals::Generator generator(options.signal, sampleRate);
+    juce::AudioBuffer<float> block(juce::jmax(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels()),
+                                   options.blockSize);
+    juce::MidiBuffer midi;
+    juce::PNGImageFormat png;
+
+    const double samplesPerFrame = sampleRate / options.fps;
+    juce::int64 samplePosition = 0;
+    std::vector<FrameTiming> timings;
+    timings.reserve((size_t)options.frames);
+
+    const auto runStart = juce::Time::getHighResolutionTicks();
+
+    for (int frame = 0; frame < options.frames; ++frame)
+    {
+        const auto frameEnd = (juce::int64)std::llround((frame + 1) * samplesPerFrame);
+
+        while (samplePosition < frameEnd)
+        {
+            if (recording.isOpen())
+            {
+                block.clear();
+                for (int c = 0; c < juce::jmin(block.getNumChannels(), recording.getNumChannels()); ++c)
+                    recording.readChannel(c, samplePosition, options.blockSize, block.getWritePointer(c));
+            }
+            else
+            {
+                generator.render(block);
+            }
+
+            processor.processBlock(block, midi);
+            samplePosition += options.blockSize;
+        }
+
+        FrameTiming timing;
+
+        auto start = juce::Time::getHighResolutionTicks();
+        if (frequencyView != nullptr)
+        {
+            waitForAnalyser(processor);
+            start = juce::Time::getHighResolutionTicks();
+            frequencyView->frameCallback();
+        }
+        else if (xyView != nullptr)
+        {
+            xyView->frameCallback();
+        }
+        else
+        {
+            timeView->frameCallback();
+        }
+        timing.updateMs = ticksToMs(juce::Time::getHighResolutionTicks() - start);
+
+        start = juce::Time::getHighResolutionTicks();
+        const auto image = view->createComponentSnapshot(view->getLocalBounds(), true, options.scale);
+        timing.paintMs = ticksToMs(juce::Time::getHighResolutionTicks() - start);
+
+        if (options.writePngs)
+        {
+            start = juce::Time::getHighResolutionTicks();
+            auto file = options.outputFolder.getChildFile("frame_" + juce::String(frame).paddedLeft('0', 5) + ".png");
+            file.deleteFile();
+
+            juce::FileOutputStream stream(file);
+            if (!stream.openedOk() || !png.writeImageToStream(image, stream))
+            {
+                std::cerr << "Cannot write " << file.getFullPathName() << std::endl;
+                return 1;
+            }
+            timing.encodeMs = ticksToMs(juce::Time::getHighResolutionTicks() - start);
+        }
+
+        timings.push_back(timing);
+
+        if (recording.isOpen() && samplePosition >= recording.getLengthInSamples())
+            break;
+    }
+
+    const double wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - runStart);
+    processor.releaseResources();
+
+    juce::String csv("frame,update_ms,paint_ms,encode_ms\n");
+    for (size_t i = 0; i < timings.size(); ++i)
+        csv << (int)i << "," << timings[i].updateMs << "," << timings[i].paintMs << "," << timings[i].encodeMs << "\n";
+
+    options.outputFolder.getChildFile("timings.csv").replaceWithText(csv);
+
+    printSummary(timings, wallSeconds);
+    return 0;
+}